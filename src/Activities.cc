@@ -18,6 +18,8 @@
 //
 #include "Activities.h"
 #include "Age_Map.h"
+#include "Async_Output.h"
+#include "Checkpoint.h"
 #include "Classroom.h"
 #include "Global.h"
 #include "Date.h"
@@ -101,6 +103,8 @@ Activities::Activities() {
   this->grade = 0;
   this->return_from_travel_sim_day = -1;
   this->in_parents_home = false;
+  this->has_remote_workplace = false;
+  this->has_remote_school = false;
   this->link = new Person_Place_Link [Activity_index::DAILY_ACTIVITY_LOCATIONS];
   this->networks.clear();
 }
@@ -307,7 +311,7 @@ void Activities::update_daily_activities(int sim_day) {
       this->my_sick_leave_decision_has_been_made = true;
       this->my_sick_leave_decision = true;
       if (Global::Enable_Health_Records) {
-	fprintf(Global::HealthRecordfp,
+	Async_Output::print(Global::HealthRecordfp,
 		"HEALTH RECORD: %s day %d person %d CONFINED_TO_HOUSEHOLD due to CONTACT_TRACING\n",
 		Date::get_date_string().c_str(),
 		sim_day,
@@ -334,7 +338,7 @@ void Activities::update_daily_activities(int sim_day) {
 	    this->my_sick_leave_decision_has_been_made = true;
 	  }
 	  if (Global::Enable_Health_Records && stay_home) {
-	    fprintf(Global::HealthRecordfp,
+	    Async_Output::print(Global::HealthRecordfp,
 		    "HEALTH RECORD: %s day %d person %d CONFINED_TO_HOUSEHOLD due to COND %d daily_update %d\n",
 		    Date::get_date_string().c_str(),
 		    sim_day,
@@ -397,13 +401,13 @@ void Activities::update_schedule(int sim_day) {
 
     // weekday vs weekend provisional activity
     if(Activities::is_weekday) {
-      if(get_school() != NULL) {
+      if(get_school() != NULL || this->has_remote_school) {
         this->on_schedule[Activity_index::SCHOOL_ACTIVITY] = true;
       }
       if(get_classroom() != NULL) {
         this->on_schedule[Activity_index::CLASSROOM_ACTIVITY] = true;
       }
-      if(get_workplace() != NULL) {
+      if(get_workplace() != NULL || this->has_remote_workplace) {
         this->on_schedule[Activity_index::WORKPLACE_ACTIVITY] = true;
       }
       if(get_office() != NULL) {
@@ -411,7 +415,7 @@ void Activities::update_schedule(int sim_day) {
       }
     } else {
       if(this->profile == WEEKEND_WORKER_PROFILE || this->profile == STUDENT_PROFILE) {
-        if(get_workplace() != NULL) {
+        if(get_workplace() != NULL || this->has_remote_workplace) {
           this->on_schedule[Activity_index::WORKPLACE_ACTIVITY] = true;
         }
         if(get_office() != NULL) {
@@ -1177,6 +1181,9 @@ void Activities::terminate() {
     if(this->is_traveling && !this->is_traveling_outside) {
       restore_daily_activity_locations();
     }
+  }
+  if(Global::Enable_Travel) {
+    // also removes the person from the travel hub's user list
     Travel::terminate_person(this->myself);
   }
 
@@ -1255,6 +1262,26 @@ void Activities::update_enrollee_index(Mixing_Group* mixing_group, int new_index
   assert(0);
 }
 
+void Activities::update_susceptible_rosters(int condition_id, bool susceptible) {
+  for(int i = 0; i < Activity_index::DAILY_ACTIVITY_LOCATIONS; ++i) {
+    if(this->link[i].is_enrolled()) {
+      Place* place = this->link[i].get_place();
+      if(place->has_susceptible_rosters()) {
+	place->update_susceptible_roster(condition_id, this->link[i].get_enrollee_index(), susceptible);
+      }
+    }
+  }
+}
+
+bool Activities::is_enrolled_in_place(Place* place) {
+  for(int i = 0; i < Activity_index::DAILY_ACTIVITY_LOCATIONS; ++i) {
+    if(this->link[i].is_enrolled() && this->link[i].get_place() == place) {
+      return true;
+    }
+  }
+  return false;
+}
+
 ///////////////////////////////////
 
 void Activities::clear_daily_activity_locations() {
@@ -1359,6 +1386,21 @@ bool Activities::is_present(int sim_day, Place* place) {
   return false;
 }
 
+bool Activities::is_on_schedule(int sim_day, int activity) {
+
+  // nothing is scheduled while traveling abroad
+  if(this->is_traveling_outside) {
+    return false;
+  }
+
+  // update list of places to visit today if not already done
+  if(sim_day > this->schedule_updated) {
+    update_schedule(sim_day);
+  }
+
+  return this->on_schedule[activity];
+}
+
 void Activities::create_network_link_to(Person* person, Network* network) {
   int size = this->networks.size();
   for(int i = 0; i < size; ++i) {
@@ -1674,3 +1716,37 @@ void Activities::clear_confinement_to_household(int condition_id) {
   }
 }
 
+void Activities::write_checkpoint() {
+  unsigned long schedule = this->on_schedule.to_ulong();
+  Checkpoint::put(schedule);
+  Checkpoint::put(this->schedule_updated);
+  Checkpoint::put_array(this->is_confined_for_condition, Global::Conditions.get_number_of_conditions());
+  Checkpoint::put(this->is_confined_due_to_contact_tracing);
+  Checkpoint::put(this->sick_leave_available);
+  Checkpoint::put(this->sick_days_remaining);
+  Checkpoint::put(this->my_sick_leave_decision_has_been_made);
+  Checkpoint::put(this->my_sick_leave_decision);
+  for(int i = 0; i < Activity_index::DAILY_ACTIVITY_LOCATIONS; ++i) {
+    Checkpoint::put_place(this->link[i].get_place());
+    Checkpoint::put(this->link[i].get_enrollee_index());
+  }
+}
+
+void Activities::read_checkpoint() {
+  unsigned long schedule = 0;
+  Checkpoint::get(schedule);
+  this->on_schedule = std::bitset<Activity_index::DAILY_ACTIVITY_LOCATIONS>(schedule);
+  Checkpoint::get(this->schedule_updated);
+  Checkpoint::get_array(this->is_confined_for_condition, Global::Conditions.get_number_of_conditions());
+  Checkpoint::get(this->is_confined_due_to_contact_tracing);
+  Checkpoint::get(this->sick_leave_available);
+  Checkpoint::get(this->sick_days_remaining);
+  Checkpoint::get(this->my_sick_leave_decision_has_been_made);
+  Checkpoint::get(this->my_sick_leave_decision);
+  for(int i = 0; i < Activity_index::DAILY_ACTIVITY_LOCATIONS; ++i) {
+    Place* place = Checkpoint::get_place();
+    int enrollee_index = -1;
+    Checkpoint::get(enrollee_index);
+    this->link[i].set_link(place, enrollee_index);
+  }
+}
@@ -177,6 +177,26 @@ public:
    */
   void update_schedule(int sim_day);
 
+  /**
+   * Record that the agent's workplace (or school) is held by another
+   * partition (see Partition). The activity is then scheduled as if the
+   * place were local, but it has no place in this process.
+   */
+  void set_remote_workplace() {
+    this->has_remote_workplace = true;
+  }
+
+  void set_remote_school() {
+    this->has_remote_school = true;
+  }
+
+  /**
+   * @param day the simulation day
+   * @param activity an Activity_index
+   * @return <code>true</code> if the activity is on today's schedule
+   */
+  bool is_on_schedule(int sim_day, int activity);
+
   /**
    * Have agent begin stay in a hospital
    *
@@ -387,6 +407,13 @@ public:
    */
   void terminate();
 
+  /**
+   * Save or restore the daily schedule, confinement and sick leave
+   * state and the links to the daily activity locations (see Checkpoint).
+   */
+  void write_checkpoint();
+  void read_checkpoint();
+
   /**
    * The agent begins traveling.  The daily activity locations for this agent are stored, and it gets a new schedule
    * based on the agent it is visiting.
@@ -621,6 +648,10 @@ private:
   // still in parents home?
   bool in_parents_home;
 
+  // workplace or school held by another partition
+  bool has_remote_workplace;
+  bool has_remote_school;
+
   // static variables
   static bool is_initialized; // true if static arrays have been initialized
   static bool is_weekday;     // true if current day is Monday .. Friday
@@ -655,6 +686,14 @@ private:
   void enroll_in_daily_activity_location(int i);
   void enroll_in_daily_activity_locations();
   void update_enrollee_index(Mixing_Group* mixing_group, int new_index);
+
+  /**
+   * Add or remove this person from the susceptible rosters of the
+   * daily activity locations in which they are enrolled.
+   */
+  void update_susceptible_rosters(int condition_id, bool susceptible);
+
+  bool is_enrolled_in_place(Place* place);
   void unenroll_from_daily_activity_location(int i);
   void unenroll_from_daily_activity_locations();
   void store_daily_activity_locations();
@@ -0,0 +1,87 @@
+/*
+  This file is part of the FRED system.
+
+  Copyright (c) 2013-2016, University of Pittsburgh, John Grefenstette,
+  David Galloway, Mary Krauland, Michael Lann, and Donald Burke.
+
+  Based in part on FRED Version 2.9, created in 2010-2013 by
+  John Grefenstette, Shawn Brown, Roni Rosenfield, Alona Fyshe, David
+  Galloway, Nathan Stone, Jay DePasse, Anuroop Sriram, and Donald Burke.
+
+  Licensed under the BSD 3-Clause license.  See the file "LICENSE" for
+  more information.
+*/
+
+//
+//
+// File: Age_Histogram.cc
+//
+
+#include "Age_Histogram.h"
+#include "Global.h"
+#include "Person.h"
+
+Age_Histogram::Age_Histogram() {
+  this->males_by_age.assign(Demographics::MAX_AGE + 1, 0);
+  this->females_by_age.assign(Demographics::MAX_AGE + 1, 0);
+  this->males = 0;
+  this->females = 0;
+  this->births_by_day.clear();
+  this->first_birth_day = 0;
+}
+
+void Age_Histogram::add(Person* person) {
+  count(person, 1);
+}
+
+void Age_Histogram::remove(Person* person) {
+  count(person, -1);
+}
+
+void Age_Histogram::count(Person* person, int change) {
+  int age = person->get_age();
+  if(age < 0) {
+    age = 0;
+  }
+  if(age > Demographics::MAX_AGE) {
+    age = Demographics::MAX_AGE;
+  }
+  if(person->get_sex() == 'M') {
+    this->males_by_age[age] += change;
+    this->males += change;
+  } else {
+    this->females_by_age[age] += change;
+    this->females += change;
+  }
+
+  // extend the birthday range to cover this person
+  int birth_day = person->get_birthday_sim_day();
+  if(this->births_by_day.empty()) {
+    this->first_birth_day = birth_day;
+  }
+  if(birth_day < this->first_birth_day) {
+    this->births_by_day.insert(this->births_by_day.begin(), this->first_birth_day - birth_day, 0);
+    this->first_birth_day = birth_day;
+  }
+  int index = birth_day - this->first_birth_day;
+  if(index >= static_cast<int>(this->births_by_day.size())) {
+    this->births_by_day.resize(index + 1, 0);
+  }
+  this->births_by_day[index] += change;
+}
+
+double Age_Histogram::get_median_age() const {
+  int total = get_total();
+  if(total <= 0) {
+    return 0.0;
+  }
+  // the real ages in increasing order are the birthdays in decreasing order
+  int seen = 0;
+  for(int i = this->births_by_day.size() - 1; i >= 0; --i) {
+    seen += this->births_by_day[i];
+    if(seen > total / 2) {
+      return double(Global::Simulation_Day - (this->first_birth_day + i)) / 365.25;
+    }
+  }
+  return 0.0;
+}
@@ -0,0 +1,93 @@
+/*
+  This file is part of the FRED system.
+
+  Copyright (c) 2013-2016, University of Pittsburgh, John Grefenstette,
+  David Galloway, Mary Krauland, Michael Lann, and Donald Burke.
+
+  Based in part on FRED Version 2.9, created in 2010-2013 by
+  John Grefenstette, Shawn Brown, Roni Rosenfield, Alona Fyshe, David
+  Galloway, Nathan Stone, Jay DePasse, Anuroop Sriram, and Donald Burke.
+
+  Licensed under the BSD 3-Clause license.  See the file "LICENSE" for
+  more information.
+*/
+
+//
+//
+// File: Age_Histogram.h
+//
+
+#ifndef _FRED_AGE_HISTOGRAM_H
+#define _FRED_AGE_HISTOGRAM_H
+
+#include <vector>
+
+#include "Demographics.h"
+
+class Person;
+
+/**
+ * Counts of people by sex and age, and by birthday, kept up to date as
+ * people are added and removed, so that demographic reports need no
+ * pass over the population.
+ *
+ * A person is counted in the age bin of their current age (the oldest
+ * bin holds everyone of MAX_AGE or more), so a birthday is recorded by
+ * removing the person before the age changes and adding them after.
+ * The counts by birthday give the exact median of the real ages.
+ */
+class Age_Histogram {
+public:
+  Age_Histogram();
+
+  void add(Person* person);
+  void remove(Person* person);
+
+  int get_count(int age, char sex) const {
+    if(age < 0) {
+      return 0;
+    }
+    if(age > Demographics::MAX_AGE) {
+      age = Demographics::MAX_AGE;
+    }
+    return (sex == 'M' ? this->males_by_age[age] : this->females_by_age[age]);
+  }
+
+  int get_count(int age) const {
+    return get_count(age, 'M') + get_count(age, 'F');
+  }
+
+  int get_males() const {
+    return this->males;
+  }
+
+  int get_females() const {
+    return this->females;
+  }
+
+  int get_total() const {
+    return this->males + this->females;
+  }
+
+  /**
+   * The real age (see Demographics::get_real_age) at the middle of the
+   * sorted real ages on the current simulation day, i.e. element
+   * total/2 of the ages in increasing order.
+   */
+  double get_median_age() const;
+
+private:
+  // people who are not male are counted as female
+  std::vector<int> males_by_age;
+  std::vector<int> females_by_age;
+  int males;
+  int females;
+
+  // births_by_day[i] people were born on simulation day first_birth_day + i
+  std::vector<int> births_by_day;
+  int first_birth_day;
+
+  void count(Person* person, int change);
+};
+
+#endif // _FRED_AGE_HISTOGRAM_H
@@ -27,12 +27,14 @@
 using namespace std;
 
 Age_Map::Age_Map() {
+  this->table_limit = 0.0;
 }
 
 Age_Map::Age_Map(string name) {
   this->name = name + " Age Map";
   ages.clear();
   values.clear();
+  this->table_limit = 0.0;
 }
 
 void Age_Map::read_from_input(string input, int i) {
@@ -85,6 +87,7 @@ void Age_Map::read_from_input(string input) {
   if(quality_control() != true) {
     Utils::fred_abort("Bad input on age map %s", this->name.c_str());
   }
+  compile();
   return;
 }
 
@@ -97,7 +100,10 @@ void Age_Map::read_from_string(string ages_string, string values_string) {
   std::strcpy (vstr, values_string.c_str());
   Params::get_param_vector_from_string(astr, this->ages);
   Params::get_param_vector_from_string(vstr, this->values);
+  delete[] astr;
+  delete[] vstr;
 
+  compile();
   return;
 }
 
@@ -110,9 +116,40 @@ void Age_Map::set_all_values(double val) {
   }
   this->ages.push_back(Demographics::MAX_AGE);
   this->values.push_back(val);
+  compile();
 }
 
-int Age_Map::find_group(double age) {
+void Age_Map::compile() {
+  this->bucket_group.clear();
+  this->table_limit = 0.0;
+  if(this->ages.empty() || this->ages.size() != this->values.size() || this->ages.size() > 32767) {
+    // leave every lookup to scan_group() and scan_value()
+    return;
+  }
+  double limit = this->ages.back();
+  if(limit > MAX_TABLE_AGE) {
+    limit = MAX_TABLE_AGE;
+  }
+  int buckets = (int) (limit * BUCKETS_PER_YEAR);
+  this->bucket_group.resize(buckets);
+  unsigned int group = 0;
+  for(int b = 0; b < buckets; ++b) {
+    double low = (double) b / BUCKETS_PER_YEAR;
+    double high = (double) (b + 1) / BUCKETS_PER_YEAR;
+    // the group of the lowest age in the bucket
+    while(group < this->ages.size() && this->ages[group] <= low) {
+      ++group;
+    }
+    if(group < this->ages.size() && this->ages[group] < high) {
+      this->bucket_group[b] = -1;
+    } else {
+      this->bucket_group[b] = group;
+    }
+  }
+  this->table_limit = (double) buckets / BUCKETS_PER_YEAR;
+}
+
+int Age_Map::scan_group(double age) {
   // printf("find_group: age = %.1f  groups %d \n", age, (int) this->ages.size());
   for(unsigned int i = 0; i < this->ages.size(); i++) {
     if (age < this->ages[i]) {
@@ -123,7 +160,7 @@ int Age_Map::find_group(double age) {
   return -1;
 }
 
-double Age_Map::find_value(double age) {
+double Age_Map::scan_value(double age) {
   // printf("find_value: age = %.1f  groups %d \n", age, (int) this->ages.size());
   for(unsigned int i = 0; i < this->ages.size(); i++) {
     if (age < this->ages[i]) {
@@ -133,6 +170,20 @@ double Age_Map::find_value(double age) {
   return 0.0;
 }
 
+double Age_Map::find_max_value(double from_age, double to_age) {
+  double max_value = find_value(from_age);
+  // every group that starts inside the range
+  for(unsigned int i = 0; i < this->ages.size(); i++) {
+    if(from_age < this->ages[i] && this->ages[i] <= to_age) {
+      double value = (i + 1 < this->ages.size() ? this->values[i + 1] : 0.0);
+      if(value > max_value) {
+	max_value = value;
+      }
+    }
+  }
+  return max_value;
+}
+
 void Age_Map::print() const {
   cout << "\n" << this->name << "\n";
   for(unsigned int i = 0; i < this->ages.size(); i++) {
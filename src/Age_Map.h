@@ -99,10 +99,12 @@ public:
   
   void set_ages(vector<double> input_ages){
     ages = input_ages;
+    compile();
   }
   
   void set_values(vector<double> input_values){
     values = input_values;
+    compile();
   }
   
   void read_from_string(string ages_string, string values_string);
@@ -114,8 +116,13 @@ public:
    * @param (double) age the age to find
    * @return the found value
    */
-  double find_value(double age);
-
+  double find_value(double age) {
+    int group = lookup_group(age);
+    if(group < 0) {
+      return scan_value(age);
+    }
+    return this->values[group];
+  }
 
   /**
    * Find the group associated with a given age. Will abort if no matching range is found.
@@ -123,7 +130,23 @@ public:
    * @param (double) age the age to find
    * @return the corresponding age group index
    */
-  int find_group(double age);
+  int find_group(double age) {
+    int group = lookup_group(age);
+    if(group < 0) {
+      return scan_group(age);
+    }
+    return group;
+  }
+
+  /**
+   * Find the largest value of any age in a range, however narrow the
+   * age groups in the range are.
+   *
+   * @param (double) from_age the lowest age in the range
+   * @param (double) to_age the highest age in the range
+   * @return the largest value (0.0 for ages past the last group)
+   */
+  double find_max_value(double from_age, double to_age);
 
   // Utility functions
   /**
@@ -142,9 +165,34 @@ public:
   bool quality_control() const;
 
 private:
+  /**
+   * Build the lookup table from the age groups. The table has one entry
+   * per 1/BUCKETS_PER_YEAR of a year, up to the last upper age or
+   * MAX_TABLE_AGE, holding the group of every age in the bucket, or -1
+   * if an upper age falls inside the bucket.
+   */
+  void compile();
+
+  int lookup_group(double age) const {
+    // BUCKETS_PER_YEAR is a power of two, so age * BUCKETS_PER_YEAR is
+    // exact and each age lands in the bucket that contains it
+    if(age >= 0.0 && age < this->table_limit) {
+      return this->bucket_group[(int) (age * BUCKETS_PER_YEAR)];
+    }
+    return -1;
+  }
+
+  int scan_group(double age);
+  double scan_value(double age);
+
+  static const int BUCKETS_PER_YEAR = 16;
+  static const int MAX_TABLE_AGE = 128;
+
   string name;
   vector<double> ages; // vector to hold the upper age for each age group
   vector<double> values; // vector to hold the values for each age range
+  vector<short> bucket_group; // the group of each bucket of ages, or -1
+  double table_limit; // the ages below this are in the table
 };
 
 #endif
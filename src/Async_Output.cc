@@ -0,0 +1,277 @@
+/*
+  This file is part of the FRED system.
+
+  Copyright (c) 2013-2016, University of Pittsburgh, John Grefenstette,
+  David Galloway, Mary Krauland, Michael Lann, and Donald Burke.
+
+  Based in part on FRED Version 2.9, created in 2010-2013 by
+  John Grefenstette, Shawn Brown, Roni Rosenfield, Alona Fyshe, David
+  Galloway, Nathan Stone, Jay DePasse, Anuroop Sriram, and Donald Burke.
+
+  Licensed under the BSD 3-Clause license.  See the file "LICENSE" for
+  more information.
+*/
+
+//
+//
+// File: Async_Output.cc
+//
+
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <stdarg.h>
+#include <thread>
+#include <vector>
+
+#include "Async_Output.h"
+#include "Params.h"
+#include "Utils.h"
+
+bool Async_Output::enabled = false;
+std::atomic<bool> Async_Output::writer_running(false);
+std::atomic<bool> Async_Output::stopping(false);
+Async_Output::ring_t Async_Output::rings[Global::MAX_NUM_THREADS];
+
+// the writer thread and what it sleeps on
+static std::thread* writer = NULL;
+static std::mutex writer_mutex;
+static std::condition_variable writer_wakeup;
+
+// stdio buffers of the files opened with open(), reused once closed
+static std::mutex buffer_mutex;
+static std::map<FILE*, char*> file_buffer;
+static std::vector<char*> free_buffers;
+
+void Async_Output::get_parameters() {
+  int temp_int = 0;
+  Params::get_param("enable_async_output", &temp_int);
+  Async_Output::enabled = (temp_int == 0 ? false : true);
+}
+
+FILE* Async_Output::open(const char* filename, const char* mode) {
+  FILE* fp = fopen(filename, mode);
+  if(fp == NULL) {
+    return NULL;
+  }
+  char* buffer;
+  {
+    std::lock_guard<std::mutex> lock(buffer_mutex);
+    if(free_buffers.empty()) {
+      buffer = new char [FILE_BUFFER_SIZE];
+    } else {
+      buffer = free_buffers.back();
+      free_buffers.pop_back();
+    }
+    file_buffer[fp] = buffer;
+  }
+  setvbuf(fp, buffer, _IOFBF, FILE_BUFFER_SIZE);
+  return fp;
+}
+
+void Async_Output::write(FILE* fp, const char* data, int length) {
+  if(Async_Output::enabled == false) {
+    fwrite(data, 1, length, fp);
+    return;
+  }
+  // split records too large to fit in a ring
+  while(length > RING_SIZE / 4) {
+    Async_Output::push(fp, WRITE_RECORD, data, RING_SIZE / 4);
+    data += RING_SIZE / 4;
+    length -= RING_SIZE / 4;
+  }
+  Async_Output::push(fp, WRITE_RECORD, data, length);
+}
+
+void Async_Output::print(FILE* fp, const char* format, ...) {
+  va_list ap;
+  if(Async_Output::enabled == false) {
+    va_start(ap, format);
+    vfprintf(fp, format, ap);
+    va_end(ap);
+    return;
+  }
+  char record[FRED_STRING_SIZE];
+  va_start(ap, format);
+  int length = vsnprintf(record, FRED_STRING_SIZE, format, ap);
+  va_end(ap);
+  if(length < FRED_STRING_SIZE) {
+    Async_Output::write(fp, record, length);
+  } else {
+    std::vector<char> long_record(length + 1);
+    va_start(ap, format);
+    vsnprintf(&long_record[0], length + 1, format, ap);
+    va_end(ap);
+    Async_Output::write(fp, &long_record[0], length);
+  }
+}
+
+void Async_Output::close(FILE* fp) {
+  if(fp == NULL) {
+    return;
+  }
+  if(Async_Output::enabled == false) {
+    Async_Output::close_file(fp);
+    return;
+  }
+  Async_Output::push(fp, CLOSE_RECORD, NULL, 0);
+}
+
+void Async_Output::flush() {
+  if(Async_Output::writer_running == false) {
+    return;
+  }
+  unsigned long long target[Global::MAX_NUM_THREADS];
+  for(int t = 0; t < Global::MAX_NUM_THREADS; ++t) {
+    target[t] = Async_Output::rings[t].tail.load(std::memory_order_acquire);
+  }
+  writer_wakeup.notify_one();
+  for(int t = 0; t < Global::MAX_NUM_THREADS; ++t) {
+    while(Async_Output::rings[t].head.load(std::memory_order_acquire) < target[t]) {
+      std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+  }
+}
+
+void Async_Output::stop() {
+  if(Async_Output::writer_running == false) {
+    return;
+  }
+  Async_Output::flush();
+  {
+    std::lock_guard<std::mutex> lock(writer_mutex);
+    Async_Output::stopping = true;
+  }
+  writer_wakeup.notify_one();
+  writer->join();
+  delete writer;
+  writer = NULL;
+  Async_Output::stopping = false;
+  Async_Output::writer_running = false;
+}
+
+void Async_Output::push(FILE* fp, int type, const char* data, int length) {
+  if(Async_Output::writer_running == false) {
+    Async_Output::start();
+  }
+  ring_t* r = &(Async_Output::rings[fred::omp_get_thread_num()]);
+
+  // records start on eight-byte boundaries so headers never straddle the wrap
+  unsigned long long needed = sizeof(record_header_t) + ((length + 7) & ~7);
+  unsigned long long tail = r->tail.load(std::memory_order_relaxed);
+  while(RING_SIZE - (tail - r->head.load(std::memory_order_acquire)) < needed) {
+    // the ring is full: wait for the writer to catch up
+    writer_wakeup.notify_one();
+    std::this_thread::yield();
+  }
+  record_header_t header;
+  header.fp = fp;
+  header.type = type;
+  header.length = length;
+  Async_Output::ring_put(r, tail, (const char*) &header, sizeof(record_header_t));
+  if(length > 0) {
+    Async_Output::ring_put(r, tail + sizeof(record_header_t), data, length);
+  }
+  r->tail.store(tail + needed, std::memory_order_release);
+
+  // the writer also wakes on its own, so it needs a nudge only when
+  // the ring is filling up
+  if(2 * (tail + needed - r->head.load(std::memory_order_relaxed)) > RING_SIZE) {
+    writer_wakeup.notify_one();
+  }
+}
+
+void Async_Output::start() {
+  std::lock_guard<std::mutex> lock(writer_mutex);
+  if(Async_Output::writer_running) {
+    return;
+  }
+  for(int t = 0; t < Global::MAX_NUM_THREADS; ++t) {
+    ring_t* r = &(Async_Output::rings[t]);
+    if(r->data == NULL) {
+      r->data = new char [RING_SIZE];
+      r->head = 0;
+      r->tail = 0;
+    }
+  }
+  Async_Output::stopping = false;
+  writer = new std::thread(Async_Output::run_writer);
+  Async_Output::writer_running = true;
+}
+
+void Async_Output::run_writer() {
+  for(;;) {
+    if(Async_Output::drain_rings()) {
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(writer_mutex);
+    if(Async_Output::stopping) {
+      break;
+    }
+    writer_wakeup.wait_for(lock, std::chrono::milliseconds(1));
+  }
+  Async_Output::drain_rings();
+}
+
+bool Async_Output::drain_rings() {
+  bool found = false;
+  for(int t = 0; t < Global::MAX_NUM_THREADS; ++t) {
+    ring_t* r = &(Async_Output::rings[t]);
+    unsigned long long head = r->head.load(std::memory_order_relaxed);
+    unsigned long long tail = r->tail.load(std::memory_order_acquire);
+    while(head < tail) {
+      record_header_t header;
+      Async_Output::ring_get(r, head, (char*) &header, sizeof(record_header_t));
+      if(header.type == WRITE_RECORD) {
+	// write straight out of the ring, in two pieces if the record wraps
+	unsigned long long start = (head + sizeof(record_header_t)) & (RING_SIZE - 1);
+	int first = (start + header.length > RING_SIZE ? RING_SIZE - start : header.length);
+	fwrite(r->data + start, 1, first, header.fp);
+	if(first < header.length) {
+	  fwrite(r->data, 1, header.length - first, header.fp);
+	}
+      } else {
+	Async_Output::close_file(header.fp);
+      }
+      head += sizeof(record_header_t) + ((header.length + 7) & ~7);
+      r->head.store(head, std::memory_order_release);
+      found = true;
+    }
+  }
+  return found;
+}
+
+void Async_Output::ring_get(ring_t* r, unsigned long long position, char* dest, int length) {
+  unsigned long long start = position & (RING_SIZE - 1);
+  int first = (start + length > RING_SIZE ? RING_SIZE - start : length);
+  memcpy(dest, r->data + start, first);
+  memcpy(dest + first, r->data, length - first);
+}
+
+void Async_Output::ring_put(ring_t* r, unsigned long long position, const char* src, int length) {
+  unsigned long long start = position & (RING_SIZE - 1);
+  int first = (start + length > RING_SIZE ? RING_SIZE - start : length);
+  memcpy(r->data + start, src, first);
+  memcpy(r->data, src + first, length - first);
+}
+
+void Async_Output::close_file(FILE* fp) {
+  // forget the stream before closing it: once it is closed, open() on
+  // another thread may get the same FILE* back and register a new buffer
+  char* buffer = NULL;
+  {
+    std::lock_guard<std::mutex> lock(buffer_mutex);
+    std::map<FILE*, char*>::iterator found = file_buffer.find(fp);
+    if(found != file_buffer.end()) {
+      buffer = found->second;
+      file_buffer.erase(found);
+    }
+  }
+  fclose(fp);
+  // the buffer is in use until the stream is closed
+  if(buffer != NULL) {
+    std::lock_guard<std::mutex> lock(buffer_mutex);
+    free_buffers.push_back(buffer);
+  }
+}
@@ -0,0 +1,136 @@
+/*
+  This file is part of the FRED system.
+
+  Copyright (c) 2013-2016, University of Pittsburgh, John Grefenstette,
+  David Galloway, Mary Krauland, Michael Lann, and Donald Burke.
+
+  Based in part on FRED Version 2.9, created in 2010-2013 by
+  John Grefenstette, Shawn Brown, Roni Rosenfield, Alona Fyshe, David
+  Galloway, Nathan Stone, Jay DePasse, Anuroop Sriram, and Donald Burke.
+
+  Licensed under the BSD 3-Clause license.  See the file "LICENSE" for
+  more information.
+*/
+
+//
+//
+// File: Async_Output.h
+//
+
+#ifndef _FRED_ASYNC_OUTPUT_H
+#define _FRED_ASYNC_OUTPUT_H
+
+#include <atomic>
+#include <stdio.h>
+#include <string>
+
+#include "Global.h"
+
+/**
+ * Buffered output for the per-day report files.
+ *
+ * Records are formatted by the calling thread and handed to a background
+ * writer thread through a ring buffer owned by the calling thread, so the
+ * simulation never waits on the file system unless a ring fills up. The
+ * writer performs the fwrite and fclose calls in the order each thread
+ * issued them. Records written to the same file by different threads may
+ * interleave, as they always could with fprintf.
+ *
+ * Files opened with open() get a large stdio buffer whether or not the
+ * writer thread is enabled. A file handed to the writer must only be
+ * written and closed through this class; call flush() before touching it
+ * directly, e.g. with ftell().
+ *
+ * The writer thread runs only when the parameter enable_async_output is
+ * set; otherwise every call writes immediately on the calling thread.
+ */
+class Async_Output {
+public:
+
+  /**
+   * Read the enable_async_output parameter.
+   */
+  static void get_parameters();
+
+  static bool is_enabled() {
+    return Async_Output::enabled;
+  }
+
+  /**
+   * Open a file with a large output buffer.
+   *
+   * @param filename the file to open
+   * @param mode the fopen mode
+   * @return the file, or NULL if it could not be opened
+   */
+  static FILE* open(const char* filename, const char* mode);
+
+  /**
+   * Queue bytes to be written to the given file.
+   */
+  static void write(FILE* fp, const char* data, int length);
+
+  static void write(FILE* fp, const std::string &data) {
+    Async_Output::write(fp, data.c_str(), (int) data.length());
+  }
+
+  /**
+   * Format a record on the calling thread and queue it for the given file.
+   */
+  static void print(FILE* fp, const char* format, ...) __attribute__ ((format (printf, 2, 3)));
+
+  /**
+   * Queue the closing of the given file after everything already queued
+   * for it by the calling thread.
+   */
+  static void close(FILE* fp);
+
+  /**
+   * Wait until everything queued so far by any thread has been written.
+   * Must not be called from inside a parallel region.
+   */
+  static void flush();
+
+  /**
+   * Flush and stop the writer thread. The next record starts it again;
+   * batch mode stops it before forking, since threads do not survive a fork.
+   */
+  static void stop();
+
+private:
+  // each thread's ring holds this many bytes of pending records
+  static const int RING_SIZE = 1 << 22;
+
+  // stdio buffer size for files opened with open()
+  static const int FILE_BUFFER_SIZE = 1 << 20;
+
+  enum { WRITE_RECORD, CLOSE_RECORD };
+
+  typedef struct record_header {
+    FILE* fp;
+    int type;
+    int length;
+  } record_header_t;
+
+  typedef struct ring {
+    char* data;
+    std::atomic<unsigned long long> head;	// next byte the writer reads
+    std::atomic<unsigned long long> tail;	// next byte the producer writes
+    char padding[64];
+  } ring_t;
+
+  static void push(FILE* fp, int type, const char* data, int length);
+  static void start();
+  static void run_writer();
+  static bool drain_rings();
+  static void ring_get(ring_t* r, unsigned long long position, char* dest, int length);
+  static void ring_put(ring_t* r, unsigned long long position, const char* src, int length);
+  static void close_file(FILE* fp);
+
+  static bool enabled;
+  static std::atomic<bool> writer_running;
+  static std::atomic<bool> stopping;
+  static ring_t rings[Global::MAX_NUM_THREADS];
+};
+
+#endif // _FRED_ASYNC_OUTPUT_H
@@ -0,0 +1,402 @@
+/*
+  This file is part of the FRED system.
+
+  Copyright (c) 2013-2016, University of Pittsburgh, John Grefenstette,
+  David Galloway, Mary Krauland, Michael Lann, and Donald Burke.
+
+  Based in part on FRED Version 2.9, created in 2010-2013 by
+  John Grefenstette, Shawn Brown, Roni Rosenfield, Alona Fyshe, David
+  Galloway, Nathan Stone, Jay DePasse, Anuroop Sriram, and Donald Burke.
+
+  Licensed under the BSD 3-Clause license.  See the file "LICENSE" for
+  more information.
+*/
+
+//
+//
+// File: Checkpoint.cc
+//
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Async_Output.h"
+#include "Checkpoint.h"
+#include "Classroom.h"
+#include "Condition.h"
+#include "Condition_List.h"
+#include "Date.h"
+#include "Epidemic.h"
+#include "Natural_History.h"
+#include "Office.h"
+#include "Params.h"
+#include "Partition.h"
+#include "Person.h"
+#include "Place.h"
+#include "Place_List.h"
+#include "Population.h"
+#include "Random.h"
+#include "School.h"
+#include "State_Digest.h"
+#include "Tracker.h"
+#include "Utils.h"
+#include "Workplace.h"
+
+// identifies the file format; changed whenever the layout changes
+static const char checkpoint_magic[] = "FRED checkpoint 1";
+
+int Checkpoint::checkpoint_day = -1;
+char Checkpoint::checkpoint_file[FRED_STRING_SIZE];
+char Checkpoint::restore_file[FRED_STRING_SIZE];
+FILE* Checkpoint::fp = NULL;
+const char* Checkpoint::mapped = NULL;
+size_t Checkpoint::mapped_size = 0;
+size_t Checkpoint::mapped_offset = 0;
+std::vector<Place*> Checkpoint::place_with_id;
+
+void Checkpoint::get_parameters() {
+  Params::get_param("checkpoint_day", &Checkpoint::checkpoint_day);
+  Params::get_param("checkpoint_file", Checkpoint::checkpoint_file);
+  Params::get_param("restore_from", Checkpoint::restore_file);
+}
+
+void Checkpoint::check_configuration() {
+  if(Checkpoint::checkpoint_day < 0 && Checkpoint::is_restoring() == false) {
+    return;
+  }
+  if(Checkpoint::checkpoint_day == 0 || Checkpoint::checkpoint_day >= Global::Days) {
+    Utils::fred_abort("checkpoint_day = %d must be between 1 and days-1 = %d\n",
+		      Checkpoint::checkpoint_day, Global::Days - 1);
+  }
+
+  // features whose state is not saved
+  const char* feature = NULL;
+  if(Global::Enable_Population_Dynamics) {
+    feature = "enable_population_dynamics";
+  } else if(Global::Enable_Travel) {
+    feature = "enable_travel";
+  } else if(Global::Enable_Hospitals) {
+    feature = "enable_hospitals";
+  } else if(Global::Enable_Transmission_Network) {
+    feature = "enable_transmission_network";
+  } else if(Global::Enable_Sexual_Partner_Network) {
+    feature = "enable_sexual_partner_network";
+  } else if(Global::Enable_Vector_Layer || Global::Enable_Vector_Transmission) {
+    feature = "enable_vector_layer";
+  } else if(Global::Enable_Visualization_Layer) {
+    feature = "enable_visualization_layer";
+  } else if(Global::Enable_Seasonality) {
+    feature = "enable_seasonality";
+  } else if(Global::Report_Presenteeism || Global::Report_Childhood_Presenteeism) {
+    feature = "report_presenteeism";
+  } else if(Partition::is_enabled()) {
+    feature = "number_of_partitions";
+  }
+  if(feature != NULL) {
+    Utils::fred_abort("checkpoints can't be used with %s\n", feature);
+  }
+  for(int c = 0; c < Global::Conditions.get_number_of_conditions(); ++c) {
+    const char* mode = Global::Conditions.get_condition(c)->get_transmission_mode();
+    if(strcmp(mode, "sexual") == 0 || strcmp(mode, "vector") == 0) {
+      Utils::fred_abort("checkpoints can't be used with %s transmission\n", mode);
+    }
+  }
+}
+
+void Checkpoint::get_places(std::vector<Place*> &places) {
+  places.clear();
+  for(int i = 0; i < Global::Places.get_number_of_households(); ++i) {
+    places.push_back(Global::Places.get_household(i));
+  }
+  for(int i = 0; i < Global::Places.get_number_of_neighborhoods(); ++i) {
+    places.push_back(Global::Places.get_neighborhood(i));
+  }
+  for(int i = 0; i < Global::Places.get_number_of_schools(); ++i) {
+    School* school = Global::Places.get_school(i);
+    places.push_back(school);
+    for(int c = 0; c < school->get_number_of_classrooms(); ++c) {
+      places.push_back(school->get_classroom(c));
+    }
+  }
+  for(int i = 0; i < Global::Places.get_number_of_workplaces(); ++i) {
+    Workplace* workplace = Global::Places.get_workplace(i);
+    places.push_back(workplace);
+    for(int c = 0; c < workplace->get_number_of_offices(); ++c) {
+      places.push_back(workplace->get_office(c));
+    }
+  }
+  for(int i = 0; i < Global::Places.get_number_of_hospitals(); ++i) {
+    places.push_back(Global::Places.get_hospital(i));
+  }
+}
+
+void Checkpoint::write(int day) {
+  char filename[FRED_STRING_SIZE];
+  strcpy(filename, Checkpoint::checkpoint_file);
+  Utils::get_fred_file_name(filename);
+  Checkpoint::fp = fopen(filename, "wb");
+  if(Checkpoint::fp == NULL) {
+    Utils::fred_abort("Checkpoint: can't open %s\n", filename);
+  }
+  std::vector<char> buffer(1 << 20);
+  setvbuf(Checkpoint::fp, buffer.data(), _IOFBF, buffer.size());
+
+  // header: what the restoring run must match
+  Checkpoint::put_string(checkpoint_magic);
+  Checkpoint::put(day);
+  int popsize = Global::Pop.get_population_size();
+  Checkpoint::put(popsize);
+  std::vector<Place*> places;
+  Checkpoint::get_places(places);
+  int number_of_places = places.size();
+  Checkpoint::put(number_of_places);
+  int conditions = Global::Conditions.get_number_of_conditions();
+  Checkpoint::put(conditions);
+  for(int c = 0; c < conditions; ++c) {
+    Checkpoint::put_string(Global::Conditions.get_condition(c)->get_condition_name());
+  }
+  int threads = fred::omp_get_max_threads();
+  Checkpoint::put(threads);
+
+  for(int t = 0; t < threads; ++t) {
+    Checkpoint::put_string(Random::get_state(t));
+  }
+  for(int p = 0; p < popsize; ++p) {
+    Global::Pop.get_person(p)->write_checkpoint();
+  }
+  for(int i = 0; i < number_of_places; ++i) {
+    Checkpoint::put(places[i]->get_id());
+    places[i]->write_checkpoint();
+  }
+  for(int c = 0; c < conditions; ++c) {
+    Global::Conditions.get_condition(c)->get_epidemic()->write_checkpoint(day);
+  }
+  School::write_closure_checkpoint();
+  State_Digest::write_checkpoint();
+
+  // the daily report values
+  Tracker<int>* tracker = Global::Daily_Tracker;
+  Checkpoint::put_vector(tracker->indices);
+  Checkpoint::put((int) tracker->values_map_int.size());
+  for(map<string, vector<int> >::iterator itr = tracker->values_map_int.begin(); itr != tracker->values_map_int.end(); ++itr) {
+    Checkpoint::put_string(itr->first);
+    Checkpoint::put_vector(itr->second);
+  }
+  Checkpoint::put((int) tracker->values_map_double.size());
+  for(map<string, vector<double> >::iterator itr = tracker->values_map_double.begin(); itr != tracker->values_map_double.end(); ++itr) {
+    Checkpoint::put_string(itr->first);
+    Checkpoint::put_vector(itr->second);
+  }
+  Checkpoint::put((int) tracker->values_map_string.size());
+  for(map<string, vector<string> >::iterator itr = tracker->values_map_string.begin(); itr != tracker->values_map_string.end(); ++itr) {
+    Checkpoint::put_string(itr->first);
+    Checkpoint::put((int) itr->second.size());
+    for(int i = 0; i < (int) itr->second.size(); ++i) {
+      Checkpoint::put_string(itr->second[i]);
+    }
+  }
+
+  Checkpoint::put_string(checkpoint_magic);
+  if(fclose(Checkpoint::fp) != 0) {
+    Checkpoint::file_error();
+  }
+  Checkpoint::fp = NULL;
+  fprintf(Global::Statusfp, "checkpoint of day %d written to %s\n", day, filename);
+  fflush(Global::Statusfp);
+}
+
+int Checkpoint::restore() {
+  char filename[FRED_STRING_SIZE];
+  strcpy(filename, Checkpoint::restore_file);
+  Utils::get_fred_file_name(filename);
+  int fd = open(filename, O_RDONLY);
+  if(fd < 0) {
+    Utils::fred_abort("Checkpoint: can't open %s\n", filename);
+  }
+  struct stat file_status;
+  if(fstat(fd, &file_status) != 0 || file_status.st_size == 0) {
+    Utils::fred_abort("Checkpoint: %s is empty\n", filename);
+  }
+  Checkpoint::mapped_size = file_status.st_size;
+  void* file_map = mmap(NULL, Checkpoint::mapped_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if(file_map == MAP_FAILED) {
+    Utils::fred_abort("Checkpoint: can't map %s\n", filename);
+  }
+  madvise(file_map, Checkpoint::mapped_size, MADV_SEQUENTIAL);
+  Checkpoint::mapped = static_cast<const char*>(file_map);
+  Checkpoint::mapped_offset = 0;
+
+  if(Checkpoint::get_string() != checkpoint_magic) {
+    Utils::fred_abort("Checkpoint: %s is not a checkpoint of this version of FRED\n", filename);
+  }
+  int day = 0;
+  Checkpoint::get(day);
+  if(day >= Global::Days) {
+    Utils::fred_abort("Checkpoint: %s was written on day %d, but days = %d\n", filename, day, Global::Days);
+  }
+  if(0 <= Checkpoint::checkpoint_day && Checkpoint::checkpoint_day < day) {
+    Utils::fred_abort("Checkpoint: checkpoint_day = %d is before day %d of %s\n",
+		      Checkpoint::checkpoint_day, day, filename);
+  }
+  int popsize = Global::Pop.get_population_size();
+  int saved = 0;
+  Checkpoint::get(saved);
+  Checkpoint::check("people", saved, popsize);
+  std::vector<Place*> places;
+  Checkpoint::get_places(places);
+  int number_of_places = places.size();
+  Checkpoint::get(saved);
+  Checkpoint::check("places", saved, number_of_places);
+  int conditions = Global::Conditions.get_number_of_conditions();
+  Checkpoint::get(saved);
+  Checkpoint::check("conditions", saved, conditions);
+  for(int c = 0; c < conditions; ++c) {
+    std::string name = Checkpoint::get_string();
+    if(name != Global::Conditions.get_condition(c)->get_condition_name()) {
+      Utils::fred_abort("Checkpoint: condition %d is %s in the checkpoint but %s in this run\n",
+			c, name.c_str(), Global::Conditions.get_condition(c)->get_condition_name());
+    }
+  }
+  Checkpoint::get(saved);
+  Checkpoint::check("threads", saved, fred::omp_get_max_threads());
+
+  // index the places by id
+  Checkpoint::place_with_id.clear();
+  for(int i = 0; i < number_of_places; ++i) {
+    int id = places[i]->get_id();
+    if(id >= static_cast<int>(Checkpoint::place_with_id.size())) {
+      Checkpoint::place_with_id.resize(id + 1, NULL);
+    }
+    Checkpoint::place_with_id[id] = places[i];
+  }
+
+  for(int t = 0; t < fred::omp_get_max_threads(); ++t) {
+    Random::set_state(t, Checkpoint::get_string());
+  }
+  for(int p = 0; p < popsize; ++p) {
+    Global::Pop.get_person(p)->read_checkpoint();
+  }
+  for(int i = 0; i < number_of_places; ++i) {
+    int id = 0;
+    Checkpoint::get(id);
+    Checkpoint::check("place id", id, places[i]->get_id());
+    places[i]->read_checkpoint();
+  }
+  for(int c = 0; c < conditions; ++c) {
+    Global::Conditions.get_condition(c)->get_epidemic()->read_checkpoint(day);
+  }
+  School::read_closure_checkpoint();
+  State_Digest::read_checkpoint();
+
+  Tracker<int>* tracker = Global::Daily_Tracker;
+  Checkpoint::get_vector(tracker->indices);
+  int keys = 0;
+  tracker->values_map_int.clear();
+  Checkpoint::get(keys);
+  for(int k = 0; k < keys; ++k) {
+    std::string key = Checkpoint::get_string();
+    Checkpoint::get_vector(tracker->values_map_int[key]);
+  }
+  tracker->values_map_double.clear();
+  Checkpoint::get(keys);
+  for(int k = 0; k < keys; ++k) {
+    std::string key = Checkpoint::get_string();
+    Checkpoint::get_vector(tracker->values_map_double[key]);
+  }
+  tracker->values_map_string.clear();
+  Checkpoint::get(keys);
+  for(int k = 0; k < keys; ++k) {
+    std::string key = Checkpoint::get_string();
+    vector<string> &values = tracker->values_map_string[key];
+    int n = 0;
+    Checkpoint::get(n);
+    values.resize(n);
+    for(int i = 0; i < n; ++i) {
+      values[i] = Checkpoint::get_string();
+    }
+  }
+
+  if(Checkpoint::get_string() != checkpoint_magic) {
+    Utils::fred_abort("Checkpoint: %s is corrupt\n", filename);
+  }
+  munmap(file_map, Checkpoint::mapped_size);
+  Checkpoint::mapped = NULL;
+  Checkpoint::mapped_size = 0;
+  Checkpoint::mapped_offset = 0;
+  Checkpoint::place_with_id.clear();
+
+  // advance the calendar, and repeat the daily reports of the earlier days
+  for(int d = 0; d < day; ++d) {
+    Date::update();
+    Async_Output::write(Global::Outfp, tracker->print_inline_report_format_for_index(d));
+  }
+
+  fprintf(Global::Statusfp, "restored the state at the start of day %d from %s\n", day, filename);
+  fflush(Global::Statusfp);
+  return day;
+}
+
+void Checkpoint::put_string(const std::string &value) {
+  int n = value.size();
+  Checkpoint::put(n);
+  Checkpoint::put_array(value.data(), n);
+}
+
+std::string Checkpoint::get_string() {
+  int n = 0;
+  Checkpoint::get(n);
+  if(n < 0 || n > (1 << 24)) {
+    Checkpoint::file_error();
+  }
+  std::string value(n, ' ');
+  Checkpoint::get_array(&value[0], n);
+  return value;
+}
+
+void Checkpoint::put_person(Person* person) {
+  int index = (person == NULL ? -1 : person->get_pop_index());
+  Checkpoint::put(index);
+}
+
+Person* Checkpoint::get_person() {
+  int index = -1;
+  Checkpoint::get(index);
+  if(index == -1) {
+    return NULL;
+  }
+  if(index < 0 || index >= Global::Pop.get_population_size()) {
+    Checkpoint::file_error();
+  }
+  return Global::Pop.get_person(index);
+}
+
+void Checkpoint::put_place(Mixing_Group* place) {
+  int id = (place == NULL ? -1 : place->get_id());
+  Checkpoint::put(id);
+}
+
+Place* Checkpoint::get_place() {
+  int id = -1;
+  Checkpoint::get(id);
+  if(id == -1) {
+    return NULL;
+  }
+  if(id < 0 || id >= static_cast<int>(Checkpoint::place_with_id.size()) || Checkpoint::place_with_id[id] == NULL) {
+    Checkpoint::file_error();
+  }
+  return Checkpoint::place_with_id[id];
+}
+
+void Checkpoint::check(const char* what, int saved, int current) {
+  if(saved != current) {
+    Utils::fred_abort("Checkpoint: the checkpoint has %d %s but this run has %d\n", saved, what, current);
+  }
+}
+
+void Checkpoint::file_error() {
+  Utils::fred_abort("Checkpoint: error reading or writing the checkpoint file\n");
+}
@@ -0,0 +1,187 @@
+/*
+  This file is part of the FRED system.
+
+  Copyright (c) 2013-2016, University of Pittsburgh, John Grefenstette,
+  David Galloway, Mary Krauland, Michael Lann, and Donald Burke.
+
+  Based in part on FRED Version 2.9, created in 2010-2013 by
+  John Grefenstette, Shawn Brown, Roni Rosenfield, Alona Fyshe, David
+  Galloway, Nathan Stone, Jay DePasse, Anuroop Sriram, and Donald Burke.
+
+  Licensed under the BSD 3-Clause license.  See the file "LICENSE" for
+  more information.
+*/
+
+//
+//
+// File: Checkpoint.h
+//
+
+#ifndef _FRED_CHECKPOINT_H
+#define _FRED_CHECKPOINT_H
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "Global.h"
+
+class Mixing_Group;
+class Person;
+class Place;
+
+/**
+ * Binary checkpoints of the simulation state at the start of a day.
+ *
+ * With checkpoint_day = N, the state at the start of day N is written
+ * to checkpoint_file before day N is simulated. A run with
+ * restore_from set to that file sets up the population and places from
+ * the same input files, replaces their dynamic state (health, daily
+ * activities, enrollments, place counters, epidemic lists, counters and
+ * event queues, the random number streams and the daily report values)
+ * by the saved state, and continues with day N. The continuation is
+ * identical to the run that wrote the checkpoint, unless parameters
+ * that affect days N and later (such as interventions) are changed.
+ *
+ * This is a partial implementation of full-state checkpoints. The
+ * population and places are not saved, so the restoring run repeats
+ * the setup, and the state of features that change them or keep their
+ * own queues is not saved: the Demographics event queues (population
+ * dynamics), the Travel return events, hospital stays, the network
+ * links and the vector layer. Runs that use these features can't write
+ * or restore checkpoints (see check_configuration()).
+ *
+ * The checkpoint is written sequentially and restored from a read-only
+ * memory map of the file. The random number streams are saved in the
+ * text form of the standard library engines and distributions, which
+ * is the only form that includes the values the distributions cache.
+ *
+ * The out.csv rows of the days before N are copied from the checkpoint.
+ * Other output files of the restored run start on day N.
+ *
+ * People are identified by their index in the population and places
+ * by their id, so the checkpoint can be restored only by a run with the
+ * same population, places, conditions and number of threads.
+ */
+class Checkpoint {
+public:
+
+  /**
+   * Read the checkpoint_day, checkpoint_file and restore_from parameters.
+   */
+  static void get_parameters();
+
+  static int get_checkpoint_day() {
+    return Checkpoint::checkpoint_day;
+  }
+
+  static bool is_restoring() {
+    return strcmp(Checkpoint::restore_file, "none") != 0;
+  }
+
+  /**
+   * Abort if the run uses a feature whose state is not saved.
+   */
+  static void check_configuration();
+
+  /**
+   * Write the state at the start of the given day.
+   */
+  static void write(int day);
+
+  /**
+   * Replace the state of the newly set up simulation by the saved state.
+   *
+   * @return the day on which the restored run continues
+   */
+  static int restore();
+
+  // values written to and read from the open checkpoint file
+
+  template <typename T>
+  static void put(const T &value) {
+    if(fwrite(&value, sizeof(T), 1, Checkpoint::fp) != 1) {
+      Checkpoint::file_error();
+    }
+  }
+
+  template <typename T>
+  static void get(T &value) {
+    Checkpoint::get_array(&value, 1);
+  }
+
+  template <typename T>
+  static void put_array(const T* values, int n) {
+    if(n > 0 && fwrite(values, sizeof(T), n, Checkpoint::fp) != (size_t) n) {
+      Checkpoint::file_error();
+    }
+  }
+
+  template <typename T>
+  static void get_array(T* values, int n) {
+    size_t size = sizeof(T) * (size_t) (n > 0 ? n : 0);
+    if(n < 0 || Checkpoint::mapped_size - Checkpoint::mapped_offset < size) {
+      Checkpoint::file_error();
+    }
+    if(size > 0) {
+      memcpy(values, Checkpoint::mapped + Checkpoint::mapped_offset, size);
+      Checkpoint::mapped_offset += size;
+    }
+  }
+
+  template <typename T>
+  static void put_vector(const std::vector<T> &values) {
+    int n = values.size();
+    Checkpoint::put(n);
+    Checkpoint::put_array(values.data(), n);
+  }
+
+  template <typename T>
+  static void get_vector(std::vector<T> &values) {
+    int n = 0;
+    Checkpoint::get(n);
+    values.resize(n);
+    Checkpoint::get_array(values.data(), n);
+  }
+
+  static void put_string(const std::string &value);
+  static std::string get_string();
+
+  /**
+   * A person is saved as their population index (-1 for NULL).
+   */
+  static void put_person(Person* person);
+  static Person* get_person();
+
+  /**
+   * A place is saved as its id (-1 for NULL).
+   */
+  static void put_place(Mixing_Group* place);
+  static Place* get_place();
+
+  /**
+   * Check a count in the checkpoint against the corresponding count of
+   * the restoring run.
+   */
+  static void check(const char* what, int saved, int current);
+
+private:
+  static int checkpoint_day;
+  static char checkpoint_file[FRED_STRING_SIZE];
+  static char restore_file[FRED_STRING_SIZE];
+  static FILE* fp;
+
+  // the mapped checkpoint being restored, and the read position in it
+  static const char* mapped;
+  static size_t mapped_size;
+  static size_t mapped_offset;
+
+  // the places of the restoring run, by id
+  static std::vector<Place*> place_with_id;
+
+  static void get_places(std::vector<Place*> &places);
+  static void file_error();
+};
+
+#endif // _FRED_CHECKPOINT_H
@@ -103,19 +103,24 @@ double Classroom::get_contacts_per_day(int condition) {
 }
 
 int Classroom::get_group(int condition, Person* per) {
-  return this->school->get_group(condition, per);
+  return this->school->School::get_group(condition, per);
 }
 
 double Classroom::get_transmission_prob(int condition, Person* i, Person* s) {
 
   // i = infected agent
   // s = susceptible agent
-  int row = get_group(condition, i);
-  int col = get_group(condition, s);
+  int row = Classroom::get_group(condition, i);
+  int col = Classroom::get_group(condition, s);
   double tr_pr = Classroom::prob_transmission_per_contact[row][col];
   return tr_pr;
 }
 
+double Classroom::get_transmission_prob_for_group(int condition, int row, Person* s) {
+  int col = Classroom::get_group(condition, s);
+  return Classroom::prob_transmission_per_contact[row][col];
+}
+
 bool Classroom::is_open(int day) {
   bool open = this->school->is_open(day);
   if(!open) {
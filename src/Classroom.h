@@ -60,6 +60,13 @@ public:
    */
   double get_transmission_prob(int condition, Person* i, Person* s);
 
+  /**
+   * The transmission probability for an infector in the given group (row
+   * of the contact matrix), for callers that look up many susceptibles
+   * with the same infector.
+   */
+  double get_transmission_prob_for_group(int condition, int row, Person* s);
+
   bool is_open(int day);
 
   /**
@@ -309,11 +309,13 @@ bool County::increment_popsize(Person* person) {
       this->female_popsize[age]++;
       this->tot_female_popsize++;
       this->tot_current_popsize++;
+      this->age_histogram.add(person);
       return true;
     } else if(sex == 'M') {
       this->male_popsize[age]++;
       this->tot_male_popsize++;
       this->tot_current_popsize++;
+      this->age_histogram.add(person);
       return true;
     }
   }
@@ -331,11 +333,13 @@ bool County::decrement_popsize(Person* person) {
       this->female_popsize[age]--;
       this->tot_female_popsize--;
       this->tot_current_popsize--;
+      this->age_histogram.remove(person);
       return true;
     } else if(sex == 'M') {
       this->male_popsize[age]--;
       this->tot_male_popsize--;
       this->tot_current_popsize--;
+      this->age_histogram.remove(person);
       return true;
     }
   }
@@ -2495,7 +2499,7 @@ void County::add_immigrant(int age, char sex) {
   Place* house = this->households[hnum];
 
   Person* person = Global::Pop.add_person_to_population(age, sex, race, rel, house, school, work, day, false);
-  person->unset_native();
+  Global::Pop.unset_native(person);
   person->get_demographics()->initialize_demographic_dynamics(person);
   person->update_profile_after_changing_household();
   if (Global::Verbose > 1) {
@@ -2542,6 +2546,7 @@ void County::recompute_county_popsize() {
     this->female_popsize[i] = 0;
     this->male_popsize[i] = 0;
   }
+  this->age_histogram = Age_Histogram();
   for (int i = 0; i < this->number_of_households; i++) {
     Household* hh = this->households[i];
     int hh_size = hh->get_size();
@@ -2555,6 +2560,7 @@ void County::recompute_county_popsize() {
       else {
 	this->female_popsize[age]++;
       }
+      this->age_histogram.add(person);
     }
   }
 }
@@ -2600,42 +2606,22 @@ void County::report() {
   }
   int males[18];
   int females[18];
-  int male_count = 0;
-  int female_count = 0;
-  std::vector<double>ages;
-  ages.clear();
-  ages.reserve(this->tot_current_popsize);
+  int male_count = this->age_histogram.get_males();
+  int female_count = this->age_histogram.get_females();
+  int popsize = this->age_histogram.get_total();
+  double median = this->age_histogram.get_median_age();
   for (int i = 0; i < 18; i++) {
     males[i] = 0;
     females[i] = 0;
   }
-
-  int popsize = 0;
-  for (int i = 0; i < this->number_of_households; i++) {
-    Household* hh = this->households[i];
-    int hh_size = hh->get_size();
-    for (int j = 0; j < hh_size; j++) {
-      Person* person = hh->get_enrollee(j);
-      ages.push_back(person->get_real_age());
-      int age = person->get_age();
-      int age_group = age / 5;
-      if (age_group > 17) { 
-	age_group = 17;
-      }
-      if (person->get_sex()=='M') {
-	males[age_group]++;
-	male_count++;
-      }
-      else {
-	females[age_group]++;
-	female_count++;
-      }
-      popsize++;
+  for (int age = 0; age <= Demographics::MAX_AGE; age++) {
+    int age_group = age / 5;
+    if (age_group > 17) { 
+      age_group = 17;
     }
+    males[age_group] += this->age_histogram.get_count(age, 'M');
+    females[age_group] += this->age_histogram.get_count(age, 'F');
   }
-  this->tot_current_popsize = popsize;
-  std::sort(ages.begin(), ages.end());
-  double median = ages[popsize/2];
 
   char filename[FRED_STRING_SIZE];
   sprintf(filename, "%s/pop-%d-%d.txt",
@@ -23,6 +23,7 @@
 #include <vector>
 using namespace std;
 
+#include "Age_Histogram.h"
 #include "Demographics.h"
 class Household;
 class Person;
@@ -178,6 +179,9 @@ private:
   int female_popsize[Demographics::MAX_AGE + 1];
   int tot_female_popsize;
 
+  // the same people by age and birthday, for the yearly report
+  Age_Histogram age_histogram;
+
   double male_mortality_rate[Demographics::MAX_AGE + 1];
   double female_mortality_rate[Demographics::MAX_AGE + 1];
   double mortality_rate_adjustment_weight;
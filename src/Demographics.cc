@@ -18,6 +18,7 @@
 //
 #include <limits>
 
+#include "Async_Output.h"
 #include "County.h"
 #include "Demographics.h"
 #include "Events.h"
@@ -298,10 +299,12 @@ void Demographics::birthday(Person* self, int day ) {
   int fips = self->get_household()->get_county_fips();
   //The count of agents at the current age is decreased by 1
   Global::Places.decrement_population_of_county(fips, self);
+  Global::Pop.decrement_age_count(self);
   // change age
   this->age++;
   //The count of agents at the new age is increased by 1
   Global::Places.increment_population_of_county(fips, self);
+  Global::Pop.increment_age_count(self);
 
   // will this person die in the next year?
   double age_specific_probability_of_death = 0.0;
@@ -449,7 +452,7 @@ void Demographics::update(int day) {
     // add dying to the population death_list
     Person * person = Demographics::mortality_queue->get_event(day, i);
     if (Global::Enable_Health_Records) {
-      fprintf(Global::HealthRecordfp,
+      Async_Output::print(Global::HealthRecordfp,
 	      "HEALTH RECORD: %s day %d person %d age %d DIES FROM UNKNOWN CAUSE.\n",
 	      Date::get_date_string().c_str(),
 	      day,
@@ -27,6 +27,8 @@
 
 using namespace std;
 
+#include "Async_Output.h"
+#include "Checkpoint.h"
 #include "Classroom.h"
 #include "Condition.h"
 #include "Date.h"
@@ -37,17 +39,21 @@ using namespace std;
 #include "HIV_Epidemic.h"
 #include "Hospital.h"
 #include "Household.h"
+#include "Incidence_Cube.h"
 #include "Natural_History.h"
 #include "Neighborhood_Layer.h"
 #include "Office.h"
 #include "Params.h"
+#include "Partition.h"
 #include "Person.h"
 #include "Place.h"
 #include "Place_List.h"
 #include "Population.h"
+#include "Profiler.h"
 #include "Random.h"
 #include "School.h"
 #include "Sexual_Transmission_Network.h"
+#include "State_Digest.h"
 #include "Tracker.h"
 #include "Transmission.h"
 #include "Utils.h"
@@ -104,6 +110,8 @@ Epidemic::Epidemic(Condition* _condition) {
   this->county_incidence = NULL;
   this->census_tract_incidence = NULL;
   this->census_tract_symp_incidence = NULL;
+  this->county_cube = NULL;
+  this->census_tract_cube = NULL;
 
   // these are total (among current population)
   this->total_cases = 0;
@@ -318,6 +326,12 @@ void Epidemic::setup() {
   // restore requiring parameters
   Params::set_abort_on_failure();
 
+  if(Global::Report_Transmission_Counters) {
+    for(int t = 0; t < Global::MAX_NUM_THREADS; ++t) {
+      this->transmission_counters[t].assign(TC_CELLS + TC_PADDING, 0);
+    }
+  }
+
   FRED_VERBOSE(0, "setup for epidemic condition %s finished\n",
 	       this->condition->get_condition_name());
 
@@ -335,10 +349,21 @@ void Epidemic::prepare() {
   // initialize the population
   int day = 0;
   int popsize = Global::Pop.get_population_size();
+
+  // the logit scores depend only on each person, so they are computed in
+  // parallel; the random initial states are then drawn in id order, so
+  // the result does not depend on the number of threads
+  std::vector<double> immunity_score(popsize);
+  std::vector<double> initialization_score(popsize);
+#pragma omp parallel for schedule(static)
+  for(int p = 0; p < popsize; ++p) {
+    this->natural_history->get_initial_state_scores(Global::Pop.get_person(p), &immunity_score[p], &initialization_score[p]);
+  }
+
   for(int p = 0; p < popsize; ++p) {
     Person* person = Global::Pop.get_person(p);
     int old_state = person->get_health_state(this->id);
-    int new_state = this->natural_history->get_initial_state(person);
+    int new_state = this->natural_history->get_initial_state(person, immunity_score[p], initialization_score[p]);
     
     FRED_VERBOSE(1, "INITIAL_STATE COND %d day %d id %d age %0.2f race %d sex %c old_state %d new_state %d\n", 
 		 this->id, day, person->get_id(), person->get_real_age(), person->get_race(), person->get_sex(), old_state, new_state);
@@ -393,6 +418,12 @@ void Epidemic::prepare() {
 //
 //
 
+// names of the place types in find_active_places_of_type(), used for
+// profiler zones and transmission counters
+static const char* place_type_name[7] = {
+  "household", "neighborhood", "school", "classroom", "workplace", "office", "hospital"
+};
+
 void Epidemic::update(int day) {
 
   FRED_VERBOSE(1, "epidemic update for condition %s day %d\n",
@@ -407,10 +438,14 @@ void Epidemic::update(int day) {
     // }
 
   // import infections from unknown sources
-  get_imported_cases(day);
+  {
+    Profiler_Zone zone("imported cases");
+    get_imported_cases(day);
+  }
   // Utils::fred_print_epidemic_timer("imported infections");
 
   // handle scheduled transitions
+  Profiler_Zone transitions_zone("transitions");
   int size = this->state_transition_event_queue.get_size(day);
   FRED_VERBOSE(1, "TRANSITION_EVENT_QUEUE day %d %s size %d\n",
 	       day, Date::get_date_string().c_str(), size);
@@ -420,10 +455,12 @@ void Epidemic::update(int day) {
     update_state_of_person(person, day, -1);
   }
   this->state_transition_event_queue.clear_events(day);
+  transitions_zone.stop();
 
   // FRED_VERBOSE(0, "day %d ACTIVE_PEOPLE_LIST size = %d\n", day, this->active_people_list.size());
 
   // update list of active people
+  Profiler_Zone active_zone("active people");
   for(person_set_iterator itr = this->active_people_list.begin(); itr != this->active_people_list.end(); ) {
     Person* person = (*itr);
     FRED_VERBOSE(1, "update_condition for person %d day %d\n", person->get_id(), day);
@@ -458,6 +495,7 @@ void Epidemic::update(int day) {
       ++itr;
     }
   }
+  active_zone.stop();
 
   // FRED_VERBOSE(0, "day %d ACTIVE_PEOPLE_LIST size = %d\n", day, this->active_people_list.size());
   // FRED_VERBOSE(0, "day %d INFECTIOUS_PEOPLE_LIST size = %d\n", day, this->infectious_people_list.size());
@@ -465,6 +503,7 @@ void Epidemic::update(int day) {
   this->current_infectious_people = this->infectious_people_list.size();
 
   // update the daily activities of infectious people
+  Profiler_Zone activities_zone("infectious activities");
   for(person_set_iterator itr = this->infectious_people_list.begin(); itr != this->infectious_people_list.end(); ++itr ) {
     Person* person = (*itr);
 
@@ -479,19 +518,28 @@ void Epidemic::update(int day) {
       // note: places visited by infectious person will be added to the daily places in find_active_places_of_type()
     }
   }
+  activities_zone.stop();
   Utils::fred_print_epidemic_timer("schedules updated");
 
+  // in a partitioned run, exchange today's visits with the other partitions
+  if(Partition::is_enabled() && strcmp("respiratory", this->condition->get_transmission_mode()) == 0) {
+    Profiler_Zone zone("exchange partition visits");
+    Partition::exchange_visits(day, this->id);
+  }
+
   if(strcmp("sexual", this->condition->get_transmission_mode()) == 0) {
+    Profiler_Zone zone("sexual");
     Sexual_Transmission_Network* st_network = Global::Sexual_Partner_Network;
     this->condition->get_transmission()->spread_infection(day, this->id, st_network);
     st_network->clear_infectious_people(this->id);
   } else {
     // spread infection in places attended by actually infectious people
     for(int type = 0; type < 7; ++type) {
+      Profiler_Zone zone(place_type_name[type]);
       find_active_places_of_type(day, type);
       spread_infection_in_active_places(day);
       char msg[80];
-      sprintf(msg, "spread_infection for type %d", type);
+      snprintf(msg, sizeof(msg), "spread_infection for type %d", type);
       Utils::fred_print_epidemic_timer(msg);
     }
   }
@@ -536,24 +584,17 @@ void Epidemic::get_imported_cases(int day) {
         people.clear();
 
         // find households that qualify by location
-        int hsize = Global::Places.get_number_of_households();
+        std::vector<int> houses;
+        Global::Places.get_households_within_radius(lat, lon, (fips ? 0.0 : radius), houses);
+        int hsize = houses.size();
         // printf("IMPORT: houses  %d\n", hsize); fflush(stdout);
         for(int i = 0; i < hsize; ++i) {
-          Household* hh = Global::Places.get_household(i);
+          Household* hh = Global::Places.get_household(houses[i]);
 	  if (fips) {
 	    if (hh->get_census_tract_fips() != fips) {
 	      continue;
 	    }
 	  }
-	  else {
-	    double dist = 0.0;
-	    if(radius > 0) {
-	      dist = Geo::xy_distance(lat,lon,hh->get_latitude(),hh->get_longitude());
-	      if(radius < dist) {
-		continue;
-	      }
-	    }
-	  }
           // this household qualifies by location
           // find all susceptible housemates who qualify by age.
           int size = hh->get_size();
@@ -579,11 +620,19 @@ void Epidemic::get_imported_cases(int day) {
 	  imported_cases_remaining = import_spec->per_cap * people.size();
 	}
 
-	FRED_VERBOSE(0, "IMPORT: seeking %d candidates, found %d\n", imported_cases_remaining, (int) people.size());
+	// in a partitioned run, a fixed number of cases is drawn from the
+	// candidates of all partitions
+	int candidates = people.size();
+	int imported_cases_here = imported_cases_remaining;
+	if (Partition::is_enabled() && import_spec->per_cap <= 0.0) {
+	  candidates = Partition::share_imported_cases(people.size(), imported_cases_remaining, &imported_cases_here);
+	}
+
+	FRED_VERBOSE(0, "IMPORT: seeking %d candidates, found %d\n", imported_cases_remaining, candidates);
 
-        if(imported_cases_remaining <= people.size()) {
+        if(imported_cases_remaining <= candidates) {
           // we have at least the minimum number of candidates.
-          for(int n = 0; n < imported_cases_remaining; ++n) {
+          for(int n = 0; n < imported_cases_here; ++n) {
             FRED_VERBOSE(1, "IMPORT candidate %d people.size %d\n", n, (int)people.size());
 
             // pick a candidate without replacement
@@ -607,8 +656,8 @@ void Epidemic::get_imported_cases(int day) {
             FRED_VERBOSE(1, "HEALTH IMPORT infecting candidate %d person %d\n", n, person->get_id());
 	    person->become_exposed(this->id, NULL, NULL, day);
 	    become_exposed(person, day);
-            imported_cases++;
           }
+          imported_cases += candidates;
         }
 
         if(radius > 0) {
@@ -710,8 +759,63 @@ void Epidemic::find_active_places_of_type(int day, int place_type) {
     }
   }
 
+  if(Global::Report_Transmission_Counters) {
+    std::vector<long long> &counters = this->transmission_counters[fred::omp_get_thread_num()];
+    for(place_set_iterator itr = this->active_places_list.begin(); itr != this->active_places_list.end(); ++itr) {
+      int index = get_transmission_counter_index(*itr, TC_PLACES);
+      if(index >= 0) {
+	counters[index]++;
+      }
+    }
+  }
+
   FRED_VERBOSE(1, "find_active_places_of_type %d found %d\n", place_type, this->active_places_list.size());
 }
+
+
+int Epidemic::get_transmission_counter_index(Place* place, int counter) {
+  char type = place->get_type();
+  int type_index;
+  if(type == Place::TYPE_HOUSEHOLD) {
+    type_index = 0;
+  } else if(type == Place::TYPE_NEIGHBORHOOD) {
+    type_index = 1;
+  } else if(type == Place::TYPE_SCHOOL) {
+    type_index = 2;
+  } else if(type == Place::TYPE_CLASSROOM) {
+    type_index = 3;
+  } else if(type == Place::TYPE_WORKPLACE) {
+    type_index = 4;
+  } else if(type == Place::TYPE_OFFICE) {
+    type_index = 5;
+  } else if(type == Place::TYPE_HOSPITAL) {
+    type_index = 6;
+  } else {
+    return -1;
+  }
+
+  // size buckets: 1-5, 6-25, 26-200, over 200
+  int size = place->get_size();
+  int bucket = (size <= 5 ? 0 : (size <= 25 ? 1 : (size <= 200 ? 2 : 3)));
+  return (type_index * TC_SIZE_BUCKETS + bucket) * TC_COUNTERS + counter;
+}
+
+
+void Epidemic::count_transmission_work(Place* place, int infectors, int contacts, int draws, int attempts, int infections) {
+  std::vector<long long> &counters = this->transmission_counters[fred::omp_get_thread_num()];
+  if(counters.empty()) {
+    return;
+  }
+  int index = get_transmission_counter_index(place, 0);
+  if(index < 0) {
+    return;
+  }
+  counters[index + TC_INFECTORS] += infectors;
+  counters[index + TC_CONTACTS] += contacts;
+  counters[index + TC_DRAWS] += draws;
+  counters[index + TC_ATTEMPTS] += attempts;
+  counters[index + TC_INFECTIONS] += infections;
+}
   
 void Epidemic::spread_infection_in_active_places(int day) {
   // FRED_VERBOSE(0, "spread_infection_in_active_places day %d\n", day);
@@ -1131,6 +1235,10 @@ void Epidemic::print_stats(int day) {
   FRED_VERBOSE(1, "report place of infection\n");
   report_place_of_infection(day);
 
+  if(Global::Report_Transmission_Counters) {
+    report_transmission_counters(day);
+  }
+
   if(Global::Report_Age_Of_Infection) {
     report_age_of_infection(day);
   }
@@ -1340,6 +1448,25 @@ void Epidemic::report_age_of_infection(int day) {
 void Epidemic::report_by_county(int day) {
   char str[FRED_STRING_SIZE];
   int n = Global::Places.get_number_of_counties();
+  if(Global::Report_Geo_Incidence_Cube) {
+    setup_incidence_cubes();
+    int P = this->county_cube->get_metric_index("P");
+    int Ps = this->county_cube->get_metric_index("Ps");
+    int Pa = this->county_cube->get_metric_index("Pa");
+    int N = this->county_cube->get_metric_index("N");
+    int CF = this->county_cube->get_metric_index("CF");
+    for (int i = 0; i < n; i++) {
+      int fips = Global::Places.get_fips_of_county_with_index(i);
+      struct Condition_Count_Info* counts = &(this->county_infection_counts_map[fips]);
+      this->county_cube->set(day, i, P, counts->current_active);
+      this->county_cube->set(day, i, Ps, counts->current_symptomatic);
+      this->county_cube->set(day, i, Pa, counts->current_active - counts->current_symptomatic);
+      this->county_cube->set(day, i, N, Global::Places.get_population_of_county_with_index(i));
+      this->county_cube->set(day, i, CF, counts->current_case_fatalities);
+      counts->current_case_fatalities = 0;
+    }
+    return;
+  }
   for (int i = 0; i < n; i++) {
     int fips = Global::Places.get_fips_of_county_with_index(i);
     sprintf(str, "P:%d", fips);
@@ -1486,7 +1613,7 @@ void Epidemic::report_transmission_by_age_group_to_file(int day) {
 }
 
 void Epidemic::report_incidence_by_county(int day) {
-  if(day == 0) {
+  if(this->county_incidence == NULL) {
     // set up county counts
     this->counties = Global::Places.get_number_of_counties();
     this->county_incidence = new int[this->counties];
@@ -1513,6 +1640,17 @@ void Epidemic::report_incidence_by_county(int day) {
     // FRED_VERBOSE(0, "county %d incidence %d %d out of %d person %d \n", c, this->county_incidence[c], i, active, infectee->get_id());
   }
   FRED_VERBOSE(1, "county incidence day %d\n", day);
+  if(Global::Report_Geo_Incidence_Cube) {
+    setup_incidence_cubes();
+    int C = this->county_cube->get_metric_index("C");
+    int N = this->county_cube->get_metric_index("N");
+    for(int c = 0; c < this->counties; ++c) {
+      this->county_cube->set(day, c, C, this->county_incidence[c]);
+      this->county_cube->set(day, c, N, Global::Places.get_population_of_county_with_index(c));
+      this->county_incidence[c] = 0;
+    }
+    return;
+  }
   for(int c = 0; c < this->counties; ++c) {
     char name[80];
     sprintf(name, "County_%d", Global::Places.get_fips_of_county_with_index(c));
@@ -1527,7 +1665,7 @@ void Epidemic::report_incidence_by_county(int day) {
 
 
 void Epidemic::report_symptomatic_incidence_by_census_tract(int day) {
-  if(day == 0) {
+  if(this->census_tract_symp_incidence == NULL) {
     // set up census_tract counts
     this->census_tracts = Global::Places.get_number_of_census_tracts();
     this->census_tract_symp_incidence = new int[this->census_tracts];
@@ -1542,6 +1680,14 @@ void Epidemic::report_symptomatic_incidence_by_census_tract(int day) {
     assert(0 <= t && t < this->census_tracts);
     this->census_tract_symp_incidence[t]++;
   }
+  if(Global::Report_Geo_Incidence_Cube) {
+    setup_incidence_cubes();
+    int Cs = this->census_tract_cube->get_metric_index("Cs");
+    for(int t = 0; t < this->census_tracts; t++) {
+      this->census_tract_cube->set(day, t, Cs, this->census_tract_symp_incidence[t]);
+    }
+    return;
+  }
   for(int t = 0; t < this->census_tracts; t++) {
     char name[80];
     sprintf(name, "Tract_Cs_%ld", Global::Places.get_census_tract_with_index(t));
@@ -1560,7 +1706,7 @@ int Epidemic::get_symptomatic_incidence_by_tract_index(int index_) {
 }
 
 void Epidemic::report_incidence_by_census_tract(int day) {
-  if(day == 0) {
+  if(this->census_tract_incidence == NULL) {
     // set up census_tract counts
     this->census_tracts = Global::Places.get_number_of_census_tracts();
     this->census_tract_incidence = new int[this->census_tracts];
@@ -1580,6 +1726,15 @@ void Epidemic::report_incidence_by_census_tract(int day) {
     assert(0 <= t && t < this->census_tracts);
     this->census_tract_incidence[t]++;
   }
+  if(Global::Report_Geo_Incidence_Cube) {
+    setup_incidence_cubes();
+    int C = this->census_tract_cube->get_metric_index("C");
+    for(int t = 0; t < this->census_tracts; ++t) {
+      this->census_tract_cube->set(day, t, C, this->census_tract_incidence[t]);
+      this->census_tract_incidence[t] = 0;
+    }
+    return;
+  }
   for(int t = 0; t < this->census_tracts; ++t) {
     char name[80];
     sprintf(name, "Tract_%ld", Global::Places.get_census_tract_with_index(t));
@@ -1589,6 +1744,257 @@ void Epidemic::report_incidence_by_census_tract(int day) {
   }
 }
 
+void Epidemic::setup_incidence_cubes() {
+  if(this->county_cube != NULL || this->census_tract_cube != NULL) {
+    return;
+  }
+
+  // only the metrics of the reports that are turned on
+  vector<string> metrics;
+  if(Global::Report_Incidence_By_County) {
+    metrics.push_back("C");
+  }
+  if(Global::Report_Epidemic_Data_By_County) {
+    metrics.push_back("P");
+    metrics.push_back("Ps");
+    metrics.push_back("Pa");
+  }
+  if(Global::Report_Incidence_By_County || Global::Report_Epidemic_Data_By_County) {
+    metrics.push_back("N");
+  }
+  if(Global::Report_Epidemic_Data_By_County) {
+    metrics.push_back("CF");
+  }
+  if(metrics.empty() == false) {
+    vector<long int> fips;
+    int n = Global::Places.get_number_of_counties();
+    for(int i = 0; i < n; ++i) {
+      fips.push_back(Global::Places.get_fips_of_county_with_index(i));
+    }
+    this->county_cube = new Incidence_Cube(fips, metrics, Global::Days);
+  }
+
+  metrics.clear();
+  if(Global::Report_Incidence_By_Census_Tract) {
+    metrics.push_back("C");
+  }
+  if(Global::Report_Symptomatic_Incidence_By_Census_Tract) {
+    metrics.push_back("Cs");
+  }
+  if(metrics.empty() == false) {
+    vector<long int> fips;
+    int n = Global::Places.get_number_of_census_tracts();
+    for(int i = 0; i < n; ++i) {
+      fips.push_back(Global::Places.get_census_tract_with_index(i));
+    }
+    this->census_tract_cube = new Incidence_Cube(fips, metrics, Global::Days);
+  }
+}
+
+void Epidemic::end_of_run() {
+  char filename[FRED_STRING_SIZE];
+  if(this->county_cube != NULL) {
+    Utils::fred_snprintf(filename, sizeof(filename), "%s/RUN%d/county%s.csv", Global::Simulation_directory,
+	    Global::Simulation_run_number, this->output_var_suffix);
+    this->county_cube->write(filename, "county");
+  }
+  if(this->census_tract_cube != NULL) {
+    Utils::fred_snprintf(filename, sizeof(filename), "%s/RUN%d/census_tract%s.csv", Global::Simulation_directory,
+	    Global::Simulation_run_number, this->output_var_suffix);
+    this->census_tract_cube->write(filename, "census_tract");
+  }
+}
+
+unsigned long long Epidemic::get_state_digest(int day) {
+  unsigned long long digest = State_Digest::mix(0, this->N);
+  digest = State_Digest::mix(digest, this->total_cases);
+  digest = State_Digest::mix(digest, this->total_symptomatic_cases);
+  digest = State_Digest::mix(digest, this->total_case_fatality_count);
+  digest = State_Digest::mix(digest, this->current_susceptible_people);
+  digest = State_Digest::mix(digest, this->current_active_people);
+  digest = State_Digest::mix(digest, this->current_exposed_people);
+  digest = State_Digest::mix(digest, this->current_infectious_people);
+  digest = State_Digest::mix(digest, this->current_removed_people);
+  digest = State_Digest::mix(digest, this->current_symptomatic_people);
+  digest = State_Digest::mix(digest, this->current_immune_people);
+  for(int i = 0; i < this->number_of_states; ++i) {
+    digest = State_Digest::mix(digest, this->incidence_count[i]);
+    digest = State_Digest::mix(digest, this->cumulative_count[i]);
+    digest = State_Digest::mix(digest, this->prevalence_count[i]);
+  }
+
+  // the lists are ordered by id
+  digest = State_Digest::mix(digest, this->active_people_list.size());
+  for(person_set_iterator itr = this->active_people_list.begin(); itr != this->active_people_list.end(); ++itr) {
+    digest = State_Digest::mix(digest, (*itr)->get_id());
+  }
+  digest = State_Digest::mix(digest, this->infectious_people_list.size());
+  for(person_set_iterator itr = this->infectious_people_list.begin(); itr != this->infectious_people_list.end(); ++itr) {
+    digest = State_Digest::mix(digest, (*itr)->get_id());
+  }
+
+  // pending transitions; the order within a day does not matter
+  int last_day = (Global::Days < MAX_DAYS ? Global::Days : MAX_DAYS);
+  for(int d = day + 1; d < last_day; ++d) {
+    int size = this->state_transition_event_queue.get_size(d);
+    if(size == 0) {
+      continue;
+    }
+    unsigned long long members = 0;
+    for(int i = 0; i < size; ++i) {
+      members += State_Digest::member(this->state_transition_event_queue.get_event(d, i)->get_id());
+    }
+    digest = State_Digest::mix(digest, d);
+    digest = State_Digest::mix(digest, members);
+  }
+  return digest;
+}
+
+// person sets and count maps in checkpoints
+
+static void write_person_set(person_set_t &people) {
+  int size = people.size();
+  Checkpoint::put(size);
+  for(person_set_iterator itr = people.begin(); itr != people.end(); ++itr) {
+    Checkpoint::put_person(*itr);
+  }
+}
+
+static void read_person_set(person_set_t &people) {
+  people.clear();
+  int size = 0;
+  Checkpoint::get(size);
+  for(int i = 0; i < size; ++i) {
+    people.insert(people.end(), Checkpoint::get_person());
+  }
+}
+
+template <typename K>
+static void write_count_map(std::map<K, struct Condition_Count_Info> &counts) {
+  int size = counts.size();
+  Checkpoint::put(size);
+  for(typename std::map<K, struct Condition_Count_Info>::iterator itr = counts.begin(); itr != counts.end(); ++itr) {
+    Checkpoint::put(itr->first);
+    Checkpoint::put(itr->second);
+  }
+}
+
+template <typename K>
+static void read_count_map(std::map<K, struct Condition_Count_Info> &counts) {
+  counts.clear();
+  int size = 0;
+  Checkpoint::get(size);
+  for(int i = 0; i < size; ++i) {
+    K key;
+    Checkpoint::get(key);
+    Checkpoint::get(counts[key]);
+  }
+}
+
+void Epidemic::write_checkpoint(int day) {
+  Checkpoint::put(this->N);
+  Checkpoint::put(this->N_init);
+  write_person_set(this->active_people_list);
+  write_person_set(this->infectious_people_list);
+
+  Checkpoint::put(this->current_susceptible_people);
+  Checkpoint::put(this->current_active_people);
+  Checkpoint::put(this->current_exposed_people);
+  Checkpoint::put(this->current_infectious_people);
+  Checkpoint::put(this->current_removed_people);
+  Checkpoint::put(this->current_symptomatic_people);
+  Checkpoint::put(this->current_immune_people);
+  Checkpoint::put(this->total_cases);
+  Checkpoint::put(this->total_symptomatic_cases);
+  Checkpoint::put(this->total_severe_symptomatic_cases);
+  Checkpoint::put(this->total_case_fatality_count);
+
+  Checkpoint::put(this->number_of_states);
+  Checkpoint::put_array(this->cumulative_count, this->number_of_states);
+  Checkpoint::put_array(this->prevalence_count, this->number_of_states);
+
+  Checkpoint::put(this->population_infection_counts);
+  write_count_map(this->household_income_infection_counts_map);
+  write_count_map(this->census_tract_infection_counts_map);
+  write_count_map(this->county_infection_counts_map);
+  write_count_map(this->school_income_infection_counts_map);
+  write_count_map(this->workplace_size_infection_counts_map);
+
+  Checkpoint::put(this->RR);
+  Checkpoint::put_array(this->daily_cohort_size, day);
+  Checkpoint::put_array(this->number_infected_by_cohort, day);
+  Checkpoint::put(this->total_serial_interval);
+  Checkpoint::put(this->total_secondary_cases);
+
+  this->state_transition_event_queue.write_checkpoint(day);
+
+  for(int t = 0; t < Global::MAX_NUM_THREADS; ++t) {
+    Checkpoint::put_vector(this->transmission_counters[t]);
+  }
+}
+
+void Epidemic::read_checkpoint(int day) {
+  Checkpoint::get(this->N);
+  Checkpoint::get(this->N_init);
+  read_person_set(this->active_people_list);
+  read_person_set(this->infectious_people_list);
+
+  Checkpoint::get(this->current_susceptible_people);
+  Checkpoint::get(this->current_active_people);
+  Checkpoint::get(this->current_exposed_people);
+  Checkpoint::get(this->current_infectious_people);
+  Checkpoint::get(this->current_removed_people);
+  Checkpoint::get(this->current_symptomatic_people);
+  Checkpoint::get(this->current_immune_people);
+  Checkpoint::get(this->total_cases);
+  Checkpoint::get(this->total_symptomatic_cases);
+  Checkpoint::get(this->total_severe_symptomatic_cases);
+  Checkpoint::get(this->total_case_fatality_count);
+
+  // the daily counts start from zero
+  this->people_becoming_active_today = 0;
+  this->people_becoming_infectious_today = 0;
+  this->people_becoming_symptomatic_today = 0;
+  this->people_becoming_immune_today = 0;
+  this->people_becoming_case_fatality_today = 0;
+  this->daily_infections_list.clear();
+  this->daily_symptomatic_list.clear();
+
+  int states = 0;
+  Checkpoint::get(states);
+  Checkpoint::check("states", states, this->number_of_states);
+  for(int i = 0; i < this->number_of_states; ++i) {
+    this->incidence_count[i] = 0;
+  }
+  Checkpoint::get_array(this->cumulative_count, this->number_of_states);
+  Checkpoint::get_array(this->prevalence_count, this->number_of_states);
+
+  Checkpoint::get(this->population_infection_counts);
+  read_count_map(this->household_income_infection_counts_map);
+  read_count_map(this->census_tract_infection_counts_map);
+  read_count_map(this->county_infection_counts_map);
+  read_count_map(this->school_income_infection_counts_map);
+  read_count_map(this->workplace_size_infection_counts_map);
+
+  Checkpoint::get(this->RR);
+  Checkpoint::get_array(this->daily_cohort_size, day);
+  Checkpoint::get_array(this->number_infected_by_cohort, day);
+  Checkpoint::get(this->total_serial_interval);
+  Checkpoint::get(this->total_secondary_cases);
+
+  this->state_transition_event_queue.read_checkpoint();
+
+  for(int t = 0; t < Global::MAX_NUM_THREADS; ++t) {
+    Checkpoint::get_vector(this->transmission_counters[t]);
+    if(Global::Report_Transmission_Counters == false) {
+      this->transmission_counters[t].clear();
+    } else if(this->transmission_counters[t].size() != TC_CELLS + TC_PADDING) {
+      // the checkpoint was written without counters
+      this->transmission_counters[t].assign(TC_CELLS + TC_PADDING, 0);
+    }
+  }
+}
+
 void Epidemic::report_group_quarters_incidence(int day) {
   // group quarters incidence counts
   int G = 0;
@@ -1637,6 +2043,40 @@ void Epidemic::report_group_quarters_incidence(int day) {
   track_value(day, (char*) "newMIL", B);
 }
 
+void Epidemic::report_transmission_counters(int day) {
+  static const char* bucket_name[TC_SIZE_BUCKETS] = { "1_5", "6_25", "26_200", "201_up" };
+  static const char* counter_name[TC_COUNTERS] = {
+    "places", "infectors", "contacts", "draws", "attempts", "infections"
+  };
+
+  // sum over threads and reset for the next day
+  long long total[TC_CELLS];
+  for(int i = 0; i < TC_CELLS; ++i) {
+    total[i] = 0;
+  }
+  for(int t = 0; t < Global::MAX_NUM_THREADS; ++t) {
+    for(int i = 0; i < TC_CELLS; ++i) {
+      total[i] += this->transmission_counters[t][i];
+      this->transmission_counters[t][i] = 0;
+    }
+  }
+
+  char key[FRED_STRING_SIZE];
+  for(int type = 0; type < TC_PLACE_TYPES; ++type) {
+    for(int c = 0; c < TC_COUNTERS; ++c) {
+      long long type_total = 0;
+      for(int b = 0; b < TC_SIZE_BUCKETS; ++b) {
+	long long value = total[(type * TC_SIZE_BUCKETS + b) * TC_COUNTERS + c];
+	Utils::fred_snprintf(key, sizeof(key), "tc_%s_%s_%s", place_type_name[type], bucket_name[b], counter_name[c]);
+	track_value(day, key, (int) value);
+	type_total += value;
+      }
+      Utils::fred_snprintf(key, sizeof(key), "tc_%s_%s", place_type_name[type], counter_name[c]);
+      track_value(day, key, (int) type_total);
+    }
+  }
+}
+
 void Epidemic::report_place_of_infection(int day) {
 
   FILE* fp;
@@ -1716,11 +2156,7 @@ void Epidemic::report_distance_of_infection(int day) {
     } else {
       Place* new_place = dynamic_cast<Place*>(new_mixing_group);
       Place* old_place = dynamic_cast<Place*>(old_mixing_group);
-      fred::geo lat1 = new_place->get_latitude();
-      fred::geo lon1 = new_place->get_longitude();
-      fred::geo lat2 = old_place->get_latitude();
-      fred::geo lon2 = old_place->get_longitude();
-      double dist = Geo::xy_distance(lat1, lon1, lat2, lon2);
+      double dist = new_place->get_distance(old_place);
       tot_dist += dist;
       n++;
     }
@@ -2183,108 +2619,89 @@ void Epidemic::create_visualization_data_directories() {
 }
 
 
+// the location line used in the visualization files, formatted once per
+// household since the same households are written day after day
+static std::vector<std::string> household_location;
+
+static void append_household_location(std::string &data, Place* household) {
+  int index = household->get_index();
+  if(index >= static_cast<int>(household_location.size())) {
+    household_location.resize(Global::Places.get_number_of_households());
+  }
+  std::string &line = household_location[index];
+  if(line.empty()) {
+    char location[FRED_STRING_SIZE];
+    long int tract = Global::Places.get_census_tract_for_place(household);
+    snprintf(location, FRED_STRING_SIZE, "%f %f %ld\n", household->get_latitude(), household->get_longitude(), tract);
+    line = location;
+  }
+  data += line;
+}
+
+static void write_visualization_file(const char* filename, const std::string &data) {
+  FILE* fp = Async_Output::open(filename, "w");
+  if(fp == NULL) {
+    Utils::fred_abort("Can't open %s\n", filename);
+  }
+  Async_Output::write(fp, data);
+  Async_Output::close(fp);
+}
+
 void Epidemic::print_visualization_data_for_active_infections(int day) {
   char filename[FRED_STRING_SIZE];
-  FILE* fp;
-  Person* person;
-  Place* household;
-  long int tract;
-  double lat, lon;
-  char location[FRED_STRING_SIZE];
-  FILE* statefp[this->number_of_states];
-  FILE* newstatefp[this->number_of_states];
-
-  sprintf(filename, "%s/C%s/households-%d.txt", Global::Visualization_directory, this->output_var_suffix, day);
-  fp = fopen(filename, "w");
+  std::string data;
+
+  data.clear();
   for(person_set_iterator itr = this->new_active_people_list.begin(); itr != this->new_active_people_list.end(); ++itr) {
-    person = (*itr);
-    household = person->get_household();
-    tract = Global::Places.get_census_tract_for_place(household);
-    lat = household->get_latitude();
-    lon = household->get_longitude();
-    fprintf(fp, "%f %f %ld\n", lat, lon, tract);
+    append_household_location(data, (*itr)->get_household());
   }
-  fclose(fp);
+  Utils::fred_snprintf(filename, sizeof(filename), "%s/C%s/households-%d.txt", Global::Visualization_directory, this->output_var_suffix, day);
+  write_visualization_file(filename, data);
 
-  sprintf(filename, "%s/Cs%s/households-%d.txt", Global::Visualization_directory, this->output_var_suffix, day);
-  fp = fopen(filename, "w");
+  data.clear();
   for(person_set_iterator itr = this->new_symptomatic_people_list.begin(); itr != this->new_symptomatic_people_list.end(); ++itr) {
-    person = (*itr);
-    household = person->get_household();
-    tract = Global::Places.get_census_tract_for_place(household);
-    lat = household->get_latitude();
-    lon = household->get_longitude();
-    fprintf(fp, "%f %f %ld\n", lat, lon, tract);
+    append_household_location(data, (*itr)->get_household());
   }
-  fclose(fp);
+  Utils::fred_snprintf(filename, sizeof(filename), "%s/Cs%s/households-%d.txt", Global::Visualization_directory, this->output_var_suffix, day);
+  write_visualization_file(filename, data);
 
-  sprintf(filename, "%s/Ci%s/households-%d.txt", Global::Visualization_directory, this->output_var_suffix, day);
-  fp = fopen(filename, "w");
+  data.clear();
   for(person_set_iterator itr = this->new_infectious_people_list.begin(); itr != this->new_infectious_people_list.end(); ++itr) {
-    person = (*itr);
-    household = person->get_household();
-    tract = Global::Places.get_census_tract_for_place(household);
-    lat = household->get_latitude();
-    lon = household->get_longitude();
-    fprintf(fp, "%f %f %ld\n", lat, lon, tract);
+    append_household_location(data, (*itr)->get_household());
   }
-  fclose(fp);
+  Utils::fred_snprintf(filename, sizeof(filename), "%s/Ci%s/households-%d.txt", Global::Visualization_directory, this->output_var_suffix, day);
+  write_visualization_file(filename, data);
 
-  sprintf(filename, "%s/R%s/households-%d.txt", Global::Visualization_directory, this->output_var_suffix, day);
-  fp = fopen(filename, "w");
+  data.clear();
   for(person_set_iterator itr = this->recovered_people_list.begin(); itr != this->recovered_people_list.end(); ++itr) {
-    person = (*itr);
-    household = person->get_household();
-    tract = Global::Places.get_census_tract_for_place(household);
-    lat = household->get_latitude();
-    lon = household->get_longitude();
-    fprintf(fp, "%f %f %ld\n", lat, lon, tract);
+    append_household_location(data, (*itr)->get_household());
   }
-  fclose(fp);
+  Utils::fred_snprintf(filename, sizeof(filename), "%s/R%s/households-%d.txt", Global::Visualization_directory, this->output_var_suffix, day);
+  write_visualization_file(filename, data);
 
-  // make sure visualization file for CF exists
-  sprintf(filename, "%s/CF%s/households-%d.txt", Global::Visualization_directory, this->output_var_suffix, day);
-  fp = fopen(filename, "r");
-  if (fp == NULL) {
-    // create an empty file
-    fp = fopen(filename, "w");
+  // case fatalities of the last 30 days
+  while(this->case_fatality_locations.empty() == false &&
+	this->case_fatality_locations.front().first <= day - 30) {
+    this->case_fatality_locations.pop_front();
   }
-  fclose(fp);
-
-  // open file pointers for all epidemic stats
-  sprintf(filename, "%s/I%s/households-%d.txt", Global::Visualization_directory, this->output_var_suffix, day);
-  FILE* I_fp = fopen(filename, "w");
-  sprintf(filename, "%s/Ia%s/households-%d.txt", Global::Visualization_directory, this->output_var_suffix, day);
-  FILE* Ia_fp = fopen(filename, "w");
-  sprintf(filename, "%s/Is%s/households-%d.txt", Global::Visualization_directory, this->output_var_suffix, day);
-  FILE* Is_fp = fopen(filename, "w");
-  sprintf(filename, "%s/P%s/households-%d.txt", Global::Visualization_directory, this->output_var_suffix, day);
-  FILE* P_fp = fopen(filename, "w");
-  sprintf(filename, "%s/Pa%s/households-%d.txt", Global::Visualization_directory, this->output_var_suffix, day);
-  FILE* Pa_fp = fopen(filename, "w");
-  sprintf(filename, "%s/Ps%s/households-%d.txt", Global::Visualization_directory, this->output_var_suffix, day);
-  FILE* Ps_fp = fopen(filename, "w");
-
-  // open file pointers for each state
-  for (int i = 0; i < this->number_of_states; i++) {
-    if (this->visualize_state[i]) {
-      sprintf(filename, "%s/%s.%s/households-%d.txt",
-	      Global::Visualization_directory,
-	      this->name,
-	      this->natural_history->get_state_name(i).c_str(),
-	      day);
-      statefp[i] = fopen(filename, "w");
-      sprintf(filename, "%s/%s.new%s/households-%d.txt",
-	      Global::Visualization_directory,
-	      this->name,
-	      this->natural_history->get_state_name(i).c_str(),
-	      day);
-      newstatefp[i] = fopen(filename, "w");
+  data.clear();
+  for(int i = 0; i < (int) this->case_fatality_locations.size(); ++i) {
+    if(this->case_fatality_locations[i].first <= day) {
+      data += this->case_fatality_locations[i].second;
     }
   }
+  Utils::fred_snprintf(filename, sizeof(filename), "%s/CF%s/households-%d.txt", Global::Visualization_directory, this->output_var_suffix, day);
+  write_visualization_file(filename, data);
 
+  // collect the location of each active person for every file it belongs to
+  enum { I_DATA, IA_DATA, IS_DATA, P_DATA, PA_DATA, PS_DATA, EPIDEMIC_DATA };
+  static const char* epidemic_data_dir[EPIDEMIC_DATA] = { "I", "Ia", "Is", "P", "Pa", "Ps" };
+  std::string epidemic_data[EPIDEMIC_DATA];
+  std::vector<std::string> state_data(this->number_of_states);
+  std::vector<std::string> new_state_data(this->number_of_states);
+  std::string location;
   for(person_set_iterator itr = this->active_people_list.begin(); itr != this->active_people_list.end(); ++itr) {
-    person = (*itr);
+    Person* person = (*itr);
     int state = person->get_health_state(this->id);
     if (state < 0) {
       Utils::fred_abort("Help: person %d age %d state %d (should be at least 0)\n",
@@ -2292,76 +2709,65 @@ void Epidemic::print_visualization_data_for_active_infections(int day) {
 			person->get_age(),
 			state);
     }
-    household = person->get_household();
-
-    tract = Global::Places.get_census_tract_for_place(household);
-    lat = household->get_latitude();
-    lon = household->get_longitude();
-    sprintf(location,  "%f %f %ld\n", lat, lon, tract);
+    location.clear();
+    append_household_location(location, person->get_household());
     if (this->visualize_state[state]) {
-      fputs(location, statefp[state]);
+      state_data[state] += location;
       if (day == person->get_last_health_transition_day(this->id)) {
-	fputs(location, newstatefp[state]);
+	new_state_data[state] += location;
       }
     }
 
     if (person->is_infected(this->id)) {
       // person is currently active
-      fputs(location, P_fp);
+      epidemic_data[P_DATA] += location;
 
       if (person->is_symptomatic(this->id)) {
 	// current symptomatic
-	fputs(location, Ps_fp);
+	epidemic_data[PS_DATA] += location;
       }
       else {
 	// current asymptomatic
-	fputs(location, Pa_fp);
+	epidemic_data[PA_DATA] += location;
       }
       
       if (person->is_infectious(this->id)==day) {
 	// infectious
-	fputs(location, I_fp);
+	epidemic_data[I_DATA] += location;
 
 	if (person->is_symptomatic(this->id)) {
 	  // infectious and symptomatic
-	  fputs(location, Is_fp);
+	  epidemic_data[IS_DATA] += location;
 	}
 	else {
 	  // infectious and asymptomatic
-	  fputs(location, Ia_fp);
+	  epidemic_data[IA_DATA] += location;
 	}
       }
     }
   }
-  fclose(I_fp);
-  fclose(Ia_fp);
-  fclose(Is_fp);
-  fclose(P_fp);
-  fclose(Pa_fp);
-  fclose(Ps_fp);
 
-  // print locations of households associated with each state
-  /*
-    int popsize = Global::Pop.get_population_size();
-    for(int p = 0; p < popsize; ++p) {
-    Person* person = Global::Pop.get_person(p);
-    int state = person->get_health_state(this->id);
-    if (state >= 0) {
-    household = person->get_household();
-    tract = Global::Places.get_census_tract_for_place(household);
-    lat = household->get_latitude();
-    lon = household->get_longitude();
-    sprintf(location,  "%f %f %ld\n", lat, lon, tract);
-    fputs(location, statefp[state]);
-    }
-    }
-  */
+  for(int i = 0; i < EPIDEMIC_DATA; ++i) {
+    Utils::fred_snprintf(filename, sizeof(filename), "%s/%s%s/households-%d.txt", Global::Visualization_directory,
+	    epidemic_data_dir[i], this->output_var_suffix, day);
+    write_visualization_file(filename, epidemic_data[i]);
+  }
 
-  // close file pointers for each state
+  // households associated with each state
   for (int i = 0; i < this->number_of_states; i++) {
     if (this->visualize_state[i]) {
-      fclose(statefp[i]);
-      fclose(newstatefp[i]);
+      Utils::fred_snprintf(filename, sizeof(filename), "%s/%s.%s/households-%d.txt",
+	      Global::Visualization_directory,
+	      this->name,
+	      this->natural_history->get_state_name(i).c_str(),
+	      day);
+      write_visualization_file(filename, state_data[i]);
+      Utils::fred_snprintf(filename, sizeof(filename), "%s/%s.new%s/households-%d.txt",
+	      Global::Visualization_directory,
+	      this->name,
+	      this->natural_history->get_state_name(i).c_str(),
+	      day);
+      write_visualization_file(filename, new_state_data[i]);
     }
   }
 
@@ -2369,14 +2775,9 @@ void Epidemic::print_visualization_data_for_active_infections(int day) {
 
 
 void Epidemic::print_visualization_data_for_case_fatality(int day, Person* person) {
-  Place* household = person->get_household();
-  char filename[FRED_STRING_SIZE];
-  for(int d = day; d < day + 30; ++d) {
-    sprintf(filename, "%s/CF%s/households-%d.txt", Global::Visualization_directory, this->output_var_suffix, d);
-    FILE* fp = fopen(filename, "a");
-    fprintf(fp, "%f %f %ld\n", household->get_latitude(), household->get_longitude(), Global::Places.get_census_tract_for_place(household));
-    fclose(fp);
-  }
+  std::string location;
+  append_household_location(location, person->get_household());
+  this->case_fatality_locations.push_back(std::make_pair(day, location));
 }
 
 
@@ -2506,7 +2907,7 @@ void Epidemic::update_state_of_person(Person* person, int day, int new_state) {
 
     // update person health record
     if (this->enable_health_records && Global::Enable_Health_Records) {
-      fprintf(Global::HealthRecordfp,
+      Async_Output::print(Global::HealthRecordfp,
 	      "HEALTH RECORD: %s day %d person %d age %.1f sex %c race %d CONDITION %s CHANGES from %s to %s\n",
 	      Date::get_date_string().c_str(), day,
 	      person->get_id(), age,
@@ -2525,7 +2926,7 @@ void Epidemic::update_state_of_person(Person* person, int day, int new_state) {
       int mod_state = this->natural_history->get_state_modifier(new_state,i,istate);
       if (mod_state != istate) {
 	if (0 && Global::Enable_Health_Records) {
-	  fprintf(Global::HealthRecordfp,
+	  Async_Output::print(Global::HealthRecordfp,
 		  "HEALTH RECORD: %s day %d person %d ENTERING CONDITION %s state %s MODIFIES COND %d STATE %d to state %d\n",
 		  Date::get_date_string().c_str(), day,
 		  person->get_id(),
@@ -21,8 +21,10 @@
 #ifndef _FRED_EPIDEMIC_H
 #define _FRED_EPIDEMIC_H
 
+#include <deque>
 #include <set>
 #include <map>
+#include <string>
 #include <vector>
 using namespace std;
 
@@ -36,6 +38,7 @@ using namespace std;
 #define SEED_INFECTIOUS 'I'
 
 class Condition;
+class Incidence_Cube;
 class Natural_History;
 
 struct person_id_compare {
@@ -173,6 +176,7 @@ public:
   void report_household_income_stratified_results(int day);
   void report_census_tract_stratified_results(int day);
   void report_group_quarters_incidence(int day);
+  void report_transmission_counters(int day);
   virtual void report_condition_specific_stats(int day) {}
   void read_time_step_map();
   void track_value(int day, char* key, int value);
@@ -190,11 +194,26 @@ public:
   void recover(Person* person, int day);
 
   virtual void update(int day);
+
   void update_state_of_person(Person* person, int day, int new_state = -1);
 
   void find_active_places_of_type(int day, int place_type);
   void spread_infection_in_active_places(int day);
 
+  /**
+   * Add the work done by a transmission model in one place to the
+   * calling thread's transmission counters (if report_transmission_counters
+   * is set). The counters are broken down by place type and size.
+   *
+   * @param place the place where transmission was attempted
+   * @param infectors the number of infectious people processed
+   * @param contacts the number of contacts sampled
+   * @param draws the number of random numbers drawn
+   * @param attempts the number of calls to attempt_transmission
+   * @param infections the number of successful transmissions
+   */
+  void count_transmission_work(Place* place, int infectors, int contacts, int draws, int attempts, int infections);
+
   int get_susceptible_people() {
     return this->current_susceptible_people;
   }
@@ -271,9 +290,23 @@ public:
 
   void delete_from_active_people_list(Person* person);
 
-  virtual void end_of_run() {}
+  virtual void end_of_run();
   virtual void terminate_person(Person* person, int day);
 
+  /**
+   * Digest of the counters, the active and infectious lists and the
+   * pending transitions at the end of the given day.
+   * @see State_Digest
+   */
+  unsigned long long get_state_digest(int day);
+
+  /**
+   * Save or restore the lists, counters and pending transitions at the
+   * start of the given day (see Checkpoint).
+   */
+  void write_checkpoint(int day);
+  void read_checkpoint(int day);
+
 protected:
   Condition* condition;
   char name[FRED_STRING_SIZE];
@@ -305,6 +338,10 @@ protected:
   person_set_t new_infectious_people_list;
   person_set_t recovered_people_list;
 
+  // household locations of recent case fatalities by day of death; each
+  // appears in the CF visualization file of that day and the next 29
+  std::deque< std::pair<int, std::string> > case_fatality_locations;
+
   // imported cases
   std::vector<Import_Map*> import_map;
 
@@ -368,6 +405,12 @@ protected:
   int* census_tract_incidence;
   int* census_tract_symp_incidence;
 
+  // daily county and census tract reports when report_geo_incidence_cube
+  // is set, in place of one tracked value per region and metric
+  Incidence_Cube* county_cube;
+  Incidence_Cube* census_tract_cube;
+  void setup_incidence_cubes();
+
   // link to natural hisotory
   Natural_History* natural_history;
 
@@ -381,6 +424,18 @@ protected:
   // report detailed changes in health records for this epidemic
   bool enable_health_records;
 
+  // transmission work counters, one block per thread (padded by a
+  // cache line) indexed by place type, size bucket and counter
+  enum {
+    TC_PLACES, TC_INFECTORS, TC_CONTACTS, TC_DRAWS, TC_ATTEMPTS, TC_INFECTIONS, TC_COUNTERS
+  };
+  static const int TC_PLACE_TYPES = 7;
+  static const int TC_SIZE_BUCKETS = 4;
+  static const int TC_CELLS = TC_PLACE_TYPES * TC_SIZE_BUCKETS * TC_COUNTERS;
+  static const int TC_PADDING = 8;
+  std::vector<long long> transmission_counters[Global::MAX_NUM_THREADS];
+  static int get_transmission_counter_index(Place* place, int counter);
+
 };
 
 #endif // _FRED_EPIDEMIC_H
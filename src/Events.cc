@@ -17,6 +17,7 @@
 // File: Events.cc
 //
 
+#include "Checkpoint.h"
 #include "Events.h"
 #include "Utils.h"
 
@@ -106,3 +107,43 @@ void Events::print_events(int day) {
   print_events(stdout, day);
 }
 
+void Events::write_checkpoint(int day) {
+  int days = 0;
+  for(int d = day; d < MAX_DAYS; ++d) {
+    if(this->events[d].empty() == false) {
+      ++days;
+    }
+  }
+  Checkpoint::put(days);
+  for(int d = day; d < MAX_DAYS; ++d) {
+    int size = this->events[d].size();
+    if(size > 0) {
+      Checkpoint::put(d);
+      Checkpoint::put(size);
+      for(int i = 0; i < size; ++i) {
+	Checkpoint::put_person(this->events[d][i]);
+      }
+    }
+  }
+}
+
+void Events::read_checkpoint() {
+  for(int d = 0; d < MAX_DAYS; ++d) {
+    clear_events(d);
+  }
+  int days = 0;
+  Checkpoint::get(days);
+  for(int n = 0; n < days; ++n) {
+    int d = 0;
+    int size = 0;
+    Checkpoint::get(d);
+    Checkpoint::get(size);
+    if(d < 0 || MAX_DAYS <= d) {
+      Utils::fred_abort("Events: bad day %d in checkpoint\n", d);
+    }
+    this->events[d].resize(size);
+    for(int i = 0; i < size; ++i) {
+      this->events[d][i] = Checkpoint::get_person();
+    }
+  }
+}
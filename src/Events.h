@@ -50,6 +50,13 @@ public:
   void print_events(FILE* fp, int day);
   void print_events(int day);
 
+  /**
+   * Save the events of the given day and later, or replace all events
+   * by the saved events (see Checkpoint).
+   */
+  void write_checkpoint(int day);
+  void read_checkpoint();
+
 private:
   events_t events[MAX_DAYS];
 };
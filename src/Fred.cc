@@ -17,6 +17,8 @@
 // File: Fred.cc
 //
 #include "Activities.h"
+#include "Async_Output.h"
+#include "Checkpoint.h"
 #include "Date.h"
 #include "Demographics.h"
 #include "Condition.h"
@@ -25,15 +27,20 @@
 #include "Fred.h"
 #include "Global.h"
 #include "Health.h"
+#include "Infection_Log.h"
 #include "Logit.h"
 #include "Neighborhood_Layer.h"
 #include "Network.h"
 #include "Params.h"
 #include "Place_List.h"
 #include "Population.h"
+#include "Profiler.h"
+#include "Partition.h"
+#include "State_Digest.h"
 #include "Random.h"
 #include "Regional_Layer.h"
 #include "Seasonality.h"
+#include "Setup_Scheduler.h"
 #include "Sexual_Transmission_Network.h"
 #include "Tracker.h"
 #include "Transmission.h"
@@ -50,13 +57,52 @@ class Place;
 #include <csignal>
 #include <cstdlib>
 #include <cxxabi.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 
 //FRED main program
 
 int main(int argc, char* argv[]) {
+  high_resolution_clock::time_point setup_start_time = high_resolution_clock::now();
   fred_setup(argc, argv);
-  for(Global::Simulation_Day = 0; Global::Simulation_Day < Global::Days; Global::Simulation_Day++) {
+  Checkpoint::check_configuration();
+
+  // optional batch mode: runs run_number through last_run, sharing this setup
+  //   FRED paramfile run_number directory --batch last_run [max_workers]
+  // (other arguments after the directory are left to the sexual partner
+  // network's calibration)
+  if(argc > 4 && strcmp(argv[4], "--batch") == 0) {
+    if(argc < 6 || argc > 7) {
+      Utils::fred_abort("usage: FRED paramfile run_number directory --batch last_run [max_workers]\n");
+    }
+    if(Checkpoint::get_checkpoint_day() >= 0 || Checkpoint::is_restoring()) {
+      Utils::fred_abort("checkpoints can't be used in batch mode\n");
+    }
+    if(Global::Enable_Visualization_Layer) {
+      // the visualization directories and data belong to the setup run
+      Utils::fred_abort("enable_visualization_layer can't be used in batch mode\n");
+    }
+    int last_run = Global::Simulation_run_number;
+    sscanf(argv[5], "%d", &last_run);
+    int max_workers = 1;
+    if(argc > 6) {
+      sscanf(argv[6], "%d", &max_workers);
+    }
+    double setup_time = 0.000001 * std::chrono::duration_cast<std::chrono::microseconds>(high_resolution_clock::now() - setup_start_time).count();
+    return fred_run_batch(Global::Simulation_run_number, last_run, max_workers, setup_time);
+  }
+
+  // optional: continue from a checkpoint
+  int first_day = 0;
+  if(Checkpoint::is_restoring()) {
+    first_day = Checkpoint::restore();
+  }
+
+  for(Global::Simulation_Day = first_day; Global::Simulation_Day < Global::Days; Global::Simulation_Day++) {
+    if(Global::Simulation_Day == Checkpoint::get_checkpoint_day()) {
+      Checkpoint::write(Global::Simulation_Day);
+    }
     fred_step(Global::Simulation_Day);
   }
   fred_finish();
@@ -64,6 +110,216 @@ int main(int argc, char* argv[]) {
 }
 
 
+// Batch mode: the synthetic population, places and conditions are set
+// up once, then each replicate is run in a forked copy (copy-on-write)
+// of the initialized process with its own seed and output directory.
+//
+// Without reseed_day, all replicates share the random choices made
+// during setup (e.g. classroom and office assignments), so results
+// differ from those of separate FRED processes with the same run
+// numbers.  With reseed_day = N, the days before N follow the same
+// trajectory in every run anyway, so they are simulated once and the
+// replicates branch from the state at the start of day N.  Each
+// replicate is then identical to a separate run with that run number.
+
+int fred_run_batch(int first_run, int last_run, int max_workers, double setup_time) {
+  if(max_workers < 1) {
+    max_workers = 1;
+  }
+  if(last_run < first_run) {
+    last_run = first_run;
+  }
+  if(fred::omp_get_max_threads() > 1) {
+    FRED_WARNING("batch mode forks the initialized process; set OMP_NUM_THREADS=1 to avoid OpenMP runtime problems in the replicates\n");
+  }
+
+  // run the shared days, if any
+  high_resolution_clock::time_point shared_start_time = high_resolution_clock::now();
+  int branch_day = 0;
+  if(Global::Reseed_day > 0) {
+    branch_day = (Global::Reseed_day < Global::Days ? Global::Reseed_day : Global::Days);
+  }
+  for(Global::Simulation_Day = 0; Global::Simulation_Day < branch_day; Global::Simulation_Day++) {
+    fred_step(Global::Simulation_Day);
+  }
+  double shared_time = 0.000001 * std::chrono::duration_cast<std::chrono::microseconds>(high_resolution_clock::now() - shared_start_time).count();
+
+  // nothing buffered at fork time may be written twice, and the
+  // output writer thread would not survive the fork
+  Utils::fred_mark_output_files();
+  Async_Output::stop();
+  fflush(NULL);
+
+  fprintf(Global::Statusfp, "FRED batch: runs %d to %d branching on day %d with up to %d workers\n",
+	  first_run, last_run, branch_day, max_workers);
+  fflush(Global::Statusfp);
+
+  high_resolution_clock::time_point batch_start_time = high_resolution_clock::now();
+  std::map<pid_t, int> worker_run;
+  std::map<pid_t, high_resolution_clock::time_point> worker_start_time;
+  double total_run_time = 0.0;
+  int failures = 0;
+  int next_run = first_run;
+  while(next_run <= last_run || !worker_run.empty()) {
+    while(next_run <= last_run && static_cast<int>(worker_run.size()) < max_workers) {
+      pid_t pid = fork();
+      if(pid < 0) {
+        Utils::fred_abort("FRED batch: fork failed for run %d\n", next_run);
+      }
+      if(pid == 0) {
+        fred_run_replicate(next_run, first_run, branch_day);
+        fflush(NULL);
+        _exit(0);
+      }
+      worker_run[pid] = next_run;
+      worker_start_time[pid] = high_resolution_clock::now();
+      ++next_run;
+    }
+
+    int status = 0;
+    pid_t pid = waitpid(-1, &status, 0);
+    if(pid < 0) {
+      Utils::fred_abort("FRED batch: waitpid failed\n");
+    }
+    if(worker_run.find(pid) == worker_run.end()) {
+      continue;
+    }
+    double run_time = 0.000001 * std::chrono::duration_cast<std::chrono::microseconds>(high_resolution_clock::now() - worker_start_time[pid]).count();
+    total_run_time += run_time;
+    if(WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+      fprintf(Global::Statusfp, "FRED batch: run %d finished in %f seconds\n", worker_run[pid], run_time);
+    } else {
+      fprintf(Global::Statusfp, "FRED batch: run %d FAILED after %f seconds\n", worker_run[pid], run_time);
+      ++failures;
+    }
+    fflush(Global::Statusfp);
+    worker_run.erase(pid);
+    worker_start_time.erase(pid);
+  }
+
+  int runs = last_run - first_run + 1;
+  double batch_time = 0.000001 * std::chrono::duration_cast<std::chrono::microseconds>(high_resolution_clock::now() - batch_start_time).count();
+  fprintf(Global::Statusfp, "FRED batch: %d runs (%d failed) took %f seconds after %f seconds of setup and %f seconds for %d shared days\n",
+	  runs, failures, batch_time, setup_time, shared_time, branch_day);
+  fprintf(Global::Statusfp, "FRED batch: total %f seconds vs. about %f seconds for %d separate processes\n",
+	  setup_time + shared_time + batch_time, runs * (setup_time + shared_time) + total_run_time, runs);
+  fflush(Global::Statusfp);
+  return (failures > 0 ? 1 : 0);
+}
+
+
+void fred_run_replicate(int run, int setup_run, int branch_day) {
+  Global::Simulation_run_number = run;
+
+  // the setup run keeps the files opened by fred_setup
+  if(run != setup_run) {
+    Utils::fred_reopen_output_files(setup_run);
+  }
+
+  char logfile[FRED_STRING_SIZE];
+  Utils::fred_snprintf(logfile, sizeof(logfile), "%s/RUN%d/LOG", Global::Simulation_directory, run);
+  if(freopen(logfile, "w", stdout) == NULL) {
+    Utils::fred_abort("Can't open %s\n", logfile);
+  }
+  Global::Statusfp = stdout;
+
+  // set random number seed based on run number; with a reseed_day,
+  // fred_step reseeds the run on that day
+  if(Global::Simulation_run_number > 1 && Global::Reseed_day == -1) {
+    Global::Simulation_seed = Global::Seed * 100 + (Global::Simulation_run_number - 1);
+  } else {
+    Global::Simulation_seed = Global::Seed;
+  }
+  fprintf(Global::Statusfp, "FRED batch run %d seed = %lu branch day = %d\n", run, Global::Simulation_seed, branch_day);
+  if(Global::Reseed_day == -1) {
+    Random::set_seed(Global::Simulation_seed);
+  }
+
+  Utils::fred_print_wall_time("\nFRED run %d started", Global::Simulation_run_number);
+  Utils::fred_start_timer(&Global::Simulation_start_time);
+  for(Global::Simulation_Day = branch_day; Global::Simulation_Day < Global::Days; Global::Simulation_Day++) {
+    fred_step(Global::Simulation_Day);
+  }
+  fred_finish();
+}
+
+
+// the setup phases from setting up the group quarters to reassigning
+// workers, run by a Setup_Scheduler. Their dependencies:
+//
+// - the households are set up (and sorted) after the group quarters,
+//   and the county setup (which may move students to in-state schools)
+//   follows them
+// - the classrooms and then the offices are created, one phase after the
+//   other, so that they get the same ids in every run. They are the only
+//   phases that create places (and draw place ids), so no phase runs
+//   alongside them.
+// - once all the places exist, four phases run together. Each writes
+//   only state of its own:
+//   - assigning classrooms writes the students' classroom links and the
+//     classrooms and schools
+//   - assigning offices writes the workers' office links and the offices
+//     and workplaces
+//   - the census tract setup writes each tract's own lists, and reads
+//     only the households and the school and workplace links
+//   - the assignment of hospitals to households writes the households'
+//     hospitals and the household-hospital map. It reads the households
+//     and hospitals, and draws from per-household entity streams.
+// - the places are prepared after all enrollments, and the workers are
+//   reassigned once the places are prepared
+
+static void setup_group_quarters() {
+  Global::Places.setup_group_quarters();
+}
+
+static void setup_households() {
+  Global::Places.setup_households();
+}
+
+static void setup_counties() {
+  // setup county lists of schools and workplaces.
+  // this may optionally re-assigned students to in-state schools
+  Global::Places.setup_counties();
+}
+
+static void setup_classrooms() {
+  Global::Places.setup_classrooms();
+}
+
+static void assign_classrooms() {
+  Global::Pop.assign_classrooms();
+}
+
+static void setup_offices() {
+  Global::Places.setup_offices();
+}
+
+static void assign_offices() {
+  Global::Pop.assign_offices();
+}
+
+static void setup_census_tracts() {
+  // setup census_tract lists of schools and workplaces.
+  Global::Places.setup_census_tracts();
+}
+
+static void assign_hospitals() {
+  Global::Places.assign_hospitals_to_households();
+}
+
+static void prepare_places() {
+  // after all enrollments, prepare to receive visitors
+  Global::Places.prepare();
+  FRED_STATUS(0, "deleting place_label_map\n", "");
+  Global::Places.delete_place_label_map();
+  FRED_STATUS(0, "prepare places finished\n", "");
+}
+
+static void reassign_workers() {
+  // reassign workers (to schools, hospitals, groups quarters, etc)
+  Global::Places.reassign_workers();
+}
+
 void fred_setup(int argc, char* argv[]) {
   char paramfile[FRED_STRING_SIZE];
 
@@ -99,6 +355,12 @@ void fred_setup(int argc, char* argv[]) {
   // get runtime parameters
   Params::read_parameters(paramfile);
   Global::get_global_parameters();
+  Profiler::get_parameters();
+  Async_Output::get_parameters();
+  Infection_Log::get_parameters();
+  State_Digest::get_parameters();
+  Partition::get_parameters();
+  Checkpoint::get_parameters();
   Date::setup_dates(Global::Start_date);
 
   // create conditions and read parameters
@@ -180,47 +442,32 @@ void fred_setup(int argc, char* argv[]) {
   Global::Pop.setup();
   Utils::fred_print_wall_time("FRED Pop.setup finished");
   Utils::fred_print_lap_time("Pop.setup");
-  Global::Places.setup_group_quarters();
-  Utils::fred_print_lap_time("Places.setup_group_quarters");
-  Global::Places.setup_households();
-  Utils::fred_print_lap_time("Places.setup_households");
-
-  // setup county lists of schools and workplaces.
-  // this may optionally re-assigned students to in-state schools
-  Global::Places.setup_counties();
-
-  // define FRED-specific places and have each person enroll as needed
-
-  // classrooms
-  Global::Places.setup_classrooms();
-  Global::Pop.assign_classrooms();
-  Utils::fred_print_lap_time("assign classrooms");
-
-  // offices
-  Global::Places.setup_offices();
-  Utils::fred_print_lap_time("setup_offices");
-  Global::Pop.assign_offices();
-  Utils::fred_print_lap_time("assign offices");
 
+  // in a partitioned run, find the partitions that hold the remote
+  // workplaces and schools (needs the place labels)
+  if(Partition::is_enabled()) {
+    Partition::setup();
+    Utils::fred_print_lap_time("Partition.setup");
+  }
+  // set up the places and enroll people in the FRED-specific places
+  // (see the setup phases above)
+  Setup_Scheduler setup;
+  int group_quarters = setup.add_phase("Places.setup_group_quarters", setup_group_quarters);
+  int households = setup.add_phase("Places.setup_households", setup_households, {group_quarters});
+  int counties = setup.add_phase("setup_counties", setup_counties, {households});
+  int classrooms = setup.add_phase("setup_classrooms", setup_classrooms, {counties});
+  int offices = setup.add_phase("setup_offices", setup_offices, {classrooms});
+  int students = setup.add_phase("assign classrooms", assign_classrooms, {offices});
+  int workers = setup.add_phase("assign offices", assign_offices, {offices});
+  int census_tracts = setup.add_phase("setup_census_tracts", setup_census_tracts, {offices});
+  std::vector<int> enrollments = {students, workers, census_tracts};
   if(Global::Enable_Hospitals) {
-    Global::Places.assign_hospitals_to_households();
-    Utils::fred_print_lap_time("assign hospitals to households");
+    enrollments.push_back(setup.add_phase("assign hospitals to households", assign_hospitals, {offices}));
   }
-
-  // setup census_tract lists of schools and workplaces.
-  Global::Places.setup_census_tracts();
-
-  // after all enrollments, prepare to receive visitors
-  Global::Places.prepare();
-  Utils::fred_print_lap_time("place preparation");
-
-  FRED_STATUS(0, "deleting place_label_map\n", "");
-  Global::Places.delete_place_label_map();
-  FRED_STATUS(0, "prepare places finished\n", "");
-  
-  // reassign workers (to schools, hospitals, groups quarters, etc)
-  Global::Places.reassign_workers();
-  Utils::fred_print_lap_time("reassign workers");
+  int places = setup.add_phase("place preparation", prepare_places, enrollments);
+  setup.add_phase("reassign workers", reassign_workers, {places});
+  setup.run();
+  Utils::fred_print_lap_time("setup phases");
 
   if(Global::Enable_Vector_Layer) {
     Global::Vectors->setup();
@@ -350,6 +597,7 @@ void fred_setup(int argc, char* argv[]) {
 void fred_step(int day) {
 
   Utils::fred_start_day_timer();
+  Profiler_Zone day_zone("day");
 
   // optional: reseed the random number generator to create alternative
   // simulation from a given initial point
@@ -372,19 +620,31 @@ void fred_step(int day) {
   */
 
   // reset lists of infectious, susceptibles; update vector population, if any
-  Global::Places.update(day);
+  {
+    Profiler_Zone zone("update places");
+    Global::Places.update(day);
+  }
   Utils::fred_print_lap_time("day %d update places", day);
 
   // update population demographics
-  Global::Pop.update_demographics(day);
+  {
+    Profiler_Zone zone("update demographics");
+    Global::Pop.update_demographics(day);
+  }
   Utils::fred_print_lap_time("day %d update demographics", day);
 
   // update population mobility and stage-of-life activities
-  Global::Places.update_population_dynamics(day);
+  {
+    Profiler_Zone zone("update population dynamics");
+    Global::Places.update_population_dynamics(day);
+  }
   Utils::fred_print_lap_time("day %d update population dynamics", day);
 
   // remove dead from population
-  Global::Pop.remove_dead_from_population(day);
+  {
+    Profiler_Zone zone("remove dead");
+    Global::Pop.remove_dead_from_population(day);
+  }
   Utils::fred_print_lap_time("day %d remove dead from population", day);
 
   // remove migrants from population
@@ -392,18 +652,26 @@ void fred_step(int day) {
 
   // update vector populations
   if(Global::Enable_Vector_Layer) {
+    Profiler_Zone zone("update vectors");
     Global::Vectors->update(day);
   }
 
   // update travel decisions
-  Travel::update_travel(day);
+  {
+    Profiler_Zone zone("update travel");
+    Travel::update_travel(day);
+  }
 
   // update generic activities (individual activities updated only if
   // needed -- see below)
-  Activities::update(day);
+  {
+    Profiler_Zone zone("update activities");
+    Activities::update(day);
+  }
 
   if(Global::Enable_Sexual_Partner_Network) {
     //mina  update network every day **********************
+    Profiler_Zone zone("update sexual partner network");
     Global::Sexual_Partner_Network->update(day);
     //mina  END **********************
   }
@@ -415,32 +683,49 @@ void fred_step(int day) {
     order.push_back(d);
   }
   if(Global::Conditions.get_number_of_conditions() > 1) {
-    FYShuffle<int>(order);
+    if(Partition::is_enabled()) {
+      // the partitions exchange visits for the conditions in the same order
+      Entity_Stream stream(Random::CONDITION_ORDER_STREAM, day);
+      FYShuffle<int>(order);
+    } else {
+      FYShuffle<int>(order);
+    }
   }
 
   // update epidemic for each condition in turn
   for(int d = 0; d < Global::Conditions.get_number_of_conditions(); ++d) {
     int condition_id = order[d];
     Condition* condition = Global::Conditions.get_condition(condition_id);
+    Profiler_Zone zone(condition->get_condition_name());
     condition->update(day);
     Utils::fred_print_lap_time("day %d update epidemic for condition %d", day, condition_id);
   }
 
   // print daily reports and visualization data
-  for(int d = 0; d < Global::Conditions.get_number_of_conditions(); ++d) {
-    Global::Conditions.get_condition(d)->report(day);
+  {
+    Profiler_Zone zone("report conditions");
+    for(int d = 0; d < Global::Conditions.get_number_of_conditions(); ++d) {
+      Global::Conditions.get_condition(d)->report(day);
+    }
   }
   Utils::fred_print_lap_time("day %d report conditions", day);
 
-  Global::Pop.report(day);
+  {
+    Profiler_Zone zone("report population");
+    Global::Pop.report(day);
+  }
   Utils::fred_print_lap_time("day %d report population", day);
 
   if(Global::Report_Presenteeism || Global::Report_Childhood_Presenteeism) {
     Activities::report(day);
   }
 
+  // optional: digest of the end-of-day state, for checking thread-count invariance
+  State_Digest::record(day);
+
   // print visualization data if desired
   if(Global::Enable_Visualization_Layer) {
+    Profiler_Zone zone("print visualization data");
     Global::Visualization->print_visualization_data(day);
     Utils::fred_print_lap_time("day %d print_visualization_data", day);
   }
@@ -448,7 +733,7 @@ void fred_step(int day) {
   // optional: report change in demographics at end of each year
   if(Global::Enable_Population_Dynamics && Global::Verbose
      && Date::get_month() == 12 && Date::get_day_of_month() == 31) {
-    Global::Pop.quality_control();
+    Global::Pop.report_age_distribution();
   }
 
   // optional: report County demographics at end of each year
@@ -470,7 +755,7 @@ void fred_step(int day) {
   Utils::fred_print_wall_time("day %d finished", day);
   FRED_STATUS(0, "%s ", Date::get_date_string().c_str());
   Utils::fred_print_day_timer(day);
-  Global::Daily_Tracker->output_inline_report_format_for_index(day, Global::Outfp);
+  Async_Output::write(Global::Outfp, Global::Daily_Tracker->print_inline_report_format_for_index(day));
 
   // advance date counter
   Date::update();
@@ -480,12 +765,12 @@ void fred_step(int day) {
 void make_output_variable_files() {
   // parse the output files into csv files, one for each column
   char dir[FRED_STRING_SIZE];
-  sprintf(dir, "%s/RUN%d/DAILY",
+  Utils::fred_snprintf(dir, sizeof(dir), "%s/RUN%d/DAILY",
 	  Global::Simulation_directory,
 	  Global::Simulation_run_number);
   Utils::fred_make_directory(dir);
   char outfile[FRED_STRING_SIZE];
-  sprintf(outfile, "%s/RUN%d/out.csv",
+  Utils::fred_snprintf(outfile, sizeof(outfile), "%s/RUN%d/out.csv",
 	  Global::Simulation_directory,
 	  Global::Simulation_run_number);
   FILE *fp = fopen(outfile, "r");
@@ -528,7 +813,7 @@ void make_output_variable_files() {
 	if (strcmp(name, "Day") == 0) {
 	  continue;
 	}
-	sprintf(filename, "%s/%s.txt", dir, name);
+	Utils::fred_snprintf(filename, sizeof(filename), "%s/%s.txt", dir, name);
 	// printf("col filename %d = |%s|\n", col, filename);
 	FILE *colfp = fopen(filename, "w");
 	if (colfp == NULL) {
@@ -586,6 +871,10 @@ void fred_finish() {
   Global::Pop.end_of_run();
   Global::Places.end_of_run();
   Global::Conditions.end_of_run();
+  Profiler::end_of_run();
+  State_Digest::end_of_run();
+  Partition::end_of_run();
+  Params::report_unused_parameters();
 
   if(Global::Enable_Transmission_Network) {
     // Global::Transmission_Network->print();
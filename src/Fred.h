@@ -23,6 +23,8 @@ int main(int argc, char* argv[]);
 void fred_setup(int argc, char* argv[]);
 void fred_step(int day);
 void fred_finish();
+int fred_run_batch(int first_run, int last_run, int max_workers, double setup_time);
+void fred_run_replicate(int run, int setup_run, int branch_day);
 
 #define _FRED_H
 
@@ -83,6 +83,32 @@ double Geo::spherical_projection_distance (fred::geo lon1, fred::geo lat1, fred:
   return EARTH_RADIUS*sqrt(dlat+tmp);
 }
 
+// The batch functions below are plain loops over the coordinate arrays
+// of Place_List. At -O3 the squared distances in xy_distances are
+// vectorized; the square roots (which may set errno) and the selection
+// in xy_within_radius are not.
+
+void Geo::xy_distances(double x, double y, const double* xs, const double* ys, int n, double* dist) {
+  for(int i = 0; i < n; ++i) {
+    dist[i] = (xs[i]-x)*(xs[i]-x)+(ys[i]-y)*(ys[i]-y);
+  }
+  for(int i = 0; i < n; ++i) {
+    dist[i] = sqrt(dist[i]);
+  }
+}
+
+int Geo::xy_within_radius(double x, double y, const double* xs, const double* ys, int n, double radius, int* index) {
+  double radius2 = radius * radius;
+  int found = 0;
+  for(int i = 0; i < n; ++i) {
+    double d2 = (xs[i]-x)*(xs[i]-x)+(ys[i]-y)*(ys[i]-y);
+    // store the index unconditionally and keep it only if it is in range
+    index[found] = i;
+    found += (d2 <= radius2);
+  }
+  return found;
+}
+
 /*
 
   int main () {
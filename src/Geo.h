@@ -22,6 +22,7 @@
 
 #include "Global.h"
 #include <cmath>
+#include <vector>
 
 using namespace std;
 
@@ -89,6 +90,35 @@ public:
     return sqrt((x1-x2)*(x1-x2)+(y1-y2)*(y1-y2));
   }
   
+  static double xy_distance_squared(double x1, double y1, double x2, double y2) {
+    return (x1-x2)*(x1-x2)+(y1-y2)*(y1-y2);
+  }
+
+  /**
+   * Projected coordinates of a list of points, kept in separate
+   * contiguous arrays for the batch distance functions below.
+   */
+  typedef struct {
+    std::vector<double> x;
+    std::vector<double> y;
+  } xy_coordinates_t;
+
+  /**
+   * Distances from (x,y) to each of the n points.
+   *
+   * @param dist array of n distances to fill in
+   */
+  static void xy_distances(double x, double y, const double* xs, const double* ys, int n, double* dist);
+
+  /**
+   * Indices of the points that lie within radius of (x,y), in order.
+   * Compares squared distances, so no square roots are taken.
+   *
+   * @param index array of at least n entries to fill in
+   * @return the number of points found
+   */
+  static int xy_within_radius(double x, double y, const double* xs, const double* ys, int n, double radius, int* index);
+
   static double xsize_to_degree_longitude(double xsize) {
     return (xsize / km_per_deg_longitude);
   }
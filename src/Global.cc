@@ -84,6 +84,8 @@ bool Global::Print_Household_Locations = false;
 int Global::Report_Age_Of_Infection = 0;
 int Global::Age_Of_Infection_Log_Level = Global::LOG_LEVEL_MIN;
 bool Global::Report_Place_Of_Infection = false;
+bool Global::Report_Transmission_Counters = false;
+bool Global::Enable_Susceptible_Rosters = false;
 bool Global::Report_Distance_Of_Infection = false;
 bool Global::Report_Presenteeism = false;
 bool Global::Report_Childhood_Presenteeism = false;
@@ -91,6 +93,7 @@ bool Global::Report_Serial_Interval = false;
 bool Global::Report_Incidence_By_County = false;
 bool Global::Report_Incidence_By_Census_Tract = false;
 bool Global::Report_Symptomatic_Incidence_By_Census_Tract = false;
+bool Global::Report_Geo_Incidence_Cube = false;
 bool Global::Report_County_Demographic_Information = false;
 bool Global::Assign_Teachers = false;
 char Global::PSA_Method[FRED_STRING_SIZE];
@@ -140,7 +143,7 @@ void Global::get_global_parameters() {
   Params::get_param("reseed_day", &Global::Reseed_day);
   Params::get_param("outdir", Global::Output_directory);
   // Params::get_param("tracefile", Global::Tracefilebase);
-  // Params::get_param("track_infection_events", &Global::Track_infection_events);
+  Params::get_param("track_infection_events", &Global::Track_infection_events);
 
   Params::get_param("seasonality_timestep_file", Global::Seasonality_Timestep);
 
@@ -211,6 +214,10 @@ void Global::get_global_parameters() {
   Params::get_param("age_of_infection_log_level", &Global::Age_Of_Infection_Log_Level);
   Params::get_param("report_place_of_infection", &temp_int);
   Global::Report_Place_Of_Infection = (temp_int == 0 ? false : true);
+  Params::get_param("report_transmission_counters", &temp_int);
+  Global::Report_Transmission_Counters = (temp_int == 0 ? false : true);
+  Params::get_param("enable_susceptible_rosters", &temp_int);
+  Global::Enable_Susceptible_Rosters = (temp_int == 0 ? false : true);
   Params::get_param("report_distance_of_infection", &temp_int);
   Global::Report_Distance_Of_Infection = (temp_int == 0 ? false : true);
   Params::get_param("report_presenteeism", &temp_int);
@@ -225,6 +232,8 @@ void Global::get_global_parameters() {
   Global::Report_Incidence_By_Census_Tract = (temp_int == 0 ? false : true);
   Params::get_param("report_symptomatic_incidence_by_census_tract", &temp_int);
   Global::Report_Symptomatic_Incidence_By_Census_Tract = (temp_int == 0 ? false : true);
+  Params::get_param("report_geo_incidence_cube", &temp_int);
+  Global::Report_Geo_Incidence_Cube = (temp_int == 0 ? false : true);
   Params::get_param("report_county_demographic_information", &temp_int);
   Global::Report_County_Demographic_Information = (temp_int == 0 ? false : true);
 
@@ -246,6 +246,8 @@ public:
   static int Report_Age_Of_Infection;
   static int Age_Of_Infection_Log_Level;
   static bool Report_Place_Of_Infection;
+  static bool Report_Transmission_Counters;
+  static bool Enable_Susceptible_Rosters;
   static bool Report_Distance_Of_Infection;
   static bool Report_Presenteeism;
   static bool Report_Childhood_Presenteeism;
@@ -253,6 +255,7 @@ public:
   static bool Report_Incidence_By_County;
   static bool Report_Incidence_By_Census_Tract;
   static bool Report_Symptomatic_Incidence_By_Census_Tract; 
+  static bool Report_Geo_Incidence_Cube;
   static bool Report_County_Demographic_Information;
   static bool Assign_Teachers;
   static char PSA_Method[];
@@ -27,6 +27,7 @@
 #include "Person.h"
 #include "Place.h"
 #include "Place_List.h"
+#include "Profiler.h"
 #include "Random.h"
 #include "Transmission.h"
 #include "Utils.h"
@@ -201,18 +202,13 @@ void HIV_Epidemic::import_aux1(char sex, int age_bundle, int day, double radius,
     std::vector<Person*> people;
     people.clear();
     // find households that qualify by location
-    int hsize = Global::Places.get_number_of_households();
+    std::vector<int> houses;
+    Global::Places.get_households_within_radius(lat, lon, radius, houses);
+    int hsize = houses.size();
     // printf("IMPORT: houses  %d\n", hsize); fflush(stdout);
     
     for(int i = 0; i < hsize; ++i) {
-      Household* hh = Global::Places.get_household(i);
-      double dist = 0.0;
-      if(radius > 0) {
-        dist = Geo::xy_distance(lat,lon,hh->get_latitude(),hh->get_longitude());
-        if(radius < dist) {
-          continue;
-        }
-      }
+      Household* hh = Global::Places.get_household(houses[i]);
       
       // this household qualifies by location
       // find all susceptible housemates who qualify by age.
@@ -548,7 +544,10 @@ void HIV_Epidemic::update(int day) {
     st_network->add_infectious_person(this->id, person);
   }
   FRED_VERBOSE(0, "calling spread infection\n");
-  this->condition->get_transmission()->spread_infection(day, this->id, st_network);
+  {
+    Profiler_Zone zone("sexual");
+    this->condition->get_transmission()->spread_infection(day, this->id, st_network);
+  }
   FRED_VERBOSE(0, "spread infection finished\n");
   st_network->clear_infectious_people(this->id);
   FRED_VERBOSE(0, "clear_infectious_people finished\n");
@@ -784,6 +783,7 @@ void HIV_Epidemic::increment_hiv_incidence(Person* infectee){
 //*******************************************************
 
 void HIV_Epidemic::end_of_run(){
+  Epidemic::end_of_run();
   
   // print end-of-run statistics here:
   /*********************************************************
@@ -20,11 +20,14 @@
 #include <stdexcept>
 
 #include "Age_Map.h"
+#include "Async_Output.h"
+#include "Checkpoint.h"
 #include "Date.h"
 #include "Condition.h"
 #include "Condition_List.h"
 #include "Health.h"
 #include "HIV_Infection.h"
+#include "Infection_Log.h"
 #include "Household.h"
 #include "Natural_History.h"
 #include "Mixing_Group.h"
@@ -144,6 +147,10 @@ Health::~Health() {
   delete[] this->health_condition;
 }
 
+void Health::update_susceptible_rosters(int condition_id, bool susceptible) {
+  this->myself->update_susceptible_rosters(condition_id, susceptible);
+}
+
 void Health::become_susceptible(int condition_id) {
   if(is_susceptible(condition_id)) {
     FRED_VERBOSE(0, 
@@ -157,7 +164,7 @@ void Health::become_susceptible(int condition_id) {
   assert(is_susceptible(condition_id));
   clear_recovered(condition_id);
   if (Global::Enable_Health_Records) {
-    fprintf(Global::HealthRecordfp,
+    Async_Output::print(Global::HealthRecordfp,
 	    "HEALTH RECORD: %s day %d person %d age %d is SUSCEPTIBLE for %s\n",
 	    Date::get_date_string().c_str(),
 	    Global::Simulation_Day,
@@ -177,7 +184,7 @@ void Health::become_exposed(int condition_id, Person* infector, Mixing_Group* mi
     
   if(mixing_group == NULL) {
     if (Global::Enable_Health_Records) {
-      fprintf(Global::HealthRecordfp,
+      Async_Output::print(Global::HealthRecordfp,
 	      "HEALTH RECORD: %s day %d person %d age %d is an IMPORTED EXPOSURE to %s\n",
 	      Date::get_date_string().c_str(),
 	      Global::Simulation_Day,
@@ -187,7 +194,7 @@ void Health::become_exposed(int condition_id, Person* infector, Mixing_Group* mi
   }
   else {
     if (Global::Enable_Health_Records) {
-      fprintf(Global::HealthRecordfp,
+      Async_Output::print(Global::HealthRecordfp,
 	      "HEALTH RECORD: %s day %d person %d age %d is EXPOSED to %s at %c from person %d\n",
 	      Date::get_date_string().c_str(),
 	      Global::Simulation_Day,
@@ -198,6 +205,15 @@ void Health::become_exposed(int condition_id, Person* infector, Mixing_Group* mi
     }
   }
 
+  if(Global::Track_infection_events > 0) {
+    if(mixing_group == NULL) {
+      Infection_Log::record(day, condition_id, myself->get_id(), -1, 'X', -1);
+    } else {
+      Infection_Log::record(day, condition_id, myself->get_id(), (infector == NULL ? -1 : infector->get_id()),
+			    mixing_group->get_type(), mixing_group->get_id());
+    }
+  }
+
   set_infector(condition_id, infector);
   set_mixing_group(condition_id, mixing_group);
   set_onset_day(condition_id, day);
@@ -266,7 +282,7 @@ void Health::become_exposed(int condition_id, Person* infector, Mixing_Group* mi
 void Health::become_unsusceptible(int condition_id) {
   set_susceptibility(condition_id, 0.0);
   if (Global::Enable_Health_Records) {
-    fprintf(Global::HealthRecordfp,
+    Async_Output::print(Global::HealthRecordfp,
 	    "HEALTH RECORD: %s day %d person %d age %d is UNSUSCEPTIBLE for %s\n",
 	    Date::get_date_string().c_str(),
 	    Global::Simulation_Day,
@@ -281,7 +297,7 @@ void Health::become_infectious(int condition_id) {
   assert(hh != NULL);
   hh->set_human_infectious(condition_id);
   if (Global::Enable_Health_Records) {
-    fprintf(Global::HealthRecordfp,
+    Async_Output::print(Global::HealthRecordfp,
 	    "HEALTH RECORD: %s day %d person %d age %d is INFECTIOUS for %s\n",
 	    Date::get_date_string().c_str(),
 	    Global::Simulation_Day,
@@ -292,7 +308,7 @@ void Health::become_infectious(int condition_id) {
 
 void Health::become_noninfectious(int condition_id) {
   if (Global::Enable_Health_Records) {
-    fprintf(Global::HealthRecordfp,
+    Async_Output::print(Global::HealthRecordfp,
 	    "HEALTH RECORD: %s day %d person %d age %d is NONINFECTIOUS for %s\n",
 	    Date::get_date_string().c_str(),
 	    Global::Simulation_Day,
@@ -303,7 +319,7 @@ void Health::become_noninfectious(int condition_id) {
 
 void Health::become_symptomatic(int condition_id) {
   if (Global::Enable_Health_Records) {
-    fprintf(Global::HealthRecordfp,
+    Async_Output::print(Global::HealthRecordfp,
 	    "HEALTH RECORD: %s day %d person %d age %d is SYMPTOMATIC for %s\n",
 	    Date::get_date_string().c_str(),
 	    Global::Simulation_Day,
@@ -315,7 +331,7 @@ void Health::become_symptomatic(int condition_id) {
 void Health::resolve_symptoms(int condition_id) {
   set_symptoms_level(condition_id, Global::NO_SYMPTOMS);
   if (Global::Enable_Health_Records) {
-    fprintf(Global::HealthRecordfp,
+    Async_Output::print(Global::HealthRecordfp,
 	    "HEALTH RECORD: %s day %d person %d age %d RESOLVES SYMPTOMS for %s\n",
 	    Date::get_date_string().c_str(),
 	    Global::Simulation_Day,
@@ -327,7 +343,7 @@ void Health::resolve_symptoms(int condition_id) {
 
 void Health::recover(int condition_id, int day) {
   if (Global::Enable_Health_Records) {
-    fprintf(Global::HealthRecordfp,
+    Async_Output::print(Global::HealthRecordfp,
 	    "HEALTH RECORD: %s day %d person %d age %d is RECOVERED from %s\n",
 	    Date::get_date_string().c_str(),
 	    Global::Simulation_Day,
@@ -349,7 +365,7 @@ void Health::become_removed(int condition_id, int day) {
   set_susceptibility(condition_id, 0.0);
   set_infectivity(condition_id, 0.0);
   if (Global::Enable_Health_Records) {
-    fprintf(Global::HealthRecordfp,
+    Async_Output::print(Global::HealthRecordfp,
 	    "HEALTH RECORD: %s day %d person %d age %d is REMOVED for %s\n",
 	    Date::get_date_string().c_str(),
 	    Global::Simulation_Day,
@@ -365,7 +381,7 @@ void Health::become_immune(int condition_id) {
   set_susceptibility(condition_id, 0.0);
   set_infectivity(condition_id, 0.0);
   if (Global::Enable_Health_Records) {
-    fprintf(Global::HealthRecordfp,
+    Async_Output::print(Global::HealthRecordfp,
 	    "HEALTH RECORD: %s day %d person %d age %d is IMMUNE for %s\n",
 	    Date::get_date_string().c_str(),
 	    Global::Simulation_Day,
@@ -381,7 +397,7 @@ void Health::become_case_fatality(int condition_id, int day) {
 	       day, myself->get_id());
   set_case_fatality(condition_id);
   if (Global::Enable_Health_Records) {
-    fprintf(Global::HealthRecordfp,
+    Async_Output::print(Global::HealthRecordfp,
 	    "HEALTH RECORD: %s day %d person %d age %d is CASE_FATALITY for %s\n",
 	    Date::get_date_string().c_str(),
 	    Global::Simulation_Day,
@@ -575,3 +591,63 @@ char* Health::get_mixing_group_label(int condtion_id) const {
 char Health::get_mixing_group_type(int condition_id) const {
   return get_mixing_group(condition_id) ? get_mixing_group(condition_id)->get_type() : 'X' ;
 }
+
+void Health::write_checkpoint() {
+  for(int c = 0; c < this->number_of_conditions; ++c) {
+    health_condition_t* condition = &(this->health_condition[c]);
+    Checkpoint::put(condition->state);
+    Checkpoint::put(condition->last_transition_day);
+    Checkpoint::put(condition->next_transition_day);
+    Checkpoint::put(condition->onset_day);
+    Checkpoint::put(condition->symptoms_level);
+    Checkpoint::put(condition->symptoms_start_date);
+    Checkpoint::put(condition->is_fatal);
+    Checkpoint::put(condition->is_immune);
+    Checkpoint::put(condition->is_infected);
+    Checkpoint::put(condition->is_recovered);
+    Checkpoint::put(condition->susceptibility);
+    Checkpoint::put(condition->infectivity);
+    Checkpoint::put_person(condition->infector);
+    Checkpoint::put_place(condition->mixing_group);
+    Checkpoint::put(condition->number_of_infectees);
+    Checkpoint::put(condition->is_susceptibility_modified);
+    Checkpoint::put(condition->is_transmission_modified);
+    Checkpoint::put(condition->is_symptoms_modified);
+    Checkpoint::put_array(condition->susceptibility_modifier, this->number_of_conditions);
+    Checkpoint::put_array(condition->transmission_modifier, this->number_of_conditions);
+    Checkpoint::put_array(condition->symptoms_modifier, this->number_of_conditions);
+  }
+  Checkpoint::put(this->days_symptomatic);
+  Checkpoint::put(this->alive);
+  Checkpoint::put(this->previous_infection_serotype);
+}
+
+void Health::read_checkpoint() {
+  for(int c = 0; c < this->number_of_conditions; ++c) {
+    health_condition_t* condition = &(this->health_condition[c]);
+    Checkpoint::get(condition->state);
+    Checkpoint::get(condition->last_transition_day);
+    Checkpoint::get(condition->next_transition_day);
+    Checkpoint::get(condition->onset_day);
+    Checkpoint::get(condition->symptoms_level);
+    Checkpoint::get(condition->symptoms_start_date);
+    Checkpoint::get(condition->is_fatal);
+    Checkpoint::get(condition->is_immune);
+    Checkpoint::get(condition->is_infected);
+    Checkpoint::get(condition->is_recovered);
+    Checkpoint::get(condition->susceptibility);
+    Checkpoint::get(condition->infectivity);
+    condition->infector = Checkpoint::get_person();
+    condition->mixing_group = Checkpoint::get_place();
+    Checkpoint::get(condition->number_of_infectees);
+    Checkpoint::get(condition->is_susceptibility_modified);
+    Checkpoint::get(condition->is_transmission_modified);
+    Checkpoint::get(condition->is_symptoms_modified);
+    Checkpoint::get_array(condition->susceptibility_modifier, this->number_of_conditions);
+    Checkpoint::get_array(condition->transmission_modifier, this->number_of_conditions);
+    Checkpoint::get_array(condition->symptoms_modifier, this->number_of_conditions);
+  }
+  Checkpoint::get(this->days_symptomatic);
+  Checkpoint::get(this->alive);
+  Checkpoint::get(this->previous_infection_serotype);
+}
@@ -22,6 +22,8 @@
 #include <vector>
 using namespace std;
 
+#include "Global.h"
+
 class Age_Map;
 class Condition;
 class HIV_Infection;
@@ -101,6 +103,9 @@ public:
   void update_mixing_group_counts(int day, int condition_id, Mixing_Group* mixing_group);
   void terminate(int day);
 
+  void write_checkpoint();
+  void read_checkpoint();
+
   // ACCESS METHODS TO HEALTH CONDITIONS
 
   void set_state(int condition_id, int state, int day);
@@ -199,6 +204,9 @@ public:
   }
 
   void set_susceptibility(int condition_id, double susceptibility) {
+    if(Global::Enable_Susceptible_Rosters && (susceptibility > 0.0) != is_susceptible(condition_id)) {
+      update_susceptible_rosters(condition_id, susceptibility > 0.0);
+    }
     this->health_condition[condition_id].susceptibility = susceptibility;
   }
 
@@ -367,6 +375,8 @@ public:
 
 private:
 
+  void update_susceptible_rosters(int condition_id, bool susceptible);
+
   int number_of_conditions;
 
   // link back to person
@@ -109,12 +109,17 @@ int Hospital::get_group(int condition, Person* per) {
 double Hospital::get_transmission_prob(int condition, Person* i, Person* s) {
   // i = infected agent
   // s = susceptible agent
-  int row = get_group(condition, i);
-  int col = get_group(condition, s);
+  int row = Hospital::get_group(condition, i);
+  int col = Hospital::get_group(condition, s);
   double tr_pr = Hospital::prob_transmission_per_contact[row][col];
   return tr_pr;
 }
 
+double Hospital::get_transmission_prob_for_group(int condition, int row, Person* s) {
+  int col = Hospital::get_group(condition, s);
+  return Hospital::prob_transmission_per_contact[row][col];
+}
+
 int Hospital::get_bed_count(int sim_day) {
   return this->bed_count;
 }
@@ -37,6 +37,7 @@ using namespace std;
 //Private static variables that will be set by parameter lookups
 double Household::contacts_per_day;
 double Household::same_age_bias = 0.0;
+std::vector<double> Household::age_bias;
 double** Household::prob_transmission_per_contact;
 
 std::set<long int> Household::census_tract_set;
@@ -110,6 +111,7 @@ void Household::get_parameters() {
   Params::get_param("household_contacts", &Household::contacts_per_day);
   Params::get_param("neighborhood_same_age_bias", &Household::same_age_bias);
   Household::same_age_bias *= 0.5;
+  Place::setup_age_bias_table(Household::same_age_bias, Household::age_bias);
   int n = Params::get_param_matrix((char *)"household_trans_per_contact", &Household::prob_transmission_per_contact);
   if(Global::Verbose > 1) {
     printf("\nHousehold contact_prob:\n");
@@ -130,36 +132,6 @@ void Household::get_parameters() {
   Params::get_param("cat_VI_max_income", &Household::Cat_VI_Max_Income);
 }
 
-int Household::get_group(int condition, Person* per) {
-  int age = per->get_age();
-  if(age < Global::ADULT_AGE) {
-    return 0;
-  } else {
-    return 1;
-  }
-}
-
-double Household::get_transmission_probability(int condition, Person* i, Person* s) {
-  double age_i = i->get_real_age();
-  double age_s = s->get_real_age();
-  double diff = fabs(age_i - age_s);
-  double prob = exp(-Household::same_age_bias * diff);
-  return prob;
-}
-
-double Household::get_transmission_prob(int condition, Person* i, Person* s) {
-  // i = infected agent
-  // s = susceptible agent
-  int row = get_group(condition, i);
-  int col = get_group(condition, s);
-  double tr_pr = Household::prob_transmission_per_contact[row][col];
-  return tr_pr;
-}
-
-double Household::get_contacts_per_day(int condition) {
-  return Household::contacts_per_day;
-}
-
 void Household::set_household_has_hospitalized_member(bool does_have) {
   this->hh_schl_aged_chld_unemplyd_adlt_is_set = false;
   if(does_have) {
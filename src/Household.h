@@ -158,7 +158,14 @@ public:
   /**
    * @see Place::get_group(int condition, Person* per)
    */
-  int get_group(int condition, Person* per);
+  int get_group(int condition, Person* per) {
+    int age = per->get_age();
+    if(age < Global::ADULT_AGE) {
+      return 0;
+    } else {
+      return 1;
+    }
+  }
 
   /**
    * @see Mixing_Group::get_transmission_prob(int condition_id, Person* i, Person* s)
@@ -168,9 +175,33 @@ public:
    * The static array <code>Household_contact_prob</code> will be filled with values from the parameter
    * file for the key <code>household_prob[]</code>.
    */
-  double get_transmission_prob(int condition_id, Person* i, Person* s);
+  double get_transmission_prob(int condition, Person* i, Person* s) {
+    // i = infected agent
+    // s = susceptible agent
+    int row = Household::get_group(condition, i);
+    int col = Household::get_group(condition, s);
+    double tr_pr = Household::prob_transmission_per_contact[row][col];
+    return tr_pr;
+  }
 
-  double get_transmission_probability(int condition, Person* i, Person* s);
+  /**
+   * The transmission probability for an infector in the given group (row
+   * of the contact matrix), for callers that look up many susceptibles
+   * with the same infector.
+   */
+  double get_transmission_prob_for_group(int condition, int row, Person* s) {
+    int col = Household::get_group(condition, s);
+    return Household::prob_transmission_per_contact[row][col];
+  }
+
+  double get_transmission_probability(int condition, Person* i, Person* s) {
+    // the difference in real age is the difference in birthdays
+    int days = abs(i->get_birthday_sim_day() - s->get_birthday_sim_day());
+    if(days < (int) Household::age_bias.size()) {
+      return Household::age_bias[days];
+    }
+    return exp(-Household::same_age_bias * (days / 365.25));
+  }
 
   /**
    * @see Place::get_contacts_per_day(int condition)
@@ -180,7 +211,9 @@ public:
    * The static array <code>Household_contacts_per_day</code> will be filled with values from the parameter
    * file for the key <code>household_contacts[]</code>.
    */
-  double get_contacts_per_day(int condition);
+  double get_contacts_per_day(int condition) {
+    return Household::contacts_per_day;
+  }
 
   /**
    * Use to get list of all people in the household.
@@ -505,6 +538,7 @@ private:
 
   static double contacts_per_day;
   static double same_age_bias;
+  static std::vector<double> age_bias; // indexed by the days between birthdays
   static double** prob_transmission_per_contact;
 
   //Income Limits for classification
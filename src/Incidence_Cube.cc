@@ -0,0 +1,83 @@
+/*
+  This file is part of the FRED system.
+
+  Copyright (c) 2013-2016, University of Pittsburgh, John Grefenstette,
+  David Galloway, Mary Krauland, Michael Lann, and Donald Burke.
+
+  Based in part on FRED Version 2.9, created in 2010-2013 by
+  John Grefenstette, Shawn Brown, Roni Rosenfield, Alona Fyshe, David
+  Galloway, Nathan Stone, Jay DePasse, Anuroop Sriram, and Donald Burke.
+
+  Licensed under the BSD 3-Clause license.  See the file "LICENSE" for
+  more information.
+*/
+
+//
+//
+// File: Incidence_Cube.cc
+//
+
+#include "Async_Output.h"
+#include "Global.h"
+#include "Incidence_Cube.h"
+#include "Utils.h"
+
+Incidence_Cube::Incidence_Cube(const vector<long int> &region_ids, const vector<string> &metrics, int days) {
+  this->regions = region_ids.size();
+  this->days = days;
+  this->region_ids = region_ids;
+  this->metrics = metrics;
+  this->counts.assign((size_t) days * this->regions * metrics.size(), 0);
+}
+
+int Incidence_Cube::get_metric_index(const char* name) const {
+  for(int m = 0; m < (int) this->metrics.size(); ++m) {
+    if(this->metrics[m] == name) {
+      return m;
+    }
+  }
+  return -1;
+}
+
+void Incidence_Cube::write(const char* filename, const char* region_name) const {
+  FILE* fp = Async_Output::open(filename, "w");
+  if(fp == NULL) {
+    Utils::fred_abort("Can't open %s\n", filename);
+  }
+
+  std::string block = "day,";
+  block += region_name;
+  for(int m = 0; m < (int) this->metrics.size(); ++m) {
+    block += ",";
+    block += this->metrics[m];
+  }
+  block += "\n";
+
+  int number_of_metrics = this->metrics.size();
+  char field[FRED_STRING_SIZE];
+  for(int day = 0; day < this->days; ++day) {
+    for(int r = 0; r < this->regions; ++r) {
+      const int* row = &(this->counts[((size_t) day * this->regions + r) * number_of_metrics]);
+      bool empty = true;
+      for(int m = 0; m < number_of_metrics && empty; ++m) {
+	empty = (row[m] == 0);
+      }
+      if(empty) {
+	continue;
+      }
+      Utils::fred_snprintf(field, sizeof(field), "%d,%ld", day, this->region_ids[r]);
+      block += field;
+      for(int m = 0; m < number_of_metrics; ++m) {
+	Utils::fred_snprintf(field, sizeof(field), ",%d", row[m]);
+	block += field;
+      }
+      block += "\n";
+    }
+    if(block.length() >= 65536) {
+      Async_Output::write(fp, block);
+      block.clear();
+    }
+  }
+  Async_Output::write(fp, block);
+  Async_Output::close(fp);
+}
@@ -0,0 +1,73 @@
+/*
+  This file is part of the FRED system.
+
+  Copyright (c) 2013-2016, University of Pittsburgh, John Grefenstette,
+  David Galloway, Mary Krauland, Michael Lann, and Donald Burke.
+
+  Based in part on FRED Version 2.9, created in 2010-2013 by
+  John Grefenstette, Shawn Brown, Roni Rosenfield, Alona Fyshe, David
+  Galloway, Nathan Stone, Jay DePasse, Anuroop Sriram, and Donald Burke.
+
+  Licensed under the BSD 3-Clause license.  See the file "LICENSE" for
+  more information.
+*/
+
+//
+//
+// File: Incidence_Cube.h
+//
+
+#ifndef _FRED_INCIDENCE_CUBE_H
+#define _FRED_INCIDENCE_CUBE_H
+
+#include <string>
+#include <vector>
+using namespace std;
+
+/**
+ * Daily counts stratified by geographic region, held in a dense
+ * [day x region x metric] array and written once at the end of the run.
+ *
+ * With report_geo_incidence_cube set, the county and census tract
+ * reports fill a cube by index instead of tracking one out.csv column
+ * per region and metric.
+ */
+class Incidence_Cube {
+public:
+
+  /**
+   * @param region_ids the fips code of each region, in index order
+   * @param metrics the name of each metric
+   * @param days the number of days in the run
+   */
+  Incidence_Cube(const vector<long int> &region_ids, const vector<string> &metrics, int days);
+
+  void set(int day, int region, int metric, int value) {
+    this->counts[((size_t) day * this->regions + region) * this->metrics.size() + metric] = value;
+  }
+
+  int get(int day, int region, int metric) const {
+    return this->counts[((size_t) day * this->regions + region) * this->metrics.size() + metric];
+  }
+
+  int get_metric_index(const char* name) const;
+
+  /**
+   * Write the cube as CSV, one row per day and region, with header
+   * "day,<region_name>,<metric>,...". Rows in which every metric is
+   * zero are left out.
+   *
+   * @param filename the file to write
+   * @param region_name the header of the region column
+   */
+  void write(const char* filename, const char* region_name) const;
+
+private:
+  int regions;
+  int days;
+  vector<long int> region_ids;
+  vector<string> metrics;
+  vector<int> counts;
+};
+
+#endif // _FRED_INCIDENCE_CUBE_H
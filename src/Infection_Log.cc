@@ -0,0 +1,114 @@
+/*
+  This file is part of the FRED system.
+
+  Copyright (c) 2013-2016, University of Pittsburgh, John Grefenstette,
+  David Galloway, Mary Krauland, Michael Lann, and Donald Burke.
+
+  Based in part on FRED Version 2.9, created in 2010-2013 by
+  John Grefenstette, Shawn Brown, Roni Rosenfield, Alona Fyshe, David
+  Galloway, Nathan Stone, Jay DePasse, Anuroop Sriram, and Donald Burke.
+
+  Licensed under the BSD 3-Clause license.  See the file "LICENSE" for
+  more information.
+*/
+
+//
+//
+// File: Infection_Log.cc
+//
+
+#include "Async_Output.h"
+#include "Infection_Log.h"
+#include "Params.h"
+
+bool Infection_Log::binary = false;
+std::atomic<bool> Infection_Log::header_written(false);
+Infection_Log::block_t Infection_Log::blocks[Global::MAX_NUM_THREADS];
+
+void Infection_Log::get_parameters() {
+  int temp_int = 0;
+  Params::get_param("binary_infection_log", &temp_int);
+  Infection_Log::binary = (temp_int == 0 ? false : true);
+}
+
+void Infection_Log::record(int day, int condition, int host, int infector, char place_type, int place) {
+  if(Infection_Log::binary == false) {
+    Async_Output::print(Global::Infectionfp, "day %d cond %d host %d infector %d at %c place %d\n",
+			day, condition, host, infector, place_type, place);
+    return;
+  }
+  block_t* b = &(Infection_Log::blocks[fred::omp_get_thread_num()]);
+  b->column[DAY_COLUMN].push_back(day);
+  b->column[CONDITION_COLUMN].push_back(condition);
+  b->column[HOST_COLUMN].push_back(host);
+  b->column[INFECTOR_COLUMN].push_back(infector);
+  b->column[PLACE_COLUMN].push_back(place);
+  b->place_type += place_type;
+  if(b->place_type.size() >= BLOCK_RECORDS) {
+    Infection_Log::write_block(b);
+  }
+}
+
+void Infection_Log::flush() {
+  if(Infection_Log::binary == false) {
+    return;
+  }
+  for(int t = 0; t < Global::MAX_NUM_THREADS; ++t) {
+    if(Infection_Log::blocks[t].place_type.empty() == false) {
+      Infection_Log::write_block(&(Infection_Log::blocks[t]));
+    }
+  }
+}
+
+void Infection_Log::write_block(block_t* b) {
+  // the release store publishes the header write to threads that see
+  // header_written set without entering the critical section
+  if(Infection_Log::header_written.load(std::memory_order_acquire) == false) {
+    #pragma omp critical(Infection_Log_header)
+    if(Infection_Log::header_written.load(std::memory_order_relaxed) == false) {
+      const char header[8] = { 'F', 'R', 'E', 'D', 'I', 'N', 'F', 1 };
+      Async_Output::write(Global::Infectionfp, header, 8);
+      Infection_Log::header_written.store(true, std::memory_order_release);
+    }
+  }
+
+  unsigned int records = b->place_type.size();
+  b->encoded.assign(8, '\0');
+  for(int c = 0; c < NUMBER_OF_COLUMNS; ++c) {
+    int previous = 0;
+    for(unsigned int i = 0; i < records; ++i) {
+      int delta = b->column[c][i] - previous;
+      previous = b->column[c][i];
+      // zigzag: small differences of either sign become small numbers
+      Infection_Log::append_value(b->encoded, ((unsigned int) delta << 1) ^ (unsigned int) (delta >> 31));
+    }
+    b->column[c].clear();
+  }
+  b->encoded += b->place_type;
+  b->place_type.clear();
+
+  unsigned int payload = b->encoded.size() - 8;
+  for(int i = 0; i < 4; ++i) {
+    b->encoded[i] = (char) ((records >> (8 * i)) & 0xff);
+    b->encoded[4 + i] = (char) ((payload >> (8 * i)) & 0xff);
+  }
+
+  // each block is a single record for the output writer, so blocks from
+  // different threads never interleave
+  Async_Output::write(Global::Infectionfp, b->encoded);
+}
+
+void Infection_Log::append_value(std::string &encoded, unsigned int value) {
+  // BER compressed integer: base 128, most significant group first, with
+  // the high bit set on every byte but the last
+  char bytes[5];
+  int n = 0;
+  do {
+    bytes[n++] = (char) (value & 0x7f);
+    value >>= 7;
+  } while(value > 0);
+  while(n > 1) {
+    encoded += (char) (bytes[--n] | 0x80);
+  }
+  encoded += bytes[0];
+}
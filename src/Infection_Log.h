@@ -0,0 +1,99 @@
+/*
+  This file is part of the FRED system.
+
+  Copyright (c) 2013-2016, University of Pittsburgh, John Grefenstette,
+  David Galloway, Mary Krauland, Michael Lann, and Donald Burke.
+
+  Based in part on FRED Version 2.9, created in 2010-2013 by
+  John Grefenstette, Shawn Brown, Roni Rosenfield, Alona Fyshe, David
+  Galloway, Nathan Stone, Jay DePasse, Anuroop Sriram, and Donald Burke.
+
+  Licensed under the BSD 3-Clause license.  See the file "LICENSE" for
+  more information.
+*/
+
+//
+//
+// File: Infection_Log.h
+//
+
+#ifndef _FRED_INFECTION_LOG_H
+#define _FRED_INFECTION_LOG_H
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "Global.h"
+
+/**
+ * The log of infection events written to RUN<n>/infections.txt (or
+ * infections.bin) when track_infection_events is set.
+ *
+ * The text log has one line per exposure:
+ *
+ *   day <day> cond <condition> host <id> infector <id> at <type> place <id>
+ *
+ * where imported cases have infector -1, place type X and place -1.
+ *
+ * With binary_infection_log set, the same events are written in blocks
+ * of up to BLOCK_RECORDS records after an 8-byte header ("FREDINF" and a
+ * version byte). Each block is two 32-bit little-endian words, the record
+ * count and the payload size in bytes, followed by the payload: the day,
+ * condition, host, infector and place columns, each as the difference
+ * from the previous value in the column, zigzag-encoded and written as a
+ * BER compressed integer (Perl's pack "w"), and then one byte of place
+ * type per record. bin/fred_convert_infections turns a binary log back
+ * into the text log.
+ */
+class Infection_Log {
+public:
+
+  /**
+   * Read the binary_infection_log parameter.
+   */
+  static void get_parameters();
+
+  static bool is_binary() {
+    return Infection_Log::binary;
+  }
+
+  /**
+   * Record the exposure of a host.
+   *
+   * @param day the simulation day
+   * @param condition the condition id
+   * @param host the id of the exposed person
+   * @param infector the id of the infector, or -1
+   * @param place_type the type of the place of exposure, or 'X'
+   * @param place the id of the place of exposure, or -1
+   */
+  static void record(int day, int condition, int host, int infector, char place_type, int place);
+
+  /**
+   * Write out the records buffered by every thread. Must not be called
+   * from inside a parallel region.
+   */
+  static void flush();
+
+private:
+  static const int BLOCK_RECORDS = 4096;
+
+  enum { DAY_COLUMN, CONDITION_COLUMN, HOST_COLUMN, INFECTOR_COLUMN, PLACE_COLUMN, NUMBER_OF_COLUMNS };
+
+  typedef struct block {
+    std::vector<int> column[NUMBER_OF_COLUMNS];
+    std::string place_type;
+    std::string encoded;
+    char padding[64];
+  } block_t;
+
+  static void write_block(block_t* b);
+  static void append_value(std::string &encoded, unsigned int value);
+
+  static bool binary;
+  static std::atomic<bool> header_written;
+  static block_t blocks[Global::MAX_NUM_THREADS];
+};
+
+#endif // _FRED_INFECTION_LOG_H
@@ -73,9 +73,14 @@ int Logistic_Regression::classify(double* x) {
 
 
 int Logistic_Regression::get_outcome(double* x) {
+  return get_outcome_from_score(get_score(x));
+}
+
+
+int Logistic_Regression::get_outcome_from_score(double z) {
   
   // probability of (value == 1)
-  double p = get_prob(x);
+  double p = 1.0 / (1.0 + exp(-z));
 
   // draw random number
   double r = Random::draw_random();
@@ -101,10 +106,8 @@ Ordinal_Logistic_Regression::~Ordinal_Logistic_Regression() {
 }
 
 
-int Ordinal_Logistic_Regression::get_outcome(double* x) {
+int Ordinal_Logistic_Regression::get_outcome_from_score(double z) {
 
-  // compute score for this observation
-  double z = get_score(x);
   // FRED_VERBOSE(0, "z = %f\n",z);
 
   // assign one of the (ordered) values
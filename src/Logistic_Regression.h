@@ -31,6 +31,14 @@ public:
   virtual double get_prob(double* x);
   virtual int classify(double* x);
   virtual int get_outcome(double* x);
+
+  /**
+   * Draw an outcome for an observation with the given score. Only this
+   * step uses the random number generator, so the scores of many
+   * observations can be computed in parallel and the outcomes drawn
+   * afterwards in a fixed order.
+   */
+  virtual int get_outcome_from_score(double z);
   
 protected:
   char name[FRED_STRING_SIZE];
@@ -49,7 +57,7 @@ class Ordinal_Logistic_Regression : public Logistic_Regression {
 public:
   Ordinal_Logistic_Regression(char* model_name, int values, double _z0, std::vector<double> &beta, double *cutoffs);
   ~Ordinal_Logistic_Regression();
-  int get_outcome(double* x);
+  int get_outcome_from_score(double z);
   int classify(double* x);
 
 private:
@@ -266,6 +266,16 @@ void Logit::prepare() {
     this->OLR = new Ordinal_Logistic_Regression(model_name, this->number_of_states, z0, this->beta, this->cutoff);
   }
 
+  // with no factors the score is the same for everyone
+  this->has_factors = false;
+  for (int i = 0; i < this->number_of_factors; i++) {
+    if (this->beta[i] != 0.0) {
+      this->has_factors = true;
+    }
+  }
+  std::vector<double> zero(this->number_of_factors + 1, 0.0);
+  this->constant_score = (this->number_of_states <= 2 ? this->LR : this->OLR)->get_score(&zero[0]);
+
   print();
 
 }
@@ -276,13 +286,31 @@ void Logit::print() {
 
 
 int Logit::get_outcome(Person *person) {
+  return get_outcome_from_score(get_score(person));
+}
+
+
+double Logit::get_score(Person *person) {
+  if (this->has_factors == false) {
+    return this->constant_score;
+  }
   double x[this->number_of_factors];
   fill_x(person, x);
   if (this->number_of_states <= 2) {
-    return this->LR->get_outcome(x);
+    return this->LR->get_score(x);
+  }
+  else {
+    return this->OLR->get_score(x);
+  }
+}
+
+
+int Logit::get_outcome_from_score(double z) {
+  if (this->number_of_states <= 2) {
+    return this->LR->get_outcome_from_score(z);
   }
   else {
-    return this->OLR->get_outcome(x);
+    return this->OLR->get_outcome_from_score(z);
   }
 }
 
@@ -326,7 +354,6 @@ void Logit::fill_x(Person* person, double* x) {
 
   for (int n = 0; n <= 80 ; n += 5) {
     x[i] = (beta[i]==0.0) ? 0.0 : (person->get_sex() == 'M' && n <= age && age < n+5); i++;
-    if (beta[i-1]!=0.0) {printf("LOGIT: sex %c age %.1f beta = %f x = %f\n", person->get_sex(), age, beta[i-1], x[i-1]);}
   }
   x[i] = (beta[i]==0.0) ? 0.0 : (person->get_sex() == 'M' && 85 <= age); i++;
 
@@ -37,6 +37,14 @@ public:
   }
   int get_outcome(Person* person);
 
+  /**
+   * get_outcome() in two steps: get_score() reads only the person and
+   * may be called from parallel code; get_outcome_from_score() draws
+   * the random outcome.
+   */
+  double get_score(Person* person);
+  int get_outcome_from_score(double z);
+
   // unit test
   static void test();
   void test_pop();
@@ -51,6 +59,8 @@ protected:
   Logistic_Regression* LR;
   Ordinal_Logistic_Regression* OLR;
   std::vector<double> beta;
+  bool has_factors;		// some coefficient is nonzero
+  double constant_score;	// the score when all factors are zero
 
   void fill_x(Person* person, double* x);
 
@@ -17,6 +17,7 @@
 // File: Mixing_Group.cc
 //
 
+#include "Checkpoint.h"
 #include "Mixing_Group.h"
 
 char Mixing_Group::TYPE_UNSET = 'U';
@@ -47,6 +48,8 @@ Mixing_Group::Mixing_Group(const char* lab) {
   
   int conditions = Global::Conditions.get_number_of_conditions();
   this->infectious_people = new std::vector<Person*>[conditions];
+  this->susceptible_roster = NULL;
+  this->roster_slot = NULL;
 
   // epidemic counters
   this->new_infections = new int[conditions];
@@ -100,6 +103,10 @@ Mixing_Group::~Mixing_Group() {
   if(this->total_symptomatic_infections != NULL) {
     delete this->total_symptomatic_infections;
   }
+  if(this->susceptible_roster != NULL) {
+    delete[] this->susceptible_roster;
+    delete[] this->roster_slot;
+  }
 }
 
 int Mixing_Group::enroll(Person* per) {
@@ -108,8 +115,18 @@ int Mixing_Group::enroll(Person* per) {
     this->enrollees.reserve(2 * this->get_size());
   }
   this->enrollees.push_back(per);
+  int pos = this->enrollees.size() - 1;
+  if(this->susceptible_roster != NULL) {
+    int conditions = Global::Conditions.get_number_of_conditions();
+    for(int d = 0; d < conditions; ++d) {
+      this->roster_slot[d].push_back(-1);
+      if(per->is_susceptible(d)) {
+	update_susceptible_roster(d, pos, true);
+      }
+    }
+  }
   FRED_VERBOSE(1, "Enroll person %d age %d in mixing group %d %s\n", per->get_id(), per->get_age(), this->get_id(), this->get_label());
-  return this->enrollees.size()-1;
+  return pos;
 }
 
 void Mixing_Group::unenroll(int pos) {
@@ -119,6 +136,20 @@ void Mixing_Group::unenroll(int pos) {
   }
   assert(0 <= pos && pos < size);
   Person* removed = this->enrollees[pos];
+  if(this->susceptible_roster != NULL) {
+    // drop the removed enrollee from the rosters and renumber the
+    // enrollee that moves into its position
+    int conditions = Global::Conditions.get_number_of_conditions();
+    for(int d = 0; d < conditions; ++d) {
+      update_susceptible_roster(d, pos, false);
+      int slot = this->roster_slot[d][size - 1];
+      if(pos < size - 1 && slot != -1) {
+	this->susceptible_roster[d][slot] = pos;
+      }
+      this->roster_slot[d][pos] = slot;
+      this->roster_slot[d].pop_back();
+    }
+  }
   if(pos < size-1) {
     Person* moved = this->enrollees[size - 1];
     FRED_VERBOSE(1, "UNENROLL mixing group %d %s pos = %d size = %d removed %d moved %d\n",
@@ -133,6 +164,39 @@ void Mixing_Group::unenroll(int pos) {
   FRED_VERBOSE(1, "UNENROLL mixing group %d %s size = %d\n", this->get_id(), this->get_label(), this->enrollees.size());
 }
 
+void Mixing_Group::enable_susceptible_rosters() {
+  int conditions = Global::Conditions.get_number_of_conditions();
+  this->susceptible_roster = new std::vector<int>[conditions];
+  this->roster_slot = new std::vector<int>[conditions];
+  int size = this->enrollees.size();
+  for(int d = 0; d < conditions; ++d) {
+    this->roster_slot[d].assign(size, -1);
+    for(int pos = 0; pos < size; ++pos) {
+      if(this->enrollees[pos]->is_susceptible(d)) {
+	update_susceptible_roster(d, pos, true);
+      }
+    }
+  }
+}
+
+void Mixing_Group::update_susceptible_roster(int condition_id, int pos, bool susceptible) {
+  std::vector<int> &roster = this->susceptible_roster[condition_id];
+  std::vector<int> &slot = this->roster_slot[condition_id];
+  if(susceptible) {
+    if(slot[pos] == -1) {
+      slot[pos] = roster.size();
+      roster.push_back(pos);
+    }
+  } else if(slot[pos] != -1) {
+    // swap-remove: the last roster entry takes over the freed slot
+    int last = roster.back();
+    roster[slot[pos]] = last;
+    slot[last] = slot[pos];
+    roster.pop_back();
+    slot[pos] = -1;
+  }
+}
+
 void Mixing_Group::print_infectious(int condition_id) {
   printf("INFECTIOUS in Mixing_Group %s Condition %d: ", this->get_label(), condition_id);
   int size = this->infectious_people[condition_id].size();
@@ -175,3 +239,84 @@ void Mixing_Group::record_infectious_days(int day) {
   }
   this->last_day_infectious = day;
 }
+
+void Mixing_Group::write_checkpoint() {
+  int conditions = Global::Conditions.get_number_of_conditions();
+  Checkpoint::put(this->last_update);
+  Checkpoint::put(this->first_day_infectious);
+  Checkpoint::put(this->last_day_infectious);
+  Checkpoint::put_array(this->new_infections, conditions);
+  Checkpoint::put_array(this->current_infections, conditions);
+  Checkpoint::put_array(this->new_symptomatic_infections, conditions);
+  Checkpoint::put_array(this->current_symptomatic_infections, conditions);
+  Checkpoint::put_array(this->total_infections, conditions);
+  Checkpoint::put_array(this->total_symptomatic_infections, conditions);
+  Checkpoint::put_array(this->current_case_fatalities, conditions);
+  Checkpoint::put_array(this->total_case_fatalities, conditions);
+  Checkpoint::put(this->infectious_bitset.bits);
+  Checkpoint::put(this->human_infectious_bitset.bits);
+  Checkpoint::put(this->recovered_bitset.bits);
+  Checkpoint::put(this->exposed_bitset.bits);
+
+  // the order of the enrollees matters, since contacts are drawn by position
+  int size = this->enrollees.size();
+  Checkpoint::put(size);
+  for(int i = 0; i < size; ++i) {
+    Checkpoint::put_person(this->enrollees[i]);
+  }
+  bool rosters = has_susceptible_rosters();
+  Checkpoint::put(rosters);
+  if(rosters) {
+    for(int d = 0; d < conditions; ++d) {
+      Checkpoint::put_vector(this->susceptible_roster[d]);
+      Checkpoint::put_vector(this->roster_slot[d]);
+    }
+  }
+}
+
+void Mixing_Group::read_checkpoint() {
+  int conditions = Global::Conditions.get_number_of_conditions();
+  Checkpoint::get(this->last_update);
+  Checkpoint::get(this->first_day_infectious);
+  Checkpoint::get(this->last_day_infectious);
+  Checkpoint::get_array(this->new_infections, conditions);
+  Checkpoint::get_array(this->current_infections, conditions);
+  Checkpoint::get_array(this->new_symptomatic_infections, conditions);
+  Checkpoint::get_array(this->current_symptomatic_infections, conditions);
+  Checkpoint::get_array(this->total_infections, conditions);
+  Checkpoint::get_array(this->total_symptomatic_infections, conditions);
+  Checkpoint::get_array(this->current_case_fatalities, conditions);
+  Checkpoint::get_array(this->total_case_fatalities, conditions);
+  Checkpoint::get(this->infectious_bitset.bits);
+  Checkpoint::get(this->human_infectious_bitset.bits);
+  Checkpoint::get(this->recovered_bitset.bits);
+  Checkpoint::get(this->exposed_bitset.bits);
+  for(int d = 0; d < conditions; ++d) {
+    this->infectious_people[d].clear();
+  }
+
+  int size = 0;
+  Checkpoint::get(size);
+  this->enrollees.resize(size);
+  for(int i = 0; i < size; ++i) {
+    this->enrollees[i] = Checkpoint::get_person();
+  }
+  bool rosters = false;
+  Checkpoint::get(rosters);
+  std::vector<int> roster;
+  std::vector<int> slot;
+  for(int d = 0; rosters && d < conditions; ++d) {
+    Checkpoint::get_vector(roster);
+    Checkpoint::get_vector(slot);
+    if(has_susceptible_rosters()) {
+      this->susceptible_roster[d].swap(roster);
+      this->roster_slot[d].swap(slot);
+    }
+  }
+  if(has_susceptible_rosters() && rosters == false) {
+    // the checkpoint was written without rosters
+    delete[] this->susceptible_roster;
+    delete[] this->roster_slot;
+    enable_susceptible_rosters();
+  }
+}
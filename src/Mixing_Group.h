@@ -154,9 +154,40 @@ public:
     return this->enrollees;
   }
 
+  /*
+   * Susceptible rosters: for each condition, the enrollee positions of
+   * the enrollees who are currently susceptible, kept up to date by
+   * enroll/unenroll and by Health::set_susceptibility.
+   */
+  void enable_susceptible_rosters();
+
+  bool has_susceptible_rosters() {
+    return this->susceptible_roster != NULL;
+  }
+
+  std::vector<int>* get_susceptible_roster(int condition_id) {
+    return &(this->susceptible_roster[condition_id]);
+  }
+
+  /**
+   * Add or remove an enrollee from the susceptible roster for a condition.
+   *
+   * @param condition_id an integer representation of the condition
+   * @param pos the enrollee position of the person
+   * @param susceptible true if the person is now susceptible
+   */
+  void update_susceptible_roster(int condition_id, int pos, bool susceptible);
+
   void record_infectious_days(int day);
   void print_infectious(int condition_id);
 
+  /**
+   * Save or restore the enrollees, susceptible rosters and epidemic
+   * counters (see Checkpoint).
+   */
+  virtual void write_checkpoint();
+  virtual void read_checkpoint();
+
   // infectious people
   void clear_infectious_people(int condition_id) {
     this->infectious_people[condition_id].clear();
@@ -405,6 +436,11 @@ protected:
   // lists of people
   person_vec_t  enrollees;
 
+  // per condition: enrollee positions of susceptible enrollees, and
+  // the roster slot of each enrollee (-1 if not on the roster)
+  std::vector<int>* susceptible_roster;
+  std::vector<int>* roster_slot;
+
   // track whether or not place is infectious with each condition
   fred::condition_bitset infectious_bitset;
   fred::condition_bitset human_infectious_bitset;
@@ -13,6 +13,7 @@
 */
 
 #include "Age_Map.h"
+#include "Async_Output.h"
 #include "Condition.h"
 #include "Global.h"
 #include "HIV_Natural_History.h"
@@ -620,7 +621,21 @@ double Natural_History::get_transition_period(int state) {
 }
 
 int Natural_History::get_initial_state(Person* person) {
-  int is_immune = immunity_logit->get_outcome(person);
+  double immunity_score, initialization_score;
+  get_initial_state_scores(person, &immunity_score, &initialization_score);
+  return get_initial_state(person, immunity_score, initialization_score);
+}
+
+void Natural_History::get_initial_state_scores(Person* person, double* immunity_score, double* initialization_score) {
+  *immunity_score = this->immunity_logit->get_score(person);
+  *initialization_score = 0.0;
+  if (this->initialization_logit != NULL) {
+    *initialization_score = this->initialization_logit->get_score(person);
+  }
+}
+
+int Natural_History::get_initial_state(Person* person, double immunity_score, double initialization_score) {
+  int is_immune = immunity_logit->get_outcome_from_score(immunity_score);
   if (is_immune) {
     return -1;
   }
@@ -632,7 +647,7 @@ int Natural_History::get_initial_state(Person* person) {
     return get_next_state(0, this->initialization_probability);
   }
   if (strcmp(this->initialization_model, "logit")==0) {
-    return initialization_logit->get_outcome(person);
+    return initialization_logit->get_outcome_from_score(initialization_score);
   }
   assert(strcmp("Help! No initialization model","")==0);
   return -1;
@@ -729,7 +744,7 @@ bool Natural_History::is_confined_to_household(Person *person) {
   int state = person->get_health_state(this->id);
   /*
   if (Global::Enable_Health_Records) {
-    fprintf(Global::HealthRecordfp,
+    Async_Output::print(Global::HealthRecordfp,
 	    "HEALTH RECORD: is_confined person %d COND %s STATE %s ",
 	    person->get_id(), get_name(),
 	    get_state_name(state).c_str());
@@ -741,7 +756,7 @@ bool Natural_History::is_confined_to_household(Person *person) {
 bool Natural_History::is_confined_to_household(int state) {
   /*
   if (Global::Enable_Health_Records) {
-    fprintf(Global::HealthRecordfp,
+    Async_Output::print(Global::HealthRecordfp,
 	    " prob_household_confinement %lf ",
 	    this->probability_of_household_confinement[state]);
   }
@@ -750,7 +765,7 @@ bool Natural_History::is_confined_to_household(int state) {
     double r = Random::draw_random();
     /*
     if (Global::Enable_Health_Records) {
-      fprintf(Global::HealthRecordfp,
+      Async_Output::print(Global::HealthRecordfp,
 	      " r %lf\n",
 	      r);
     }
@@ -760,7 +775,7 @@ bool Natural_History::is_confined_to_household(int state) {
   else {
     /*
     if (Global::Enable_Health_Records) {
-      fprintf(Global::HealthRecordfp,
+      Async_Output::print(Global::HealthRecordfp,
 	      "\n");
     }
     */
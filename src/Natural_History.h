@@ -75,6 +75,17 @@ public:
 
   int get_initial_state(Person* person);
 
+  /**
+   * The logit scores get_initial_state() needs for a person. This reads
+   * only the person, so it may be called from parallel code.
+   */
+  void get_initial_state_scores(Person* person, double* immunity_score, double* initialization_score);
+
+  /**
+   * get_initial_state() given the person's scores; draws the random outcomes.
+   */
+  int get_initial_state(Person* person, double immunity_score, double initialization_score);
+
   int get_next_state(Person* person, int state);
 
   int get_next_state(int state, double* transition_prob);
@@ -28,6 +28,7 @@
 //Private static variables that will be set by parameter lookups
 double Neighborhood::contacts_per_day = 0.0;
 double Neighborhood::same_age_bias = 0.0;
+std::vector<double> Neighborhood::age_bias;
 double** Neighborhood::prob_transmission_per_contact = NULL;
 double Neighborhood::weekend_contact_rate = 0.0;
 
@@ -40,6 +41,7 @@ Neighborhood::Neighborhood(const char* lab, char _subtype, fred::geo lon, fred::
 void Neighborhood::get_parameters() {
   Params::get_param("neighborhood_contacts", &Neighborhood::contacts_per_day);
   Params::get_param("neighborhood_same_age_bias", &Neighborhood::same_age_bias);
+  Place::setup_age_bias_table(Neighborhood::same_age_bias, Neighborhood::age_bias);
   int n = Params::get_param_matrix((char *)"neighborhood_trans_per_contact", &Neighborhood::prob_transmission_per_contact);
   if(Global::Verbose > 1) {
     printf("\nNeighborhood_contact_prob:\n");
@@ -99,33 +101,3 @@ void Neighborhood::get_parameters() {
   }
 }
 
-int Neighborhood::get_group(int condition, Person* per) {
-  int age = per->get_age();
-  if(age < Global::ADULT_AGE) {
-    return 0;
-  } else {
-    return 1;
-  }
-}
-
-double Neighborhood::get_transmission_probability(int condition, Person* i, Person* s) {
-  double age_i = i->get_real_age();
-  double age_s = s->get_real_age();
-  double diff = fabs(age_i - age_s);
-  double prob = exp(-Neighborhood::same_age_bias * diff);
-  return prob;
-}
-
-double Neighborhood::get_transmission_prob(int condition, Person* i, Person* s) {
-  // i = infected agent
-  // s = susceptible agent
-  int row = get_group(condition, i);
-  int col = get_group(condition, s);
-  double tr_pr = Neighborhood::prob_transmission_per_contact[row][col];
-  return tr_pr;
-}
-
-double Neighborhood::get_contacts_per_day(int condition) {
-  return Neighborhood::contacts_per_day;
-}
-
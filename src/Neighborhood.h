@@ -48,9 +48,23 @@ public:
   /**
    * @see Place::get_group(int condition, Person* per)
    */
-  int get_group(int condition, Person* per);
+  int get_group(int condition, Person* per) {
+    int age = per->get_age();
+    if(age < Global::ADULT_AGE) {
+      return 0;
+    } else {
+      return 1;
+    }
+  }
 
-  double get_transmission_probability(int condition, Person* i, Person* s);
+  double get_transmission_probability(int condition, Person* i, Person* s) {
+    // the difference in real age is the difference in birthdays
+    int days = abs(i->get_birthday_sim_day() - s->get_birthday_sim_day());
+    if(days < (int) Neighborhood::age_bias.size()) {
+      return Neighborhood::age_bias[days];
+    }
+    return exp(-Neighborhood::same_age_bias * (days / 365.25));
+  }
 
   /**
    * @see Place::get_transmission_prob(int condition, Person* i, Person* s)
@@ -60,7 +74,24 @@ public:
    * The static array <code>Neighborhood_contact_prob</code> will be filled with values from the parameter
    * file for the key <code>neighborhood_prob[]</code>.
    */
-  double get_transmission_prob(int condition, Person* i, Person* s);
+  double get_transmission_prob(int condition, Person* i, Person* s) {
+    // i = infected agent
+    // s = susceptible agent
+    int row = Neighborhood::get_group(condition, i);
+    int col = Neighborhood::get_group(condition, s);
+    double tr_pr = Neighborhood::prob_transmission_per_contact[row][col];
+    return tr_pr;
+  }
+
+  /**
+   * The transmission probability for an infector in the given group (row
+   * of the contact matrix), for callers that look up many susceptibles
+   * with the same infector.
+   */
+  double get_transmission_prob_for_group(int condition, int row, Person* s) {
+    int col = Neighborhood::get_group(condition, s);
+    return Neighborhood::prob_transmission_per_contact[row][col];
+  }
 
   /**
    * @see Place::get_contacts_per_day(int condition)
@@ -70,7 +101,9 @@ public:
    * The static array <code>Neighborhood_contacts_per_day</code> will be filled with values from the parameter
    * file for the key <code>neighborhood_contacts[]</code>.
    */
-  double get_contacts_per_day(int condition);
+  double get_contacts_per_day(int condition) {
+    return Neighborhood::contacts_per_day;
+  }
 
   /**
    * Determine if the neighborhood should be open. It is dependent on the condition and simulation day.
@@ -95,6 +128,7 @@ public:
 private:
   static double contacts_per_day;
   static double same_age_bias;
+  static std::vector<double> age_bias; // indexed by the days between birthdays
   static double** prob_transmission_per_contact;
   static double weekend_contact_rate;
 };
@@ -323,6 +323,7 @@ vector<Place *> Neighborhood_Layer::get_households_by_distance(fred::geo lat, fr
   c2 = (c2 <= this->cols - 1) ? c2 : this->cols - 1;
 
   vector<Place *> households; // store all households in patches ovelapping the radius
+  double radius2 = radius_in_km * radius_in_km;
 
   for(int r = r1; r <= r2; r++) {
     for(int c = c1; c <= c2; c++) {
@@ -330,11 +331,7 @@ vector<Place *> Neighborhood_Layer::get_households_by_distance(fred::geo lat, fr
       int number_of_households = p->get_number_of_households();
       for (int i = 0; i < number_of_households; i++) {
 	Place * house = p->get_household(i);
-        double hlat =  house->get_latitude();
-        double hlon = house->get_longitude();
-        double hx = Geo::get_x(hlon);
-        double hy = Geo::get_y(hlat);
-        if(sqrt((px - hx) * (px - hx) + (py - hy) * (py - hy)) <= radius_in_km) {
+        if(Geo::xy_distance_squared(px, py, house->get_x(), house->get_y()) <= radius2) {
           households.push_back(house);
         }
       }
@@ -349,10 +346,6 @@ static bool compare_pair( const pair<double,int>& p1, const pair<double,int>& p2
 }
 
 void Neighborhood_Layer::setup_gravity_model() {
-  int tmp_offset[256*256];
-  double tmp_prob[256*256];
-  int mark[256*256];
-  int count = 0;
 
   // print_distances();  // DEBUGGING
 
@@ -371,6 +364,12 @@ void Neighborhood_Layer::setup_gravity_model() {
   max_offset = max_distance / this->patch_size;
   assert(max_offset < 128);
 
+  // each patch's model depends only on the grid, so the rows are set up
+  // in parallel, each thread with its own list of destinations
+#pragma omp parallel
+  {
+  vector < pair <double,int> > sort_pair;
+#pragma omp for schedule(dynamic)
   for(int i = 0; i < rows; i++) {
     for(int j = 0; j < cols; j++) {
       // set up gravity model for grid[i][j];
@@ -381,7 +380,7 @@ void Neighborhood_Layer::setup_gravity_model() {
       int pop_src = patch->get_popsize();
       double mean_household_income_src = patch->get_mean_household_income();
       if (pop_src == 0) continue;
-      count = 0;
+      sort_pair.clear();
       for(int ii = i - max_offset; ii < rows && ii <= i + max_offset; ii++) {
 	if (ii < 0) continue;
 	for(int jj = j - max_offset; jj < cols && jj <= j + max_offset; jj++) {
@@ -403,8 +402,7 @@ void Neighborhood_Layer::setup_gravity_model() {
 	  // if (income_similarity > 1.0) { income_similarity = 1.0 / income_similarity; }
 	  // gravity = ...;
 
-	  tmp_offset[count] = off;
-	  tmp_prob[count++] = gravity;
+	  sort_pair.push_back(pair <double,int> (gravity, off));
 	  // printf("SETUP row %3d col %3d pop %5d count %4d ", i,j,pop_src,count);
 	  // printf("offset %5d off_i %3d off_j %3d ii %3d jj %3d ",off,i+max_offset-(off/256),j+max_offset-(off%256),ii,jj);
 	  // printf("dist %.2f pop_dest %5d gravity %7.3f\n",dist,pop_dest,gravity);
@@ -413,45 +411,32 @@ void Neighborhood_Layer::setup_gravity_model() {
       // printf("\n");
 
       // sort by gravity value
-      sort_pair.clear();
-      for (int k = 0; k < count; k++) {
-	sort_pair.push_back(pair <double,int> (tmp_prob[k], tmp_offset[k]));
-      }
       std::sort(sort_pair.begin(), sort_pair.end(), compare_pair);
 
       // keep at most largest max_destinations
+      int count = sort_pair.size();
       if (count > max_destinations) count = max_destinations;
-      for (int k = 0; k < count; k++) {
-	tmp_prob[k] = sort_pair[k].first;
-	tmp_offset[k] = sort_pair[k].second;
-      }
-      sort_pair.clear();
 
       // transform gravity values into a prob distribution
       double total = 0.0;
       for (int k = 0; k < count; k++) {
-	total += tmp_prob[k];
-      }
-      for (int k = 0; k < count; k++) {
-	tmp_prob[k] /= total;
+	total += sort_pair[k].first;
       }
 
-      // convert to cdf
-      for (int k = 1; k < count; k++) {
-	tmp_prob[k] += tmp_prob[k-1];
-      }
-
-      // store gravity prob and offsets for this patch
+      // store the cdf and offsets for this patch
       gravity_cdf[i][j].reserve(count);
       gravity_cdf[i][j].clear();
       offset[i][j].reserve(count);
       offset[i][j].clear();
+      double cdf = 0.0;
       for (int k = 0; k < count; k++) {
-	gravity_cdf[i][j].push_back(tmp_prob[k]);
-	offset[i][j].push_back(tmp_offset[k]);
+	cdf += sort_pair[k].first / total;
+	gravity_cdf[i][j].push_back(cdf);
+	offset[i][j].push_back(sort_pair[k].second);
       }
     }
-  }  
+  }
+  }
   // this->print_gravity_model();
 }
 
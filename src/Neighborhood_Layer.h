@@ -131,7 +131,6 @@ protected:
   offset_t ** offset;
   gravity_cdf_t ** gravity_cdf;
   int max_offset;
-  vector < pair <double,int> >sort_pair;
 
   // runtime parameters for neighborhood gravity model
   bool Enable_neighborhood_gravity_model;
@@ -95,19 +95,6 @@ int Office::get_container_size() {
   return this->workplace->get_size();
 }
 
-double Office::get_transmission_prob(int condition, Person* i, Person* s) {
-  // i = infected agent
-  // s = susceptible agent
-  int row = get_group(condition, i);
-  int col = get_group(condition, s);
-  double tr_pr = Office::prob_transmission_per_contact[row][col];
-  return tr_pr;
-}
-
-double Office::get_contacts_per_day(int condition) {
-  return Office::contacts_per_day;
-}
-
 void Office::set_workplace(Workplace* _workplace) {
   this->workplace = _workplace;
   set_census_tract_fips(this->workplace->get_census_tract_fips());
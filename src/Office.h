@@ -65,7 +65,24 @@ public:
    * The static array <code>Office_contact_prob</code> will be filled with values from the parameter
    * file for the key <code>office_prob[]</code>.
    */
-  double get_transmission_prob(int condition, Person* i, Person* s);
+  double get_transmission_prob(int condition, Person* i, Person* s) {
+    // i = infected agent
+    // s = susceptible agent
+    int row = Office::get_group(condition, i);
+    int col = Office::get_group(condition, s);
+    double tr_pr = Office::prob_transmission_per_contact[row][col];
+    return tr_pr;
+  }
+
+  /**
+   * The transmission probability for an infector in the given group (row
+   * of the contact matrix), for callers that look up many susceptibles
+   * with the same infector.
+   */
+  double get_transmission_prob_for_group(int condition, int row, Person* s) {
+    int col = Office::get_group(condition, s);
+    return Office::prob_transmission_per_contact[row][col];
+  }
 
   /**
    * @see Place::get_contacts_per_day(int condition)
@@ -75,7 +92,9 @@ public:
    * The static array <code>Office_contacts_per_day</code> will be filled with values from the parameter
    * file for the key <code>office_contacts[]</code>.
    */
-  double get_contacts_per_day(int condition);
+  double get_contacts_per_day(int condition) {
+    return Office::contacts_per_day;
+  }
 
   /**
    * Determine if the office should be open. It is dependent on the condition and simulation day.
@@ -28,8 +28,9 @@
 using namespace std;
 
 int Params::abort_on_failure = 1;
-std::vector<std::string> Params::param_names;
-std::vector<std::string> Params::param_values;
+std::vector<Params::param_t> Params::params;
+std::unordered_map<std::string, int> Params::param_index;
+std::string Params::defaults_file;
 
 void Params::read_psa_parameter(char* paramfile, int line_number) {
   /*
@@ -141,9 +142,21 @@ void Params::read_parameter_file(char* paramfile) {
             printf("READ_PARAMS: %s = %s\n", name_str.c_str(), value_str.c_str());
           }
 	  if (!name_str.empty() && !value_str.empty()) {
-	    param_names.push_back(name_str);
-	    param_values.push_back(value_str);
-	    printf("READ_PARAMS STRING: %s = |%s|\n", param_names.back().c_str(), param_values.back().c_str());
+	    // a later file overrides an earlier one, and within a file
+	    // the last value wins
+	    std::unordered_map<std::string, int>::iterator itr = Params::param_index.find(name_str);
+	    if(itr == Params::param_index.end()) {
+	      Params::param_index[name_str] = Params::params.size();
+	      Params::params.push_back(param_t());
+	      Params::params.back().name = name_str;
+	      itr = Params::param_index.find(name_str);
+	    } else if(Params::params[itr->second].file == paramfile) {
+	      fprintf(stdout, "PARAMS: WARNING: %s is set more than once in %s\n", name, paramfile);
+	    }
+	    param_t* param = &(Params::params[itr->second]);
+	    param->value = value_str;
+	    param->file = paramfile;
+	    printf("READ_PARAMS STRING: %s = |%s|\n", param->name.c_str(), param->value.c_str());
 	  }
         } else {
           Utils::fred_abort("Bad format in params file %s on line starting with %s\n",
@@ -164,11 +177,19 @@ void Params::read_parameter_file(char* paramfile) {
 int Params::read_parameters(char* paramfile) {
   char filename[FRED_STRING_SIZE];
   
-  param_names.clear();
-  param_values.clear();
+  Params::params.clear();
+  Params::param_index.clear();
   strcpy(filename, "$FRED_HOME/data/defaults");
   read_parameter_file(filename);
+  // (the file name now has $FRED_HOME expanded)
+  Params::defaults_file = filename;
   read_parameter_file(paramfile);
+
+  // parse every value once, so that lookups only copy
+  for(int i = 0; i < (int) Params::params.size(); ++i) {
+    parse_value(&(Params::params[i]));
+  }
+
   Params::get_param("psa_method", Global::PSA_Method);
   Params::get_param("psa_list_file", Global::PSA_List_File);
   Params::get_param("psa_sample_size", &Global::PSA_Sample_Size);
@@ -192,178 +213,147 @@ int Params::read_parameters(char* paramfile) {
   }
   */
   if(Global::Debug > 1) {
-    for(int i = 0; i < Params::param_names.size(); ++i) {
-      printf("READ_PARAMS: %s = %s\n", Params::param_names[i].c_str(), Params::param_values[i].c_str());
+    for(int i = 0; i < (int) Params::params.size(); ++i) {
+      printf("READ_PARAMS: %s = %s\n", Params::params[i].name.c_str(), Params::params[i].value.c_str());
     }
   }
-  return Params::param_names.size();
+  return Params::params.size();
 }
 
-int Params::get_param(string name, int* p) {
-  int found = 0;
-  int n = Params::param_names.size();
-  for(int i = 0; i < n; ++i) {
-    if(Params::param_names[i] == name) {
-      if(sscanf(Params::param_values[i].c_str(), "%d", p)) {
-        found = 1;
+void Params::parse_value(param_t* param) {
+  const char* value = param->value.c_str();
+  param->used = false;
+  param->has_int = (sscanf(value, "%d", &param->int_value) == 1);
+  param->has_double = (sscanf(value, "%lf", &param->double_value) == 1);
+
+  param->vector_value.clear();
+  param->vector_state = param_t::VECTOR_BAD;
+  if(param->has_int) {
+    char str[FRED_STRING_SIZE];
+    strncpy(str, value, FRED_STRING_SIZE - 1);
+    str[FRED_STRING_SIZE - 1] = '\0';
+    char* pch = strtok(str, " ");
+    int n = param->int_value;
+    param->vector_state = param_t::VECTOR_OK;
+    for(int i = 0; i < n; ++i) {
+      pch = strtok(NULL, " ");
+      if(pch == NULL) {
+	param->vector_state = param_t::VECTOR_SHORT;
+	break;
       }
+      double v;
+      sscanf(pch, "%lf", &v);
+      param->vector_value.push_back(v);
     }
   }
-  if(found) {
-    if (Global::Debug > 0) {
-      printf("PARAMS: %s = %d\n", name.c_str(), *p);
-      fflush( stdout);
-    }
-    return 1;
-  } else {
-    if(Global::Debug > 0) {
-      printf("PARAMS: %s not found\n", name.c_str());
-      fflush(stdout);
-    }
-    if (Params::abort_on_failure) {
-      Utils::fred_abort("PARAMS: %s not found\n", name.c_str()); 
-    }
+}
+
+Params::param_t* Params::find_param(const string &name) {
+  std::unordered_map<std::string, int>::const_iterator itr = Params::param_index.find(name);
+  if(itr == Params::param_index.end()) {
+    return NULL;
+  }
+  param_t* param = &(Params::params[itr->second]);
+  param->used = true;
+  return param;
+}
+
+int Params::not_found(const string &name) {
+  if(Global::Debug > 0) {
+    printf("PARAMS: %s not found\n", name.c_str());
+    fflush(stdout);
+  }
+  if (Params::abort_on_failure) {
+    Utils::fred_abort("PARAMS: %s not found\n", name.c_str()); 
   }
   return 0;
 }
 
-int Params::get_param(string name, unsigned long* p) {
-  int found = 0;
-  int n = Params::param_names.size();
-  for(int i = 0; i < n; ++i) {
-    if(Params::param_names[i] == name) {
-      if(sscanf(Params::param_values[i].c_str(), "%lu", p)) {
-        found = 1;
-      }
+void Params::report_unused_parameters() {
+  for(int i = 0; i < (int) Params::params.size(); ++i) {
+    param_t* param = &(Params::params[i]);
+    if(param->used == false && param->file != Params::defaults_file) {
+      fprintf(Global::Statusfp, "PARAMS: %s = %s in %s was never used\n",
+	      param->name.c_str(), param->value.c_str(), param->file.c_str());
     }
   }
-  if(found) {
-    if(Global::Debug > 0) {
-      printf("PARAMS: %s = %lu\n", name.c_str(), *p);
-      fflush( stdout);
-    }
-    return 1;
-  } else {
-    if(Global::Debug > 0) {
-      printf("PARAMS: %s not found\n", name.c_str());
-      fflush( stdout);
-    }
-    if (Params::abort_on_failure) {
-      Utils::fred_abort("PARAMS: %s not found\n", name.c_str()); 
-    }
+  fflush(Global::Statusfp);
+}
+
+int Params::get_param(string name, int* p) {
+  param_t* param = find_param(name);
+  if(param == NULL || param->has_int == false) {
+    return not_found(name);
   }
-  return 0;
+  *p = param->int_value;
+  if (Global::Debug > 0) {
+    printf("PARAMS: %s = %d\n", name.c_str(), *p);
+    fflush( stdout);
+  }
+  return 1;
+}
+
+int Params::get_param(string name, unsigned long* p) {
+  param_t* param = find_param(name);
+  if(param == NULL || sscanf(param->value.c_str(), "%lu", p) != 1) {
+    return not_found(name);
+  }
+  if(Global::Debug > 0) {
+    printf("PARAMS: %s = %lu\n", name.c_str(), *p);
+    fflush( stdout);
+  }
+  return 1;
 }
 
 int Params::get_param(string name, double* p) {
-  int found = 0;
-  int n = Params::param_names.size();
-  for(int i = 0; i < n; ++i) {
-    if(Params::param_names[i] == name) {
-      if(sscanf(Params::param_values[i].c_str(), "%lf", p)) {
-        found = 1;
-      }
-    }
+  param_t* param = find_param(name);
+  if(param == NULL || param->has_double == false) {
+    return not_found(name);
   }
-  if(found) {
-    if(Global::Debug > 0) {
-      printf("PARAMS: %s = %f\n", name.c_str(), *p);
-      fflush( stdout);
-    }
-    return 1;
-  } else {
-    if(Global::Debug > 0) {
-      printf("PARAMS: %s not found\n", name.c_str());
-      fflush( stdout);
-    }
-    if (Params::abort_on_failure) {
-      Utils::fred_abort("PARAMS: %s not found\n", name.c_str()); 
-    }
+  *p = param->double_value;
+  if(Global::Debug > 0) {
+    printf("PARAMS: %s = %f\n", name.c_str(), *p);
+    fflush( stdout);
   }
-  return 0;
+  return 1;
 }
 
 int Params::get_param(string name, float* p) {
-  int found = 0;
-  int n = Params::param_names.size();
-  for(int i = 0; i < n; ++i) {
-    if(Params::param_names[i] == name) {
-      if(sscanf(Params::param_values[i].c_str(), "%f", p)) {
-        found = 1;
-      }
-    }
+  param_t* param = find_param(name);
+  if(param == NULL || sscanf(param->value.c_str(), "%f", p) != 1) {
+    return not_found(name);
   }
-  if(found) {
-    if(Global::Debug > 0) {
-      printf("PARAMS: %s = %f\n", name.c_str(), *p);
-      fflush( stdout);
-    }
-    return 1;
-  } else {
-    if(Global::Debug > 0) {
-      printf("PARAMS: %s not found\n", name.c_str());
-      fflush( stdout);
-    }
-    if (Params::abort_on_failure) {
-      Utils::fred_abort("PARAMS: %s not found\n", name.c_str());
-    }
+  if(Global::Debug > 0) {
+    printf("PARAMS: %s = %f\n", name.c_str(), *p);
+    fflush( stdout);
   }
-  return 0;
+  return 1;
 }
 
 int Params::get_param(string name, string &p){
-  int found = 0;
-  int n = Params::param_names.size();
-  for(int i = 0; i < n; ++i) {
-    if(Params::param_names[i] == name) {
-      p = Params::param_values[i];
-      found = 1;
-    }
+  param_t* param = find_param(name);
+  if(param == NULL) {
+    return not_found(name);
   }
-  if(found) {
-    if(Global::Debug > 0) {
-      printf("PARAMS: %s = %s\n", name.c_str(), p.c_str());
-      fflush( stdout);
-    }
-    return 1;
-  } else {
-    if(Global::Debug > 0) {
-      printf("PARAMS: %s not found\n", name.c_str());
-      fflush(stdout);
-    }
-    if (Params::abort_on_failure) {
-      Utils::fred_abort("PARAMS: %s not found\n", name.c_str()); 
-    }
+  p = param->value;
+  if(Global::Debug > 0) {
+    printf("PARAMS: %s = %s\n", name.c_str(), p.c_str());
+    fflush( stdout);
   }
-  return 0;
+  return 1;
 }
 
 int Params::get_param(string name, char* p) {
-  int found = 0;
-  int n = Params::param_names.size();
-  for(int i = 0; i < n; ++i) {
-    if(Params::param_names[i] == name) {
-      if(strcpy(p, Params::param_values[i].c_str())) {
-        found = 1;
-      }
-    }
+  param_t* param = find_param(name);
+  if(param == NULL) {
+    return not_found(name);
   }
-  if(found) {
-    if(Global::Debug > 0) {
-      printf("PARAMS: %s = %s\n", name.c_str(), p);
-      fflush( stdout);
-    }
-    return 1;
-  } else {
-    if(Global::Debug > 0) {
-      printf("PARAMS: %s not found\n", name.c_str());
-      fflush( stdout);
-    }
-    if (Params::abort_on_failure) {
-      Utils::fred_abort("PARAMS: %s not found\n", name.c_str()); 
-    }
+  strcpy(p, param->value.c_str());
+  if(Global::Debug > 0) {
+    printf("PARAMS: %s = %s\n", name.c_str(), p);
+    fflush( stdout);
   }
-  return 0;
+  return 1;
 }
 
 int Params::get_param_vector(char* name, vector<int> &p){
@@ -389,47 +379,32 @@ int Params::get_param_vector(char* name, vector<int> &p){
 }
 
 int Params::get_param_vector(char* s, vector<double> &p){
-  char str[FRED_STRING_SIZE];
-  int n = Params::get_param(s, str);
-  if (n == 0) {
-    return n;
-  }
-  char* pch = strtok(str," ");
-  if (sscanf(pch, "%d", &n) == 1) {
-    for (int i = 0; i < n; i++) {
-      double v;
-      pch = strtok (NULL, " ");
-      if(pch == NULL) {
-        Utils::fred_abort("Help! bad param vector: %s\n", s); 
-      }
-      sscanf(pch, "%lf", &v);
-      p.push_back(v);
-    }
+  param_t* param = find_param(s);
+  if(param == NULL) {
+    return not_found(s);
   }
-  else {
+  if(param->vector_state == param_t::VECTOR_BAD) {
     Utils::fred_abort("Incorrect format for vector %s\n", s); 
   }
-  return n;
+  if(param->vector_state == param_t::VECTOR_SHORT) {
+    Utils::fred_abort("Help! bad param vector: %s\n", s); 
+  }
+  p.insert(p.end(), param->vector_value.begin(), param->vector_value.end());
+  return param->int_value;
 }
 
 int Params::get_param_vector(char* s, double* p) {
-  char str[FRED_STRING_SIZE];
-  int n;
-  char* pch;
-  Params::get_param(s, str);
-  pch = strtok(str, " ");
-  if(sscanf(pch, "%d", &n) == 1) {
-    for(int i = 0; i < n; ++i) {
-      pch = strtok(NULL, " ");
-      if(pch == NULL) {
-        Utils::fred_abort("Help! bad param vector: %s\n", s);
-      }
-      sscanf(pch, "%lf", &p[i]);
-    }
-  } else {
+  param_t* param = find_param(s);
+  if(param == NULL || param->vector_state == param_t::VECTOR_BAD) {
     Utils::fred_abort("PARAMS: %s not found\n", s); 
   }
-  return n;
+  if(param->vector_state == param_t::VECTOR_SHORT) {
+    Utils::fred_abort("Help! bad param vector: %s\n", s);
+  }
+  for(int i = 0; i < (int) param->vector_value.size(); ++i) {
+    p[i] = param->vector_value[i];
+  }
+  return param->int_value;
 }
 
 int Params::get_param_vector(char* s, int* p) {
@@ -528,10 +503,5 @@ int Params::get_param_matrix(char* s, double*** p) {
 
 
 bool Params::does_param_exist(string name) {
-  bool found = false;
-  int n = param_names.size();
-  for(int i = 0; i < n && !found; ++i) {
-    found = (name == param_names[i]);
-  }
-  return found;
+  return Params::param_index.find(name) != Params::param_index.end();
 }
@@ -25,6 +25,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <unordered_map>
 
 using namespace std;
 
@@ -58,6 +59,13 @@ public:
    */
   static int read_parameters(char* paramfile);
 
+  /**
+   * Print to the status file every parameter set outside of the
+   * defaults file that the run never looked up (usually a misspelled
+   * name).
+   */
+  static void report_unused_parameters();
+
   /**
    * @param s the parameter name
    * @param p a pointer to the int that will be set
@@ -213,8 +221,32 @@ public:
   }
 
 private:
-  static std::vector<std::string> param_names;
-  static std::vector<std::string> param_values;
+
+  /**
+   * A parameter and its value, parsed once when the parameter files
+   * have been read.
+   */
+  typedef struct param {
+    std::string name;
+    std::string value;
+    std::string file;	// the file that last set the value
+    bool used;
+    bool has_int;
+    bool has_double;
+    int int_value;
+    double double_value;
+    // the value as a vector: a count followed by that many numbers
+    enum { VECTOR_OK, VECTOR_SHORT, VECTOR_BAD } vector_state;
+    std::vector<double> vector_value;
+  } param_t;
+
+  static param_t* find_param(const string &name);
+  static void parse_value(param_t* param);
+  static int not_found(const string &name);
+
+  static std::vector<param_t> params;
+  static std::string defaults_file;
+  static std::unordered_map<std::string, int> param_index;
   static int abort_on_failure;
 };
 
@@ -0,0 +1,440 @@
+/*
+  This file is part of the FRED system.
+
+  Copyright (c) 2013-2016, University of Pittsburgh, John Grefenstette,
+  David Galloway, Mary Krauland, Michael Lann, and Donald Burke.
+
+  Based in part on FRED Version 2.9, created in 2010-2013 by
+  John Grefenstette, Shawn Brown, Roni Rosenfield, Alona Fyshe, David
+  Galloway, Nathan Stone, Jay DePasse, Anuroop Sriram, and Donald Burke.
+
+  Licensed under the BSD 3-Clause license.  See the file "LICENSE" for
+  more information.
+*/
+
+//
+//
+// File: Partition.cc
+//
+
+#include <math.h>
+#include <sstream>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "Condition.h"
+#include "Condition_List.h"
+#include "Epidemic.h"
+#include "Params.h"
+#include "Partition.h"
+#include "Person.h"
+#include "Place.h"
+#include "Place_List.h"
+#include "Random.h"
+#include "Utils.h"
+
+int Partition::number_of_partitions = 1;
+int Partition::partition_id = 0;
+char Partition::partition_directory[FRED_STRING_SIZE];
+int Partition::timeout = 600;
+
+std::vector<Partition::remote_place_t> Partition::remote_places;
+std::map<std::string, int> Partition::remote_place_index;
+std::multimap<Person*, int> Partition::visitor_places;
+
+std::vector<Place*> Partition::hosted_places;
+std::vector<int> Partition::hosted_visitors;
+std::vector< std::map<int, int> > Partition::hosted_index;
+
+int Partition::remote_exposures = 0;
+int Partition::ghost_exposures = 0;
+int Partition::imported_case_exchanges = 0;
+
+void Partition::get_parameters() {
+  Params::get_param("number_of_partitions", &Partition::number_of_partitions);
+  Params::get_param("partition_id", &Partition::partition_id);
+  Params::get_param("partition_directory", Partition::partition_directory);
+  Params::get_param("partition_timeout", &Partition::timeout);
+  if(Partition::is_enabled()) {
+    if(Partition::partition_id < 0 || Partition::number_of_partitions <= Partition::partition_id) {
+      Utils::fred_abort("partition_id %d is not in 0..%d\n", Partition::partition_id, Partition::number_of_partitions - 1);
+    }
+    if(strcmp(Partition::partition_directory, "none") == 0) {
+      Utils::fred_abort("partitioned runs need a partition_directory\n");
+    }
+  }
+}
+
+void Partition::add_remote_visit(Person* person, char type, const char* label) {
+  std::string key = std::string(1, type) + label;
+  int k;
+  std::map<std::string, int>::iterator itr = Partition::remote_place_index.find(key);
+  if(itr == Partition::remote_place_index.end()) {
+    k = Partition::remote_places.size();
+    remote_place_t remote_place;
+    remote_place.type = type;
+    remote_place.label = label;
+    remote_place.partition = -1;
+    Partition::remote_places.push_back(remote_place);
+    Partition::remote_place_index[key] = k;
+  } else {
+    k = itr->second;
+  }
+  Partition::remote_places[k].visitors.push_back(person);
+  if(type == 'S') {
+    person->set_remote_school();
+  } else {
+    person->set_remote_workplace();
+  }
+  Partition::visitor_places.insert(std::make_pair(person, k));
+}
+
+void Partition::setup() {
+  if(Partition::is_enabled() == false) {
+    return;
+  }
+  int partitions = Partition::number_of_partitions;
+  char line[FRED_STRING_SIZE];
+
+  // tell every other partition which remote places our residents visit
+  std::string labels;
+  for(int k = 0; k < (int) Partition::remote_places.size(); ++k) {
+    remote_place_t &remote_place = Partition::remote_places[k];
+    Utils::fred_snprintf(line, sizeof(line), "%c %s %d\n", remote_place.type, remote_place.label.c_str(), (int) remote_place.visitors.size());
+    labels += line;
+  }
+  for(int q = 0; q < partitions; ++q) {
+    if(q != Partition::partition_id) {
+      Partition::send(q, "labels", labels);
+    }
+  }
+
+  // claim the places we hold
+  std::map<Place*, int> hosted;
+  Partition::hosted_index.assign(partitions, std::map<int, int>());
+  for(int q = 0; q < partitions; ++q) {
+    if(q == Partition::partition_id) {
+      continue;
+    }
+    std::istringstream message(Partition::receive(q, "labels"));
+    std::string claimed;
+    char type;
+    std::string label;
+    int visitors;
+    for(int k = 0; message >> type >> label >> visitors; ++k) {
+      Place* place = NULL;
+      if(type == 'S') {
+        place = Global::Places.get_school_from_label(label.c_str());
+      } else {
+        place = Global::Places.get_workplace_from_label(label.c_str());
+      }
+      if(place == NULL) {
+        continue;
+      }
+      std::map<Place*, int>::iterator itr = hosted.find(place);
+      int h;
+      if(itr == hosted.end()) {
+        h = Partition::hosted_places.size();
+        Partition::hosted_places.push_back(place);
+        Partition::hosted_visitors.push_back(0);
+        hosted[place] = h;
+      } else {
+        h = itr->second;
+      }
+      Partition::hosted_visitors[h] += visitors;
+      Partition::hosted_index[q][k] = h;
+      Utils::fred_snprintf(line, sizeof(line), "%d\n", k);
+      claimed += line;
+    }
+    Partition::send(q, "hosts", claimed);
+  }
+
+  // learn which partition holds each of our remote places
+  for(int q = 0; q < partitions; ++q) {
+    if(q == Partition::partition_id) {
+      continue;
+    }
+    std::istringstream message(Partition::receive(q, "hosts"));
+    int k;
+    while(message >> k) {
+      if(0 <= k && k < (int) Partition::remote_places.size() && Partition::remote_places[k].partition < 0) {
+        Partition::remote_places[k].partition = q;
+      }
+    }
+  }
+
+  int visitors = 0;
+  int unclaimed = 0;
+  for(int k = 0; k < (int) Partition::remote_places.size(); ++k) {
+    visitors += Partition::remote_places[k].visitors.size();
+    if(Partition::remote_places[k].partition < 0) {
+      unclaimed++;
+    }
+  }
+  int ghosts = 0;
+  for(int h = 0; h < (int) Partition::hosted_visitors.size(); ++h) {
+    ghosts += Partition::hosted_visitors[h];
+  }
+  fprintf(Global::Statusfp, "partition %d of %d: %d visitors to %d remote places (%d held by no partition), %d visitors from other partitions at %d places\n",
+	  Partition::partition_id, partitions, visitors, (int) Partition::remote_places.size(), unclaimed,
+	  ghosts, (int) Partition::hosted_places.size());
+  fflush(Global::Statusfp);
+}
+
+void Partition::exchange_visits(int day, int condition_id) {
+  int partitions = Partition::number_of_partitions;
+  std::vector<std::string> message(partitions);
+  char line[FRED_STRING_SIZE];
+
+  // infectious residents visiting places held by other partitions
+  for(int k = 0; k < (int) Partition::remote_places.size(); ++k) {
+    remote_place_t &remote_place = Partition::remote_places[k];
+    if(remote_place.partition < 0) {
+      continue;
+    }
+    double infectivity = 0.0;
+    for(int i = 0; i < (int) remote_place.visitors.size(); ++i) {
+      Person* person = remote_place.visitors[i];
+      if(person->is_infectious(condition_id) && Partition::is_visiting(person, remote_place.type, day)) {
+        infectivity += person->get_infectivity(condition_id);
+      }
+    }
+    if(infectivity > 0.0) {
+      Utils::fred_snprintf(line, sizeof(line), "V %d %.17g\n", k, infectivity);
+      message[remote_place.partition] += line;
+    }
+  }
+
+  // force of infection on the visitors at the open places held here
+  int hosted = Partition::hosted_places.size();
+  std::vector<bool> open(hosted, false);
+  std::vector<double> hazard(hosted, 0.0);
+  for(int h = 0; h < hosted; ++h) {
+    Place* place = Partition::hosted_places[h];
+    open[h] = place->is_open(day) && place->should_be_open(day, condition_id);
+    if(open[h] == false) {
+      continue;
+    }
+    double infectivity = Partition::get_place_infectivity(place, condition_id, day);
+    if(infectivity > 0.0) {
+      int size = place->get_size() + Partition::hosted_visitors[h];
+      hazard[h] = place->get_contact_rate(day, condition_id) * infectivity / (size > 1 ? size - 1 : 1);
+    }
+  }
+  for(int q = 0; q < partitions; ++q) {
+    std::map<int, int>::iterator itr;
+    for(itr = Partition::hosted_index[q].begin(); itr != Partition::hosted_index[q].end(); ++itr) {
+      if(hazard[itr->second] > 0.0) {
+        Utils::fred_snprintf(line, sizeof(line), "H %d %.17g\n", itr->first, hazard[itr->second]);
+        message[q] += line;
+      }
+    }
+  }
+
+  char tag[FRED_STRING_SIZE];
+  Utils::fred_snprintf(tag, sizeof(tag), "day%d.%d", day, condition_id);
+  for(int q = 0; q < partitions; ++q) {
+    if(q != Partition::partition_id) {
+      Partition::send(q, tag, message[q]);
+    }
+  }
+
+  // expose our visitors at remote places, and collect the visitors to ours
+  std::vector<double> ghost_infectivity(hosted, 0.0);
+  for(int q = 0; q < partitions; ++q) {
+    if(q == Partition::partition_id) {
+      continue;
+    }
+    std::istringstream received(Partition::receive(q, tag));
+    char kind;
+    int k;
+    double value;
+    while(received >> kind >> k >> value) {
+      if(kind == 'V') {
+        std::map<int, int>::iterator itr = Partition::hosted_index[q].find(k);
+        if(itr != Partition::hosted_index[q].end() && open[itr->second]) {
+          ghost_infectivity[itr->second] += value;
+        }
+      } else if(kind == 'H' && 0 <= k && k < (int) Partition::remote_places.size()) {
+        remote_place_t &remote_place = Partition::remote_places[k];
+        for(int i = 0; i < (int) remote_place.visitors.size(); ++i) {
+          Person* person = remote_place.visitors[i];
+          if(person->is_susceptible(condition_id) && Partition::is_visiting(person, remote_place.type, day)
+             && Partition::expose(person, condition_id, value, day)) {
+            Partition::remote_exposures++;
+          }
+        }
+      }
+    }
+  }
+
+  // expose the people at our places to the infectious visitors
+  for(int h = 0; h < hosted; ++h) {
+    if(ghost_infectivity[h] == 0.0) {
+      continue;
+    }
+    Place* place = Partition::hosted_places[h];
+    int size = place->get_size() + Partition::hosted_visitors[h];
+    double place_hazard = place->get_contact_rate(day, condition_id) * ghost_infectivity[h] / (size > 1 ? size - 1 : 1);
+    for(int i = 0; i < place->get_size(); ++i) {
+      Person* person = place->get_enrollee(i);
+      if(person->is_susceptible(condition_id) && person->is_present(day, place)
+         && Partition::expose(person, condition_id, place_hazard, day)) {
+        Partition::ghost_exposures++;
+      }
+    }
+  }
+  FRED_VERBOSE(1, "partition %d day %d condition %d: %d exposures at remote places, %d exposures to visitors so far\n",
+	       Partition::partition_id, day, condition_id, Partition::remote_exposures, Partition::ghost_exposures);
+}
+
+int Partition::share_imported_cases(int candidates, int cases, int* share) {
+  int partitions = Partition::number_of_partitions;
+  char tag[FRED_STRING_SIZE];
+  char line[FRED_STRING_SIZE];
+  Utils::fred_snprintf(tag, sizeof(tag), "import%d", Partition::imported_case_exchanges);
+  Utils::fred_snprintf(line, sizeof(line), "%d\n", candidates);
+  for(int q = 0; q < partitions; ++q) {
+    if(q != Partition::partition_id) {
+      Partition::send(q, tag, line);
+    }
+  }
+
+  // every partition sees the same counts
+  std::vector<int> count(partitions, 0);
+  int total = 0;
+  for(int q = 0; q < partitions; ++q) {
+    if(q == Partition::partition_id) {
+      count[q] = candidates;
+    } else {
+      std::istringstream received(Partition::receive(q, tag));
+      received >> count[q];
+    }
+    total += count[q];
+  }
+
+  // and makes the same draws, keeping the cases of its own candidates
+  *share = 0;
+  if(cases <= total) {
+    Entity_Stream stream(Random::IMPORTED_CASES_STREAM, Partition::imported_case_exchanges);
+    int remaining = total;
+    for(int n = 0; n < cases; ++n) {
+      int pos = Random::draw_random_int(0, remaining - 1);
+      int q = 0;
+      while(count[q] <= pos) {
+        pos -= count[q];
+        q++;
+      }
+      count[q]--;
+      remaining--;
+      if(q == Partition::partition_id) {
+        (*share)++;
+      }
+    }
+  }
+  Partition::imported_case_exchanges++;
+  return total;
+}
+
+void Partition::terminate_person(Person* person) {
+  std::pair<std::multimap<Person*, int>::iterator, std::multimap<Person*, int>::iterator> range;
+  range = Partition::visitor_places.equal_range(person);
+  for(std::multimap<Person*, int>::iterator itr = range.first; itr != range.second; ++itr) {
+    std::vector<Person*> &visitors = Partition::remote_places[itr->second].visitors;
+    for(int i = 0; i < (int) visitors.size(); ++i) {
+      if(visitors[i] == person) {
+        visitors.erase(visitors.begin() + i);
+        break;
+      }
+    }
+  }
+  Partition::visitor_places.erase(range.first, range.second);
+}
+
+void Partition::end_of_run() {
+  if(Partition::is_enabled()) {
+    fprintf(Global::Statusfp, "partition %d: %d exposures of visitors at remote places, %d exposures to visitors from other partitions\n",
+	    Partition::partition_id, Partition::remote_exposures, Partition::ghost_exposures);
+    fflush(Global::Statusfp);
+  }
+}
+
+void Partition::send(int partition, const char* tag, const std::string &message) {
+  char filename[FRED_STRING_SIZE];
+  char tmpname[FRED_STRING_SIZE];
+  Utils::fred_snprintf(filename, sizeof(filename), "%s/%s.%d.%d", Partition::partition_directory, tag, Partition::partition_id, partition);
+  Utils::fred_snprintf(tmpname, sizeof(tmpname), "%s/.%s.%d.%d", Partition::partition_directory, tag, Partition::partition_id, partition);
+  FILE* fp = fopen(tmpname, "w");
+  if(fp == NULL) {
+    Utils::fred_abort("Partition: can't open %s\n", tmpname);
+  }
+  if(fwrite(message.data(), 1, message.size(), fp) != message.size() || fclose(fp) != 0) {
+    Utils::fred_abort("Partition: can't write %s\n", tmpname);
+  }
+  // the receiver only sees complete messages
+  if(rename(tmpname, filename) != 0) {
+    Utils::fred_abort("Partition: can't rename %s\n", tmpname);
+  }
+}
+
+std::string Partition::receive(int partition, const char* tag) {
+  char filename[FRED_STRING_SIZE];
+  Utils::fred_snprintf(filename, sizeof(filename), "%s/%s.%d.%d", Partition::partition_directory, tag, partition, Partition::partition_id);
+  time_t start = time(NULL);
+  useconds_t wait = 100;
+  FILE* fp = NULL;
+  while((fp = fopen(filename, "r")) == NULL) {
+    if(time(NULL) - start > Partition::timeout) {
+      Utils::fred_abort("Partition %d: no %s message from partition %d after %d seconds\n",
+			Partition::partition_id, tag, partition, Partition::timeout);
+    }
+    usleep(wait);
+    if(wait < 10000) {
+      wait *= 2;
+    }
+  }
+  std::string message;
+  char buffer[65536];
+  size_t n;
+  while((n = fread(buffer, 1, sizeof(buffer), fp)) > 0) {
+    message.append(buffer, n);
+  }
+  fclose(fp);
+  unlink(filename);
+  return message;
+}
+
+double Partition::get_place_infectivity(Place* place, int condition_id, int day) {
+  double infectivity = 0.0;
+  for(int i = 0; i < place->get_size(); ++i) {
+    Person* person = place->get_enrollee(i);
+    if(person->is_infectious(condition_id) && person->is_present(day, place)) {
+      infectivity += person->get_infectivity(condition_id);
+    }
+  }
+  return infectivity;
+}
+
+bool Partition::is_visiting(Person* person, char type, int day) {
+  // while traveling, the schedule refers to the places of the host
+  if(person->get_travel_status()) {
+    return false;
+  }
+  int activity = (type == 'S' ? Activity_index::SCHOOL_ACTIVITY : Activity_index::WORKPLACE_ACTIVITY);
+  return person->is_on_schedule(day, activity);
+}
+
+bool Partition::expose(Person* person, int condition_id, double hazard, int day) {
+  if(person->is_susceptible(condition_id) == false) {
+    return false;
+  }
+  double prob = 1.0 - exp(-hazard * person->get_susceptibility(condition_id));
+  if(Random::draw_random() < prob) {
+    person->become_exposed(condition_id, NULL, NULL, day);
+    Global::Conditions.get_condition(condition_id)->get_epidemic()->become_exposed(person, day);
+    return true;
+  }
+  return false;
+}
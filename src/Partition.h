@@ -0,0 +1,181 @@
+/*
+  This file is part of the FRED system.
+
+  Copyright (c) 2013-2016, University of Pittsburgh, John Grefenstette,
+  David Galloway, Mary Krauland, Michael Lann, and Donald Burke.
+
+  Based in part on FRED Version 2.9, created in 2010-2013 by
+  John Grefenstette, Shawn Brown, Roni Rosenfield, Alona Fyshe, David
+  Galloway, Nathan Stone, Jay DePasse, Anuroop Sriram, and Donald Burke.
+
+  Licensed under the BSD 3-Clause license.  See the file "LICENSE" for
+  more information.
+*/
+
+//
+//
+// File: Partition.h
+//
+
+#ifndef _FRED_PARTITION_H
+#define _FRED_PARTITION_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Global.h"
+
+class Person;
+class Place;
+
+/**
+ * Partitioned runs, in which the counties of a simulation are divided
+ * among several FRED processes on one host.
+ *
+ * Each process (partition) reads only its own counties, so it holds the
+ * households, places and people of those counties. bin/fred_partition_run
+ * assigns the counties, starts the processes and merges their out.csv
+ * files.
+ *
+ * Residents whose workplace or school lies in another partition are
+ * remote visitors. At setup, each partition sends the labels of the
+ * places its residents visit to the other partitions, and each place is
+ * claimed by the partition that holds it. The remote workplace or school
+ * is on the visitor's schedule like a local one, so weekends, sick
+ * leave, absenteeism, hospital stays and travel keep the visitor away.
+ *
+ * Each day, for each condition with respiratory transmission, the
+ * epidemic update sends every other partition one batch of ghost visits
+ * after the daily activities of the infectious people are updated and
+ * before infection is spread:
+ *
+ *   V lines: the infectivity of its infectious residents visiting each
+ *            place held by the receiver today
+ *   H lines: the force of infection from its own infectious people on
+ *            the visitors from the receiver at each of its places
+ *
+ * The receiver exposes its own people at the visited places to the
+ * infectious visitors, and its visiting residents to the force of
+ * infection at the remote places. Places closed today (see
+ * Place::is_open() and Place::should_be_open()) neither send nor receive
+ * ghost visits. These exposures are recorded as imported exposures.
+ * A fixed number of imported cases is drawn from the candidates of all
+ * partitions, as in a single process.
+ *
+ * The results only approximate those of a single process that holds all
+ * the counties:
+ *
+ *  - the exposure across partitions uses a mean-field hazard, the
+ *    place's contact rate times the total infectivity divided by the
+ *    number of other people at the place, instead of the contact and
+ *    transmission model of the place;
+ *  - a remote visitor's place (and closure decisions made from the
+ *    place's own counts) only count the visitors fixed at setup, and
+ *    the remote places of a person are not updated when they change
+ *    their workplace or school;
+ *  - exposures across partitions are made before the infection is
+ *    spread within each partition, and have no infector;
+ *  - imported cases with a per capita rate are drawn in each partition
+ *    at that rate;
+ *  - neighborhood mixing and travel do not cross partition boundaries;
+ *  - each partition draws its own random numbers, so a partitioned run
+ *    can't reproduce a single-process run draw for draw.
+ *
+ * Messages are files in partition_directory, written under a temporary
+ * name and renamed, so the directory should be on a shared memory file
+ * system (such as /dev/shm) where possible.
+ */
+class Partition {
+public:
+
+  /**
+   * Read the partition parameters.
+   */
+  static void get_parameters();
+
+  static bool is_enabled() {
+    return Partition::number_of_partitions > 1;
+  }
+
+  static int get_partition_id() {
+    return Partition::partition_id;
+  }
+
+  /**
+   * Record that the given person visits the place with the given label,
+   * which is not held by this partition. type is 'W' for a workplace and
+   * 'S' for a school.
+   */
+  static void add_remote_visit(Person* person, char type, const char* label);
+
+  /**
+   * Agree with the other partitions which partition holds each place
+   * visited by remote visitors. Must be called while the place labels
+   * are still available.
+   */
+  static void setup();
+
+  /**
+   * Exchange the day's ghost visits for the given condition with the
+   * other partitions and apply the resulting exposures. All partitions
+   * must call this for the same conditions in the same order.
+   */
+  static void exchange_visits(int day, int condition_id);
+
+  /**
+   * Draw a number of imported cases from the candidates of all
+   * partitions without replacement. All partitions must call this in
+   * the same order.
+   *
+   * @param candidates the number of candidates in this partition
+   * @param cases the number of cases to draw, if there are enough
+   * candidates in all partitions
+   * @param share set to the number of the cases drawn from this
+   * partition's candidates
+   * @return the number of candidates in all partitions
+   */
+  static int share_imported_cases(int candidates, int cases, int* share);
+
+  static void terminate_person(Person* person);
+
+  static void end_of_run();
+
+private:
+  static int number_of_partitions;
+  static int partition_id;
+  static char partition_directory[FRED_STRING_SIZE];
+  static int timeout;
+
+  // places in other partitions visited by residents of this partition
+  typedef struct remote_place {
+    char type;
+    std::string label;
+    int partition;
+    std::vector<Person*> visitors;
+  } remote_place_t;
+  static std::vector<remote_place_t> remote_places;
+  static std::map<std::string, int> remote_place_index;
+  static std::multimap<Person*, int> visitor_places;
+
+  // places of this partition visited by residents of other partitions,
+  // and for each partition, a map from its remote place index to ours
+  static std::vector<Place*> hosted_places;
+  static std::vector<int> hosted_visitors;
+  static std::vector< std::map<int, int> > hosted_index;
+
+  // exposures made by the exchange, for the final report
+  static int remote_exposures;
+  static int ghost_exposures;
+
+  // number of calls to share_imported_cases()
+  static int imported_case_exchanges;
+
+  static void send(int partition, const char* tag, const std::string &message);
+  static std::string receive(int partition, const char* tag);
+  static double get_place_infectivity(Place* place, int condition_id, int day);
+  static bool is_visiting(Person* person, char type, int day);
+  static bool expose(Person* person, int condition_id, double hazard, int day);
+};
+
+#endif // _FRED_PARTITION_H
@@ -21,6 +21,7 @@
 
 #include "Activities.h"
 #include "Age_Map.h"
+#include "Checkpoint.h"
 #include "Classroom.h"
 #include "Demographics.h"
 #include "Condition.h"
@@ -152,22 +153,24 @@ Person* Person::give_birth(int day) {
 }
 
 string Person::to_string() {
+  char buffer[FRED_STRING_SIZE];
+  to_string(buffer, FRED_STRING_SIZE);
+  return string(buffer);
+}
 
-  stringstream tmp_string_stream;
+int Person::to_string(char* buffer, int size) {
   // (i.e *ID* Age Sex Race Household School Classroom Workplace Office Neighborhood Hospital Ad_Hoc Relationship)
-  tmp_string_stream << this->id << " " << this->get_age() << " " <<  this->get_sex() << " " ;
-  tmp_string_stream << this->get_race() << " " ;
-  tmp_string_stream << Place::get_place_label(this->get_household()) << " ";
-  tmp_string_stream << Place::get_place_label(this->get_school()) << " ";
-  tmp_string_stream << Place::get_place_label(this->get_classroom()) << " ";
-  tmp_string_stream << Place::get_place_label(this->get_workplace()) << " ";
-  tmp_string_stream << Place::get_place_label(this->get_office()) << " ";
-  tmp_string_stream << Place::get_place_label(this->get_neighborhood()) << " ";
-  tmp_string_stream << Place::get_place_label(this->get_hospital()) << " ";
-  tmp_string_stream << Place::get_place_label(this->get_ad_hoc()) << " ";
-  tmp_string_stream << this->get_relationship();
-
-  return tmp_string_stream.str();
+  return snprintf(buffer, size, "%d %d %c %d %s %s %s %s %s %s %s %s %d",
+		  this->id, this->get_age(), this->get_sex(), this->get_race(),
+		  Place::get_place_label(this->get_household()),
+		  Place::get_place_label(this->get_school()),
+		  Place::get_place_label(this->get_classroom()),
+		  Place::get_place_label(this->get_workplace()),
+		  Place::get_place_label(this->get_office()),
+		  Place::get_place_label(this->get_neighborhood()),
+		  Place::get_place_label(this->get_hospital()),
+		  Place::get_place_label(this->get_ad_hoc()),
+		  this->get_relationship());
 }
 
 void Person::terminate(int day) {
@@ -229,3 +232,14 @@ int Person::get_household_county_fips() {
   return get_household()->get_county_fips();
 }
 
+void Person::write_checkpoint() {
+  Checkpoint::put(this->exposed_household_index);
+  this->health.write_checkpoint();
+  this->activities.write_checkpoint();
+}
+
+void Person::read_checkpoint() {
+  Checkpoint::get(this->exposed_household_index);
+  this->health.read_checkpoint();
+  this->activities.read_checkpoint();
+}
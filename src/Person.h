@@ -64,6 +64,13 @@ public:
 
   void print(FILE* fp, int condition_id);
 
+  /**
+   * Save or restore this person's health and daily activities (see
+   * Checkpoint).
+   */
+  void write_checkpoint();
+  void read_checkpoint();
+
   void infect(Person* infectee, int condition_id, Mixing_Group* mixing_group, int day) {
     this->health.infect(infectee, condition_id, mixing_group, day);
   }
@@ -95,6 +102,18 @@ public:
     this->activities.update_schedule(sim_day);
   }
 
+  bool is_on_schedule(int sim_day, int activity) {
+    return this->activities.is_on_schedule(sim_day, activity);
+  }
+
+  void set_remote_workplace() {
+    this->activities.set_remote_workplace();
+  }
+
+  void set_remote_school() {
+    this->activities.set_remote_school();
+  }
+
   void update_daily_activities(int sim_day) {
     this->activities.update_daily_activities(sim_day);
   }
@@ -103,6 +122,14 @@ public:
     this->activities.update_enrollee_index(mixing_group, pos);
   }
 
+  void update_susceptible_rosters(int condition_id, bool susceptible) {
+    this->activities.update_susceptible_rosters(condition_id, susceptible);
+  }
+
+  bool is_enrolled_in_place(Place* place) {
+    return this->activities.is_enrolled_in_place(place);
+  }
+
   School* get_last_school() {
     return this->activities.get_last_school();
   }
@@ -201,6 +228,15 @@ public:
    */
   string to_string();
 
+  /**
+   * Write the line returned by to_string() into a buffer, without
+   * allocating memory.
+   * @param buffer where to write the line
+   * @param size the size of the buffer
+   * @return the length of the line
+   */
+  int to_string(char* buffer, int size);
+
   // access functions:
   /**
    * The id is generated at runtime
@@ -241,6 +277,10 @@ public:
     return this->demographics.get_real_age();
   }
 
+  int get_birthday_sim_day() {
+    return this->demographics.get_birthday_sim_day();
+  }
+
   bool is_today_my_birthday() {
     return this->demographics.is_today_my_birthday();
   }
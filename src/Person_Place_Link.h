@@ -35,6 +35,16 @@ class Person_Place_Link {
 
   void update_enrollee_index(int new_index);
 
+  /**
+   * Point the link at the given place and enrollee position without
+   * enrolling (used when restoring a checkpoint, which restores the
+   * place's enrollees as well).
+   */
+  void set_link(Place* new_place, int new_index) {
+    this->place = new_place;
+    this->enrollee_index = new_index;
+  }
+
   Place* get_place() {
     return this->place;
   }
@@ -22,6 +22,7 @@
 
 #include "Place.h"
 
+#include "Checkpoint.h"
 #include "Date.h"
 #include "Condition.h"
 #include "Condition_List.h"
@@ -79,6 +80,7 @@ Place::Place() : Mixing_Group("BLANK") {
   fred::geo undefined = -1.0;
   this->longitude = undefined;
   this->latitude = undefined;
+  this->update_xy();
   this->fips = 0;
 
   int conditions = Global::Conditions.get_number_of_conditions();
@@ -104,6 +106,10 @@ Place::Place() : Mixing_Group("BLANK") {
   this->vector_condition_data = NULL;
   this->vectors_have_been_infected_today = false;
   this->vector_control_status = false;
+
+  if(Global::Enable_Susceptible_Rosters) {
+    enable_susceptible_rosters();
+  }
 }
 
 Place::Place(const char* lab, fred::geo lon, fred::geo lat) : Mixing_Group(lab) {
@@ -124,6 +130,7 @@ Place::Place(const char* lab, fred::geo lon, fred::geo lat) : Mixing_Group(lab)
 
   this->longitude = lon;
   this->latitude = lat;
+  this->update_xy();
   this->fips = 0;				// assigned elsewhere
 
   int conditions = Global::Conditions.get_number_of_conditions();
@@ -149,6 +156,10 @@ Place::Place(const char* lab, fred::geo lon, fred::geo lat) : Mixing_Group(lab)
   this->vector_condition_data = NULL;
   this->vectors_have_been_infected_today = false;
   this->vector_control_status = false;
+
+  if(Global::Enable_Susceptible_Rosters) {
+    enable_susceptible_rosters();
+  }
 }
 
 void Place::prepare() {
@@ -186,6 +197,18 @@ void Place::update(int sim_day) {
   // stub for future use.
 }
 
+void Place::write_checkpoint() {
+  Mixing_Group::write_checkpoint();
+  Checkpoint::put(this->close_date);
+  Checkpoint::put(this->open_date);
+}
+
+void Place::read_checkpoint() {
+  Mixing_Group::read_checkpoint();
+  Checkpoint::get(this->close_date);
+  Checkpoint::get(this->open_date);
+}
+
 void Place::print(int condition_id) {
   FRED_STATUS(0, "%s\n", this->to_string().c_str());
   fflush(stdout);
@@ -382,6 +405,14 @@ char* Place::get_place_label(Place* p) {
   return ((p == NULL) ? (char*) "-1" : p->get_label());
 }
 
+void Place::setup_age_bias_table(double bias, std::vector<double> &table) {
+  int days = (Demographics::MAX_AGE + 1) * 366;
+  table.resize(days);
+  for(int d = 0; d < days; ++d) {
+    table[d] = exp(-bias * (d / 365.25));
+  }
+}
+
     
 int Place::get_state_fips() {
   if (Global::Places.is_country_usa()) {
@@ -73,6 +73,9 @@ public:
 
   virtual void prepare();
 
+  virtual void write_checkpoint();
+  virtual void read_checkpoint();
+
   /**
    * Will print out a Place i
    * @return a string representation of this Place object
@@ -238,6 +241,7 @@ public:
    */
   void set_latitude(double x) {
     this->latitude = x;
+    this->y = Geo::get_y(this->latitude);
   }
 
   /**
@@ -247,6 +251,7 @@ public:
    */
   void set_longitude(double x) {
     this->longitude = x;
+    this->x = Geo::get_x(this->longitude);
   }
 
   /**
@@ -290,12 +295,23 @@ public:
   void turn_workers_into_teachers(Place* school);
   void reassign_workers(Place* place);
 
+  /**
+   * The projected coordinates, in km, cached when the location is set.
+   */
   double get_x() {
-    return Geo::get_x(this->longitude);
+    return this->x;
   }
 
   double get_y() {
-    return Geo::get_y(this->latitude);
+    return this->y;
+  }
+
+  /**
+   * Recompute the projected coordinates after the projection changes.
+   */
+  void update_xy() {
+    this->x = Geo::get_x(this->longitude);
+    this->y = Geo::get_y(this->latitude);
   }
 
   void set_index(int _index) {
@@ -328,6 +344,16 @@ public:
 
   static char* get_place_label(Place* p);
 
+  /**
+   * Fill a table with exp(-bias * d / 365.25), the same-age transmission
+   * bias of two people whose birthdays are d days apart, for every d up
+   * to Demographics::MAX_AGE years.
+   *
+   * @param bias the same-age bias
+   * @param table the table to fill
+   */
+  static void setup_age_bias_table(double bias, std::vector<double> &table);
+
   double get_seeds(int dis, int sim_day);
 
   /*
@@ -391,6 +417,8 @@ protected:
 
   fred::geo latitude;				// geo location
   fred::geo longitude;				// geo location
+  double x;			 // projected location, see Geo::get_x
+  double y;			 // projected location, see Geo::get_y
   long int fips;			       // census_tract fips code
 
   int close_date;		    // this place will be closed during:
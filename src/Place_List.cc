@@ -101,11 +101,12 @@ HospitalIDCountMapT Place_List::Hospital_ID_total_assigned_size_map;
 HospitalIDCountMapT Place_List::Hospital_ID_current_assigned_size_map;
 
 double distance_between_places(Place* p1, Place* p2) {
-  return Geo::xy_distance(p1->get_latitude(), p1->get_longitude(), p2->get_latitude(), p2->get_longitude());
+  return p1->get_distance(p2);
 }
 
 Place_List::~Place_List() {
   delete_place_label_map();
+  delete_hospital_catchments();
 }
 
 void Place_List::init_place_type_name_lookup_map() {
@@ -300,6 +301,9 @@ void Place_List::read_all_places() {
     Utils::fred_log("min_lat: %f  max_lat: %f\n", min_lat, max_lat);
   }
 
+  // the projection is now fixed
+  setup_place_coordinates();
+
   // create geographical grids
   Global::Simulation_Region = new Regional_Layer(min_lon, min_lat, max_lon, max_lat);
 
@@ -857,8 +861,11 @@ void Place_List::setup_counties() {
 
 
 void Place_List::setup_census_tracts() {
-  // set each census tract's school and workplace attendance probabilities
-  for(int i = 0; i < this->census_tracts.size(); ++i) {
+  // set each census tract's school and workplace attendance probabilities;
+  // each tract reads its own households and writes only its own lists
+  int number_of_census_tracts = this->census_tracts.size();
+#pragma omp parallel for schedule(dynamic)
+  for(int i = 0; i < number_of_census_tracts; ++i) {
     this->census_tracts[i]->setup();
   }
 }
@@ -868,7 +875,11 @@ void Place_List::prepare() {
 
   FRED_STATUS(0, "prepare places entered\n", "");
 
-  for(int p = 0; p < get_number_of_households(); ++p) {
+  // households are not registered with their neighborhood patches, so
+  // each prepares only itself (unless it sets up a vector model)
+  int number_of_households = get_number_of_households();
+#pragma omp parallel for if(!Global::Enable_Vector_Transmission)
+  for(int p = 0; p < number_of_households; ++p) {
     this->households[p]->prepare();
   }
 
@@ -1349,7 +1360,9 @@ void Place_List::setup_households() {
 
   FRED_STATUS(0, "setup households entered\n", "");
 
+  // each household updates only itself and its own members
   int num_households = this->households.size();
+#pragma omp parallel for schedule(dynamic,1000)
   for(int p = 0; p < num_households; ++p) {
     Household* house = this->get_household(p);
     house->set_index(p);
@@ -1427,29 +1440,91 @@ void Place_List::setup_classrooms() {
 
 void Place_List::reassign_workers() {
 
+  // the places that take their staff from nearby workplaces, in the
+  // order in which they are staffed
+  std::vector<worker_reassignment_t> reassignments;
+
   if(Global::Assign_Teachers) {
-    reassign_workers_to_schools();
+    add_school_reassignments(reassignments);
   }
 
   if(Global::Enable_Hospitals) {
-    reassign_workers_to_hospitals();
+    add_hospital_reassignments(reassignments);
   }
 
   if(Global::Enable_Group_Quarters) {
-    reassign_workers_to_group_quarters(Place::SUBTYPE_COLLEGE, Place_List::College_fixed_staff,
-				       Place_List::College_resident_to_staff_ratio);
-    reassign_workers_to_group_quarters(Place::SUBTYPE_PRISON, Place_List::Prison_fixed_staff,
-				       Place_List::Prison_resident_to_staff_ratio);
-    reassign_workers_to_group_quarters(Place::SUBTYPE_MILITARY_BASE, Place_List::Military_fixed_staff,
-				       Place_List::Military_resident_to_staff_ratio);
-    reassign_workers_to_group_quarters(Place::SUBTYPE_NURSING_HOME, Place_List::Nursing_home_fixed_staff,
-				       Place_List::Nursing_home_resident_to_staff_ratio);
+    add_group_quarters_reassignments(Place::SUBTYPE_COLLEGE, Place_List::College_fixed_staff,
+				     Place_List::College_resident_to_staff_ratio, reassignments);
+    add_group_quarters_reassignments(Place::SUBTYPE_PRISON, Place_List::Prison_fixed_staff,
+				     Place_List::Prison_resident_to_staff_ratio, reassignments);
+    add_group_quarters_reassignments(Place::SUBTYPE_MILITARY_BASE, Place_List::Military_fixed_staff,
+				     Place_List::Military_resident_to_staff_ratio, reassignments);
+    add_group_quarters_reassignments(Place::SUBTYPE_NURSING_HOME, Place_List::Nursing_home_fixed_staff,
+				     Place_List::Nursing_home_resident_to_staff_ratio, reassignments);
+  }
+
+  // find each place's nearby workplace in the initial workplaces
+  int number_of_reassignments = reassignments.size();
+#pragma omp parallel for schedule(dynamic)
+  for(int i = 0; i < number_of_reassignments; ++i) {
+    worker_reassignment_t* r = &reassignments[i];
+    r->nearby_workplace = r->regional_patch->get_nearby_workplace(r->place, r->staff);
+  }
+
+  // Staffing a place empties its nearby workplace, and an empty
+  // workplace never matches a later search (group quarters workplaces,
+  // which gain workers, are not searched). So a workplace found above is
+  // the one a search made in order would find, unless an earlier place
+  // has already taken it, in which case the search is repeated.
+  std::set<Place*> emptied_workplaces;
+  for(int i = 0; i < number_of_reassignments; ++i) {
+    worker_reassignment_t* r = &reassignments[i];
+    if(r->nearby_workplace != NULL && emptied_workplaces.count(r->nearby_workplace) > 0) {
+      r->nearby_workplace = r->regional_patch->get_nearby_workplace(r->place, r->staff);
+    }
+    if(r->nearby_workplace != NULL) {
+      emptied_workplaces.insert(r->nearby_workplace);
+    }
+    reassign_workers(*r);
   }
+}
 
-  Utils::fred_print_lap_time("reassign workers");
+void Place_List::reassign_workers(worker_reassignment_t & reassignment) {
+  Place* place = reassignment.place;
+  Place* nearby_workplace = reassignment.nearby_workplace;
+
+  if(place->is_school()) {
+    if(nearby_workplace != NULL) {
+      // make all the workers in selected workplace teachers at the nearby school
+      nearby_workplace->turn_workers_into_teachers(place);
+    } else {
+      FRED_VERBOSE(0, "NO NEARBY_WORKPLACE FOUND FOR SCHOOL %s in county %d at lat %f lon %f \n",
+		   place->get_label(), place->get_county_fips(), place->get_latitude(), place->get_longitude());
+    }
+  } else if(place->is_hospital()) {
+    if(nearby_workplace != NULL) {
+      // make all the workers in selected workplace as workers in the target place
+      nearby_workplace->reassign_workers(place);
+    } else {
+      FRED_VERBOSE(0, "NO NEARBY_WORKPLACE FOUND for hospital %s in county %d at lat %f lon %f \n",
+		   place->get_label(), place->get_county_fips(), place->get_latitude(), place->get_longitude());
+    }
+  } else {
+    if(nearby_workplace != NULL) {
+      // make all the workers in selected workplace as workers in the target place
+      FRED_VERBOSE(0, "REASSIGN WORKERS: NEARBY_WORKPLACE FOUND %s for GQ %s subtype %c at lat %f lon %f \n",
+		   nearby_workplace->get_label(),
+		   place->get_label(), place->get_subtype(), place->get_latitude(), place->get_longitude());
+      nearby_workplace->reassign_workers(place);
+    }
+    else {
+      FRED_VERBOSE(0, "REASSIGN WORKERS: NO NEARBY_WORKPLACE FOUND for GQ %s subtype %c at lat %f lon %f \n",
+		   place->get_label(), place->get_subtype(), place->get_latitude(), place->get_longitude());
+    }
+  }
 }
 
-void Place_List::reassign_workers_to_schools() {
+void Place_List::add_school_reassignments(std::vector<worker_reassignment_t> & reassignments) {
 
   // staff data from:
   // http://www.statemaster.com/graph/edu_ele_sec_pup_rat-elementary-secondary-pupil-teacher-ratio
@@ -1487,18 +1562,12 @@ void Place_List::reassign_workers_to_schools() {
     FRED_VERBOSE(1, "school %s students %d fixed_staff = %d tot_staff = %d\n",
 		 school->get_label(), n, fixed_staff, staff);
 
-    Place* nearby_workplace = regional_patch->get_nearby_workplace(school, staff);
-    if(nearby_workplace != NULL) {
-      // make all the workers in selected workplace teachers at the nearby school
-      nearby_workplace->turn_workers_into_teachers(school);
-    } else {
-      FRED_VERBOSE(0, "NO NEARBY_WORKPLACE FOUND FOR SCHOOL %s in county %d at lat %f lon %f \n",
-		   school->get_label(), school->get_county_fips(), lat, lon);
-    }
+    worker_reassignment_t reassignment = { school, staff, regional_patch, NULL };
+    reassignments.push_back(reassignment);
   }
 }
 
-void Place_List::reassign_workers_to_hospitals() {
+void Place_List::add_hospital_reassignments(std::vector<worker_reassignment_t> & reassignments) {
 
   int number_places = get_number_of_hospitals();
   Utils::fred_log("reassign workers to hospitals entered. places = %d\n", number_places);
@@ -1531,18 +1600,13 @@ void Place_List::reassign_workers_to_hospitals() {
       staff += (0.5 + (double)n / staff_ratio);
     }
     
-    Place* nearby_workplace = regional_patch->get_nearby_workplace(hosp, staff);
-    if(nearby_workplace != NULL) {
-      // make all the workers in selected workplace as workers in the target place
-      nearby_workplace->reassign_workers(hosp);
-    } else {
-      FRED_VERBOSE(0, "NO NEARBY_WORKPLACE FOUND for hospital %s in county %d at lat %f lon %f \n",
-		   hosp->get_label(), hosp->get_county_fips(), lat, lon);
-    }
+    worker_reassignment_t reassignment = { hosp, staff, regional_patch, NULL };
+    reassignments.push_back(reassignment);
   }
 }
 
-void Place_List::reassign_workers_to_group_quarters(char subtype, int fixed_staff, double resident_to_staff_ratio) {
+void Place_List::add_group_quarters_reassignments(char subtype, int fixed_staff, double resident_to_staff_ratio,
+						  std::vector<worker_reassignment_t> & reassignments) {
   int number_places = this->workplaces.size();
   Utils::fred_log("reassign workers to group quarters subtype %c entered. total workplaces = %d\n", subtype, number_places);
   for(int p = 0; p < number_places; ++p) {
@@ -1550,8 +1614,6 @@ void Place_List::reassign_workers_to_group_quarters(char subtype, int fixed_staf
     if(place->get_subtype() == subtype) {
       fred::geo lat = place->get_latitude();
       fred::geo lon = place->get_longitude();
-      double x = Geo::get_x(lon);
-      double y = Geo::get_y(lat);
       // target staff size
       FRED_VERBOSE(1, "Size %d ", place->get_size());
       int staff = fixed_staff;
@@ -1570,18 +1632,8 @@ void Place_List::reassign_workers_to_group_quarters(char subtype, int fixed_staf
         continue;
       }
 
-      Place* nearby_workplace = regional_patch->get_nearby_workplace(place, staff);
-      if(nearby_workplace != NULL) {
-        // make all the workers in selected workplace as workers in the target place
-        FRED_VERBOSE(0, "REASSIGN WORKERS: NEARBY_WORKPLACE FOUND %s for GQ %s subtype %c at lat %f lon %f \n",
-		     nearby_workplace->get_label(),
-		     place->get_label(), subtype, lat, lon);
-        nearby_workplace->reassign_workers(place);
-      }
-      else {
-        FRED_VERBOSE(0, "REASSIGN WORKERS: NO NEARBY_WORKPLACE FOUND for GQ %s subtype %c at lat %f lon %f \n",
-		     place->get_label(), subtype, lat, lon);
-      }
+      worker_reassignment_t reassignment = { place, staff, regional_patch, NULL };
+      reassignments.push_back(reassignment);
     }
   }
 }
@@ -1622,17 +1674,30 @@ void Place_List::assign_hospitals_to_households() {
 
     FRED_STATUS(0, "assign_hospitals_to_household entered\n");
 
+    // the hospitals are drawn in parallel, each household from its own
+    // entity stream, and recorded in household order
     int number_hh = (int)this->households.size();
+    std::vector<Hospital*> assigned_hosp(number_hh);
+#pragma omp parallel for schedule(dynamic,100)
     for(int i = 0; i < number_hh; ++i) {
       Household* hh = static_cast<Household*>(this->households[i]);
-      Hospital* hosp = static_cast<Hospital*>(this->get_hospital_assigned_to_household(hh));
+      Entity_Stream stream(Random::HOSPITAL_ASSIGNMENT_STREAM, hh->get_id());
+      assigned_hosp[i] = this->get_hospital_assigned_to_household(hh);
+    }
+
+    for(int i = 0; i < number_hh; ++i) {
+      Household* hh = static_cast<Household*>(this->households[i]);
+      Hospital* hosp = assigned_hosp[i];
       assert(hosp != NULL);
       if(hosp != NULL) {
         hh->set_household_visitation_hospital(hosp);
         string hh_label_str(hh->get_label());
         string hosp_label_str(hosp->get_label());
 
-        this->hh_label_hosp_label_map.insert(std::pair<string, string>(hh_label_str, hosp_label_str));
+        if(this->hh_label_hosp_label_map.insert(std::pair<string, string>(hh_label_str, hosp_label_str)).second) {
+          //List is incomplete so set this so we can print out a new file
+          Place_List::Household_hospital_map_file_exists = false;
+        }
       }
     }
 
@@ -1738,6 +1803,140 @@ void Place_List::prepare_primary_care_assignment() {
   }
 }
 
+/*
+ * The cached catchment of the household, built on first use. The candidate
+ * lists are filled while the lock is held, so the returned catchment is
+ * complete for any caller, and it is not changed afterwards.
+ */
+Place_List::hospital_catchment_t* Place_List::get_hospital_catchment(Household* hh) {
+  fred::Scoped_Lock lock(this->hospital_catchment_mutex);
+  HospitalCatchmentMapT::iterator itr = this->hospital_catchment_map.find(hh->get_id());
+  if(itr != this->hospital_catchment_map.end()) {
+    return itr->second;
+  }
+  hospital_catchment_t* catchment = new hospital_catchment_t;
+  get_nearby_hospital_distances(catchment, hh);
+  get_local_hospital_distances(catchment, hh);
+  this->hospital_catchment_map.insert(std::make_pair(hh->get_id(), catchment));
+  return catchment;
+}
+
+void Place_List::get_nearby_hospital_distances(hospital_catchment_t* catchment, Household* hh) {
+  // candidates for overnight stays come from the surrounding regional patches
+  fred::geo lat = hh->get_latitude();
+  fred::geo lon = hh->get_longitude();
+  Regional_Patch* hh_patch = Global::Simulation_Region->get_patch(lat, lon);
+  if(hh_patch == NULL) {
+    return;
+  }
+  vector<Place*> possible_hosp = Global::Simulation_Region->get_nearby_hospitals(hh_patch->get_row(), hh_patch->get_col(), lat, lon, 5);
+  int number_hospitals = static_cast<int>(possible_hosp.size());
+  catchment->nearby_hospitals.reserve(number_hospitals);
+  catchment->nearby_distance.reserve(number_hospitals);
+  for(int i = 0; i < number_hospitals; ++i) {
+    catchment->nearby_hospitals.push_back(static_cast<Hospital*>(possible_hosp[i]));
+    catchment->nearby_distance.push_back(distance_between_places(hh, possible_hosp[i]));
+  }
+}
+
+void Place_List::get_local_hospital_distances(hospital_catchment_t* catchment, Household* hh) {
+  // candidates for radius-limited searches, in the order of the hospital list
+  int number_hospitals = get_number_of_hospitals();
+  if(number_hospitals == 0) {
+    return;
+  }
+  assert((int) this->hospital_coordinates.x.size() == number_hospitals);
+  std::vector<int> within(number_hospitals);
+  int found = Geo::xy_within_radius(hh->get_x(), hh->get_y(), &this->hospital_coordinates.x[0],
+				    &this->hospital_coordinates.y[0], number_hospitals,
+				    Place_List::Hospitalization_radius, &within[0]);
+  for(int k = 0; k < found; ++k) {
+    int i = within[k];
+    double distance = distance_between_places(hh, this->hospitals[i]);
+    if(distance > 0.0) {
+      catchment->local_hospitals.push_back(i);
+      catchment->local_distance.push_back(distance);
+    }
+  }
+}
+
+void Place_List::get_all_hospital_distances(Household* hh, std::vector<double> & distance) {
+  int number_hospitals = get_number_of_hospitals();
+  distance.resize(number_hospitals);
+  if(number_hospitals > 0) {
+    assert((int) this->hospital_coordinates.x.size() == number_hospitals);
+    Geo::xy_distances(hh->get_x(), hh->get_y(), &this->hospital_coordinates.x[0],
+		      &this->hospital_coordinates.y[0], number_hospitals, &distance[0]);
+  }
+}
+
+// recompute the projected location of each place in the list and
+// optionally record it in the given coordinate arrays
+static void update_place_coordinates(place_vector_t & places, Geo::xy_coordinates_t* coordinates) {
+  int size = places.size();
+  for(int i = 0; i < size; ++i) {
+    places[i]->update_xy();
+  }
+  if(coordinates != NULL) {
+    coordinates->x.resize(size);
+    coordinates->y.resize(size);
+    for(int i = 0; i < size; ++i) {
+      coordinates->x[i] = places[i]->get_x();
+      coordinates->y[i] = places[i]->get_y();
+    }
+  }
+}
+
+void Place_List::setup_place_coordinates() {
+  update_place_coordinates(this->households, &this->household_coordinates);
+  update_place_coordinates(this->schools, NULL);
+  update_place_coordinates(this->workplaces, NULL);
+  update_place_coordinates(this->hospitals, &this->hospital_coordinates);
+}
+
+void Place_List::get_households_within_radius(fred::geo lat, fred::geo lon, double radius, std::vector<int> & index) {
+  int number_households = get_number_of_households();
+  index.resize(number_households);
+  if(radius <= 0.0) {
+    for(int i = 0; i < number_households; ++i) {
+      index[i] = i;
+    }
+    return;
+  }
+  if(number_households == 0) {
+    return;
+  }
+  assert((int) this->household_coordinates.x.size() == number_households);
+  int found = Geo::xy_within_radius(Geo::get_x(lon), Geo::get_y(lat), &this->household_coordinates.x[0],
+				    &this->household_coordinates.y[0], number_households, radius, &index[0]);
+  index.resize(found);
+}
+
+void Place_List::delete_hospital_catchments() {
+  for(HospitalCatchmentMapT::iterator itr = this->hospital_catchment_map.begin(); itr != this->hospital_catchment_map.end(); ++itr) {
+    delete itr->second;
+  }
+  this->hospital_catchment_map.clear();
+}
+
+int Place_List::select_hospital_from_weights(std::vector<double> & weight, double probability_total) {
+  int number_candidates = static_cast<int>(weight.size());
+  if(probability_total > 0.0) {
+    for(int i = 0; i < number_candidates; ++i) {
+      weight[i] /= probability_total;
+    }
+  }
+  double rand = Random::draw_random();
+  double cum_prob = 0.0;
+  for(int i = 0; i < number_candidates; ++i) {
+    cum_prob += weight[i];
+    if(rand < cum_prob) {
+      return i;
+    }
+  }
+  return -1;
+}
+
 Hospital* Place_List::get_random_open_hospital_matching_criteria(int sim_day, Person* per, bool check_insurance) {
   if(!Global::Enable_Hospitals) {
     return NULL;
@@ -1748,88 +1947,51 @@ Hospital* Place_List::get_random_open_hospital_matching_criteria(int sim_day, Pe
   }
   assert(per != NULL);
 
-  int overnight_cap = 0;
-  Hospital* assigned_hospital = NULL;
   Household* hh = per->get_household();
   assert(hh != NULL);
 
-  // ignore place if it is outside the region
-  fred::geo lat = hh->get_latitude();
-  fred::geo lon = hh->get_longitude();
-  Regional_Patch* hh_patch = Global::Simulation_Region->get_patch(lat, lon);
-
-  vector<Place*> possible_hosp = Global::Simulation_Region->get_nearby_hospitals(hh_patch->get_row(), hh_patch->get_col(), lat, lon, 5);
-  int number_hospitals = static_cast<int>(possible_hosp.size());
+  hospital_catchment_t* catchment = get_hospital_catchment(hh);
+  int number_hospitals = static_cast<int>(catchment->nearby_hospitals.size());
   if(number_hospitals <= 0) {
     Utils::fred_abort("Found no nearby Hospitals in simulation that has Enabled Hospitalization", "");
   }
 
+  Insurance_assignment_index::e per_insur = Insurance_assignment_index::UNSET;
+  if(check_insurance) {
+    per_insur = per->get_health()->get_insurance_type();
+  }
+
   int number_possible_hospitals = 0;
   //First, only try Hospitals within a certain radius (* that accept insurance)
-  std::vector<double> hosp_probs;
+  // the candidates are fixed, so only their weights are computed per call
+  static thread_local std::vector<double> weight;
+  weight.resize(number_hospitals);
   double probability_total = 0.0;
   for(int i = 0; i < number_hospitals; ++i) {
-    Hospital* hospital = static_cast<Hospital*>(possible_hosp[i]);
-    double distance = distance_between_places(hh, hospital);
+    Hospital* hospital = catchment->nearby_hospitals[i];
+    double distance = catchment->nearby_distance[i];
     double cur_prob = 0.0;
-    int increment = 0;
-    overnight_cap = hospital->get_bed_count(sim_day);
+    int overnight_cap = hospital->get_bed_count(sim_day);
     //Need to make sure place is not a healthcare clinic && there are beds available
     if(distance > 0.0 && !hospital->is_healthcare_clinic() && !hospital->is_mobile_healthcare_clinic()
        && hospital->should_be_open(sim_day)
-       && (hospital->get_occupied_bed_count() < overnight_cap)) {
-      if(check_insurance) {
-        Insurance_assignment_index::e per_insur = per->get_health()->get_insurance_type();
-        if(hospital->accepts_insurance(per_insur)) {
-          //Hospital accepts the insurance so we are good
-          cur_prob = static_cast<double>(overnight_cap) / distance;
-          increment = 1;
-        } else {
-          //Not possible (Doesn't accept insurance)
-          cur_prob = 0.0;
-          increment = 0;
-        }
-      } else {
-        //We don't care about insurance so good to go
-        cur_prob = static_cast<double>(overnight_cap) / distance;
-        increment = 1;
-      }
-    } else {
-      //Not possible
-      cur_prob = 0.0;
-      increment = 0;
+       && (hospital->get_occupied_bed_count() < overnight_cap)
+       && (!check_insurance || hospital->accepts_insurance(per_insur))) {
+      cur_prob = static_cast<double>(overnight_cap) / distance;
+      number_possible_hospitals++;
     }
-    hosp_probs.push_back(cur_prob);
+    weight[i] = cur_prob;
     probability_total += cur_prob;
-    number_possible_hospitals += increment;
   }
-  assert(static_cast<int>(hosp_probs.size()) == number_hospitals);
   FRED_VERBOSE(1,"CATCH HOSP FOR HH %s number_hospitals %d number_poss_hosp %d\n",
 	       hh->get_label(), number_hospitals, number_possible_hospitals);
 
-
   if(number_possible_hospitals > 0) {
-    if(probability_total > 0.0) {
-      for(int i = 0; i < number_hospitals; ++i) {
-        hosp_probs[i] /= probability_total;
-	// printf("%f ", hosp_probs[i]);
-      }
-    }
-    // printf("\n");
-
-    double rand = Random::draw_random();
-    double cum_prob = 0.0;
-    int i = 0;
-    while(i < number_hospitals) {
-      cum_prob += hosp_probs[i];
-      if(rand < cum_prob) {
-	// printf("picked i = %d %f\n", i, hosp_probs[i]);
-        return static_cast<Hospital*>(possible_hosp[i]);
-      }
-      ++i;
+    int i = select_hospital_from_weights(weight, probability_total);
+    if(i < 0) {
+      i = number_hospitals - 1;
     }
-    printf("HOSP CATCHMENT picked default i = %d %f\n", number_hospitals-1, hosp_probs[number_hospitals-1]);
-    return static_cast<Hospital*>(possible_hosp[number_hospitals - 1]);
+    return catchment->nearby_hospitals[i];
   } else {
     //No hospitals in the simulation match search criteria
     return NULL;
@@ -1847,98 +2009,58 @@ Hospital* Place_List::get_random_open_healthcare_facility_matching_criteria(int
   }
   assert(per != NULL);
 
-  int daily_hosp_cap = 0;
-  Hospital* assigned_hospital = NULL;
   int number_hospitals = this->hospitals.size();
   if(number_hospitals == 0) {
     Utils::fred_abort("No Hospitals in simulation that has Enabled Hospitalization", "");
   }
-  int number_possible_hospitals = 0;
   Household* hh = per->get_household();
   assert(hh != NULL);
-  //First, only try Hospitals within a certain radius (* that accept insurance)
-  std::vector<double> hosp_probs;
+
+  // hospitals outside the search radius never match, so only the local catchment is scanned
+  hospital_catchment_t* catchment = NULL;
+  static thread_local std::vector<double> all_distance;
+  int number_candidates = 0;
+  if(use_search_radius_limit) {
+    catchment = get_hospital_catchment(hh);
+    number_candidates = static_cast<int>(catchment->local_hospitals.size());
+  } else {
+    get_all_hospital_distances(hh, all_distance);
+    number_candidates = number_hospitals;
+  }
+
+  Insurance_assignment_index::e per_insur = Insurance_assignment_index::UNSET;
+  if(check_insurance) {
+    per_insur = per->get_health()->get_insurance_type();
+  }
+
+  int number_possible_hospitals = 0;
+  static thread_local std::vector<double> weight;
+  weight.resize(number_candidates);
   double probability_total = 0.0;
-  for(int i = 0; i < number_hospitals; ++i) {
+  for(int k = 0; k < number_candidates; ++k) {
+    int i = use_search_radius_limit ? catchment->local_hospitals[k] : k;
+    double distance = use_search_radius_limit ? catchment->local_distance[k] : all_distance[k];
     Hospital* hospital = get_hospital(i);
-    daily_hosp_cap = hospital->get_daily_patient_capacity(sim_day);
-    double distance = distance_between_places(hh, hospital);
+    int daily_hosp_cap = hospital->get_daily_patient_capacity(sim_day);
     double cur_prob = 0.0;
-    int increment = 0;
 
     //Need to make sure place is open and not over capacity
     if(distance > 0.0 && hospital->should_be_open(sim_day)
-       && hospital->get_current_daily_patient_count() < daily_hosp_cap) {
-      if(use_search_radius_limit) {
-        if(distance <= Place_List::Hospitalization_radius) {
-          if(check_insurance) {
-            Insurance_assignment_index::e per_insur = per->get_health()->get_insurance_type();
-            if(hospital->accepts_insurance(per_insur)) {
-              //Hospital accepts the insurance so we are good
-              cur_prob = static_cast<double>(daily_hosp_cap) / (distance * distance);
-              increment = 1;
-            } else {
-              //Not possible (Doesn't accept insurance)
-              cur_prob = 0.0;
-              increment = 0;
-            }
-          } else {
-            //We don't care about insurance so good to go
-            cur_prob = static_cast<double>(daily_hosp_cap) / (distance * distance);
-            increment = 1;
-          }
-        } else {
-          //Not possible (not within the radius)
-          cur_prob = 0.0;
-          increment = 0;
-        }
-      } else { //Don't car about search radius
-        if(check_insurance) {
-          Insurance_assignment_index::e per_insur = per->get_health()->get_insurance_type();
-          if(hospital->accepts_insurance(per_insur)) {
-            //Hospital accepts the insurance so we are good
-            cur_prob = static_cast<double>(daily_hosp_cap) / (distance * distance);
-            increment = 1;
-          } else {
-            //Not possible (Doesn't accept insurance)
-            cur_prob = 0.0;
-            increment = 0;
-          }
-        } else {
-          //We don't care about insurance so good to go
-          cur_prob = static_cast<double>(daily_hosp_cap) / (distance * distance);
-          increment = 1;
-        }
-      }
-    } else {
-      //Not possible
-      cur_prob = 0.0;
-      increment = 0;
+       && hospital->get_current_daily_patient_count() < daily_hosp_cap
+       && (!check_insurance || hospital->accepts_insurance(per_insur))) {
+      cur_prob = static_cast<double>(daily_hosp_cap) / (distance * distance);
+      number_possible_hospitals++;
     }
-    hosp_probs.push_back(cur_prob);
+    weight[k] = cur_prob;
     probability_total += cur_prob;
-    number_possible_hospitals += increment;
-  } // end for loop
+  }
 
-  assert(static_cast<int>(hosp_probs.size()) == number_hospitals);
   if(number_possible_hospitals > 0) {
-    if(probability_total > 0.0) {
-      for(int i = 0; i < number_hospitals; ++i) {
-        hosp_probs[i] /= probability_total;
-      }
-    }
-
-    double rand = Random::draw_random();
-    double cum_prob = 0.0;
-    int i = 0;
-    while(i < number_hospitals) {
-      cum_prob += hosp_probs[i];
-      if(rand < cum_prob) {
-        return get_hospital(i);
-      }
-      ++i;
+    int k = select_hospital_from_weights(weight, probability_total);
+    if(k < 0) {
+      return get_hospital(number_hospitals - 1);
     }
-    return get_hospital(number_hospitals - 1);
+    return get_hospital(use_search_radius_limit ? catchment->local_hospitals[k] : k);
   } else {
     //No hospitals in the simulation match search criteria
     return NULL;
@@ -1961,129 +2083,59 @@ Hospital* Place_List::get_random_primary_care_facility_matching_criteria(Person*
     this->prepare_primary_care_assignment();
   }
 
-  int daily_hosp_cap = 0;
-  Hospital* assigned_hospital = NULL;
   int number_hospitals = this->hospitals.size();
   if(number_hospitals == 0) {
     Utils::fred_abort("No Hospitals in simulation that has Enabled Hospitalization", "");
   }
-  int number_possible_hospitals = 0;
   Household* hh = per->get_household();
   assert(hh != NULL);
-  //First, only try Hospitals within a certain radius (* that accept insurance)
-  std::vector<double> hosp_probs;
+
+  // hospitals outside the search radius never match, so only the local catchment is scanned
+  hospital_catchment_t* catchment = NULL;
+  static thread_local std::vector<double> all_distance;
+  int number_candidates = 0;
+  if(use_search_radius_limit) {
+    catchment = get_hospital_catchment(hh);
+    number_candidates = static_cast<int>(catchment->local_hospitals.size());
+  } else {
+    get_all_hospital_distances(hh, all_distance);
+    number_candidates = number_hospitals;
+  }
+
+  Insurance_assignment_index::e per_insur = Insurance_assignment_index::UNSET;
+  if(check_insurance) {
+    per_insur = per->get_health()->get_insurance_type();
+  }
+
+  int number_possible_hospitals = 0;
+  static thread_local std::vector<double> weight;
+  weight.resize(number_candidates);
   double probability_total = 0.0;
-  for(int i = 0; i < number_hospitals; ++i) {
+  for(int k = 0; k < number_candidates; ++k) {
+    int i = use_search_radius_limit ? catchment->local_hospitals[k] : k;
+    double distance = use_search_radius_limit ? catchment->local_distance[k] : all_distance[k];
     Hospital* hospital = get_hospital(i);
-    daily_hosp_cap = hospital->get_daily_patient_capacity(0);
-    double distance = distance_between_places(hh, hospital);
+    int daily_hosp_cap = hospital->get_daily_patient_capacity(0);
     double cur_prob = 0.0;
-    int increment = 0;
 
-    //Need to make sure place is open and not over capacity
-    if(distance > 0.0 && hospital->should_be_open(0)) {
-      if(use_search_radius_limit) {
-        if(distance <= Place_List::Hospitalization_radius) {
-          if(check_insurance) {
-            Insurance_assignment_index::e per_insur = per->get_health()->get_insurance_type();
-            if(hospital->accepts_insurance(per_insur)) {
-              //Hospital accepts the insurance so can check further
-              if(Place_List::Hospital_ID_current_assigned_size_map.at(hospital->get_id())
-		 < Place_List::Hospital_ID_total_assigned_size_map.at(hospital->get_id())) {
-                //Hospital accepts the insurance and it hasn't been filled so we are good
-                cur_prob = static_cast<double>(daily_hosp_cap) / (distance * distance);
-                increment = 1;
-              } else {
-                //Not possible
-                cur_prob = 0.0;
-                increment = 0;
-              }
-            } else {
-              //Not possible (Doesn't accept insurance)
-              cur_prob = 0.0;
-              increment = 0;
-            }
-          } else {
-            //We don't care about insurance so can check further
-            if(Place_List::Hospital_ID_current_assigned_size_map.at(hospital->get_id())
-	       < Place_List::Hospital_ID_total_assigned_size_map.at(hospital->get_id())) {
-              //Hospital accepts the insurance and it hasn't been filled so we are good
-              cur_prob = static_cast<double>(daily_hosp_cap) / (distance * distance);
-              increment = 1;
-            } else {
-              //Not possible
-              cur_prob = 0.0;
-              increment = 0;
-            }
-          }
-        } else {
-          //Not possible (not within the radius)
-          cur_prob = 0.0;
-          increment = 0;
-        }
-      } else { //Don't car about search radius
-        if(check_insurance) {
-          Insurance_assignment_index::e per_insur = per->get_health()->get_insurance_type();
-          if(hospital->accepts_insurance(per_insur)) {
-            //Hospital accepts the insurance so can check further
-            if(Place_List::Hospital_ID_current_assigned_size_map.at(hospital->get_id())
-	       < Place_List::Hospital_ID_total_assigned_size_map.at(hospital->get_id())) {
-              //Hospital accepts the insurance and it hasn't been filled so we are good
-              cur_prob = static_cast<double>(daily_hosp_cap) / (distance * distance);
-              increment = 1;
-            } else {
-              //Not possible
-              cur_prob = 0.0;
-              increment = 0;
-            }
-          } else {
-            //Not possible (Doesn't accept insurance)
-            cur_prob = 0.0;
-            increment = 0;
-          }
-        } else {
-          //We don't care about insurance so can check further
-          if(Place_List::Hospital_ID_current_assigned_size_map.at(hospital->get_id())
-	     < Place_List::Hospital_ID_total_assigned_size_map.at(hospital->get_id())) {
-            //Hospital accepts the insurance and it hasn't been filled so we are good
-            cur_prob = static_cast<double>(daily_hosp_cap) / (distance * distance);
-            increment = 1;
-          } else {
-            //Not possible
-            cur_prob = 0.0;
-            increment = 0;
-          }
-        }
-      }
-    } else {
-      //Not possible
-      cur_prob = 0.0;
-      increment = 0;
+    //Need to make sure place is open, accepts the insurance and its panel hasn't been filled
+    if(distance > 0.0 && hospital->should_be_open(0)
+       && (!check_insurance || hospital->accepts_insurance(per_insur))
+       && Place_List::Hospital_ID_current_assigned_size_map.at(hospital->get_id())
+       < Place_List::Hospital_ID_total_assigned_size_map.at(hospital->get_id())) {
+      cur_prob = static_cast<double>(daily_hosp_cap) / (distance * distance);
+      number_possible_hospitals++;
     }
-    hosp_probs.push_back(cur_prob);
+    weight[k] = cur_prob;
     probability_total += cur_prob;
-    number_possible_hospitals += increment;
-  }  // end for loop
+  }
 
-  assert(static_cast<int>(hosp_probs.size()) == number_hospitals);
   if(number_possible_hospitals > 0) {
-    if(probability_total > 0.0) {
-      for(int i = 0; i < number_hospitals; ++i) {
-        hosp_probs[i] /= probability_total;
-      }
+    int k = select_hospital_from_weights(weight, probability_total);
+    if(k < 0) {
+      return get_hospital(number_hospitals - 1);
     }
-
-    double rand = Random::draw_random();
-    double cum_prob = 0.0;
-    int i = 0;
-    while(i < number_hospitals) {
-      cum_prob += hosp_probs[i];
-      if(rand < cum_prob) {
-        return get_hospital(i);
-      }
-      ++i;
-    }
-    return get_hospital(number_hospitals - 1);
+    return get_hospital(use_search_radius_limit ? catchment->local_hospitals[k] : k);
   } else {
     //No hospitals in the simulation match search criteria
     return NULL;
@@ -2378,11 +2430,6 @@ Hospital* Place_List::get_hospital_assigned_to_household(Household* hh) {
       return NULL;
     }
   } else {
-    if(Place_List::Household_hospital_map_file_exists) {
-      //List is incomplete so set this so we can print out a new file
-      Place_List::Household_hospital_map_file_exists = false;
-    }
-
     Hospital* hosp = NULL;
     if(hh->get_size() > 0) {
       Person* per = hh->get_enrollee(0);
@@ -34,6 +34,7 @@ using namespace std;
 class Classroom;
 class County;
 class Office;
+class Regional_Patch;
 
 class Place_List {
 
@@ -136,6 +137,7 @@ public:
    * @param use_search_radius_limit whether or not to cap the search radius
    */
   Hospital* get_random_primary_care_facility_matching_criteria(Person* per, bool check_insurance, bool use_search_radius_limit);
+
   void end_of_run();
 
   // access methods
@@ -324,6 +326,27 @@ public:
     }
   }
 
+  /**
+   * Projected coordinates of the households and of the hospitals, in
+   * list order, for the batch distance functions in Geo. These are the
+   * only lists searched by distance as a whole; schools and workplaces
+   * are searched through the regional patches, which filter each place
+   * (by size, for example) before using its cached coordinates.
+   */
+  Geo::xy_coordinates_t & get_household_coordinates() {
+    return this->household_coordinates;
+  }
+
+  Geo::xy_coordinates_t & get_hospital_coordinates() {
+    return this->hospital_coordinates;
+  }
+
+  /**
+   * Indices of the households within radius km of the given location, in
+   * list order; all households if radius is not positive.
+   */
+  void get_households_within_radius(fred::geo lat, fred::geo lon, double radius, std::vector<int> & index);
+
   int get_number_of_location_ids() {
     return location_id.size();
   }
@@ -397,9 +420,23 @@ private:
   void read_hospital_file(char* location_file);
   void read_group_quarters_file(char* location_file);
 
-  void reassign_workers_to_schools();
-  void reassign_workers_to_hospitals();
-  void reassign_workers_to_group_quarters(char subtype, int fixed_staff, double resident_to_staff_ratio);
+  /**
+   * A place (school, hospital or group quarters) that takes all the
+   * workers of the nearest workplace whose size is close to the place's
+   * target staff.
+   */
+  typedef struct {
+    Place* place;
+    int staff;
+    Regional_Patch* regional_patch;
+    Place* nearby_workplace;
+  } worker_reassignment_t;
+
+  void add_school_reassignments(std::vector<worker_reassignment_t> & reassignments);
+  void add_hospital_reassignments(std::vector<worker_reassignment_t> & reassignments);
+  void add_group_quarters_reassignments(char subtype, int fixed_staff, double resident_to_staff_ratio,
+					std::vector<worker_reassignment_t> & reassignments);
+  void reassign_workers(worker_reassignment_t & reassignment);
   void prepare_primary_care_assignment();
 
   /**
@@ -413,6 +450,38 @@ private:
   Hospital* get_hospital_assigned_to_household(Household* hh);
   bool is_primary_care_assignment_initialized;
 
+  /**
+   * The hospital catchment of a household: the candidate hospitals and their
+   * distances from the household. These depend only on location, so they are
+   * computed once per household and shared by all searches made for its
+   * members; only bed/patient capacity, opening and insurance are checked per call.
+   * Only the hospitals within the search radius are kept. Catchments are
+   * built on first use and kept for the whole run.
+   */
+  typedef struct {
+    // candidates from the Regional_Layer ring search (overnight stays)
+    std::vector<Hospital*> nearby_hospitals;
+    std::vector<double> nearby_distance;
+    // indices into hospitals of those within Hospitalization_radius
+    std::vector<int> local_hospitals;
+    std::vector<double> local_distance;
+  } hospital_catchment_t;
+  typedef std::unordered_map<int, hospital_catchment_t*> HospitalCatchmentMapT;
+
+  HospitalCatchmentMapT hospital_catchment_map;
+  fred::Mutex hospital_catchment_mutex;
+
+  Geo::xy_coordinates_t household_coordinates;
+  Geo::xy_coordinates_t hospital_coordinates;
+  void setup_place_coordinates();
+
+  hospital_catchment_t* get_hospital_catchment(Household* hh);
+  void delete_hospital_catchments();
+  void get_nearby_hospital_distances(hospital_catchment_t* catchment, Household* hh);
+  void get_local_hospital_distances(hospital_catchment_t* catchment, Household* hh);
+  void get_all_hospital_distances(Household* hh, std::vector<double> & distance);
+  int select_hospital_from_weights(std::vector<double> & weight, double probability_total);
+
   // input files
   char MSA_file[FRED_STRING_SIZE];
   char Counties_file[FRED_STRING_SIZE];
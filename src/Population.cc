@@ -17,10 +17,13 @@
 // File: Population.cc
 //
 
+#include <algorithm>
 #include <unistd.h>
 
 #include "Activities.h"
 #include "Age_Map.h"
+#include "Async_Output.h"
+#include "Classroom.h"
 #include "Date.h"
 #include "Demographics.h"
 #include "Condition.h"
@@ -29,7 +32,9 @@
 #include "Global.h"
 #include "Health.h"
 #include "Household.h"
+#include "Office.h"
 #include "Params.h"
+#include "Partition.h"
 #include "Person.h"
 #include "Place_List.h"
 #include "Population.h"
@@ -47,7 +52,11 @@ Population::Population() {
 
   // clear_static_arrays();
   this->pop_size = 0;
+  this->natives = 0;
+  this->originals = 0;
   this->enable_copy_files = 0;
+  this->output_population = 0;
+  this->binary_population_output = 0;
 
   // reserve memory for lists
   this->death_list.reserve(1000);
@@ -74,6 +83,7 @@ void Population::get_parameters() {
       Params::get_param("pop_outfile", this->pop_outfile);
       Params::get_param("output_population_date_match",
 				    this->output_population_date_match);
+      Params::get_param("binary_population_output", &this->binary_population_output);
     }
     this->is_initialized = true;
   }
@@ -92,6 +102,8 @@ Person* Population::add_person_to_population(int age, char sex, int race, int re
   person->setup(idx, id, age, sex, race, rel, house, school, work, day, today_is_birthday);
   this->people.push_back(person);
   this->pop_size = this->people.size();
+  this->age_histogram.add(person);
+  this->natives++;
   return person;
 }
 
@@ -235,7 +247,7 @@ void Population::get_person_data(char* line, bool gq) {
   if(strcmp(work_label, "X") != 0 && work == NULL) {
     FRED_VERBOSE(2, "WARNING: person %s -- no workplace found for label = %s\n", label,
 		 work_label);
-    if(Global::Enable_Local_Workplace_Assignment) {
+    if(Global::Enable_Local_Workplace_Assignment && Partition::is_enabled() == false) {
       work = Global::Places.get_random_workplace();
       FRED_CONDITIONAL_VERBOSE(0, work != NULL, "WARNING: person %s assigned to workplace %s\n",
 			       label, work->get_label());
@@ -248,8 +260,19 @@ void Population::get_person_data(char* line, bool gq) {
   FRED_CONDITIONAL_VERBOSE(0, (strcmp(school_label,"X") != 0 && school == NULL),
 			   "WARNING: person %s -- no school found for label = %s\n", label, school_label);
 
-  add_person_to_population(age, sex, race, relationship, house,
-			   school, work, day, today_is_birthday);
+  Person* person = add_person_to_population(age, sex, race, relationship, house,
+					     school, work, day, today_is_birthday);
+
+  // in a partitioned run, a missing workplace or school may be held by
+  // another partition
+  if(Partition::is_enabled()) {
+    if(strcmp(work_label, "X") != 0 && work == NULL) {
+      Partition::add_remote_visit(person, 'W', work_label);
+    }
+    if(strcmp(school_label, "X") != 0 && school == NULL) {
+      Partition::add_remote_visit(person, 'S', school_label);
+    }
+  }
 }
 
 
@@ -270,6 +293,7 @@ void Population::read_all_populations() {
   for (int i = 0; i < people.size(); i++) {
     people[i]->set_original();
   }
+  this->originals = this->people.size();
 
   // report on time take to read populations
   Utils::fred_print_lap_time("reading populations");
@@ -337,8 +361,19 @@ void Population::delete_person_from_population(int day, Person* person) {
   FRED_VERBOSE(1, "DELETING PERSON: %d ...\n", person->get_id());
 
   person->terminate(day);
+  if(Partition::is_enabled()) {
+    Partition::terminate_person(person);
+  }
   FRED_VERBOSE(1, "DELETING PERSON: %d\n", person->get_id());
 
+  this->age_histogram.remove(person);
+  if(person->is_native()) {
+    this->natives--;
+  }
+  if(person->is_original()) {
+    this->originals--;
+  }
+
   // delete from population data structure
   int idx = person->get_pop_index();
 
@@ -382,43 +417,24 @@ void Population::report(int day) {
     if (2010 <= year && Date::get_month() == 6 && Date::get_day_of_month()==30) {
       int males[18];
       int females[18];
-      int male_count = 0;
-      int female_count = 0;
-      int natives = 0;
-      int originals = 0;
-      std::vector<double>ages;
-      ages.clear();
-      ages.reserve(this->get_population_size());
+      int male_count = this->age_histogram.get_males();
+      int female_count = this->age_histogram.get_females();
+      int natives = this->natives;
+      int originals = this->originals;
+      double median = this->age_histogram.get_median_age();
 
       for (int i = 0; i < 18; i++) {
 	males[i] = 0;
 	females[i] = 0;
       }
-      for(int p = 0; p < this->get_population_size(); ++p) {
-	Person* person = get_person(p);
-	int age = person->get_age();
-	ages.push_back(person->get_real_age());
+      for(int age = 0; age <= Demographics::MAX_AGE; ++age) {
 	int age_group = age / 5;
 	if (age_group > 17) { 
 	  age_group = 17;
 	}
-	if (person->get_sex()=='M') {
-	  males[age_group]++;
-	  male_count++;
-	}
-	else {
-	  females[age_group]++;
-	  female_count++;
-	}
-	if (person->is_native()) {
-	  natives++;
-	}
-	if (person->is_original()) {
-	  originals++;
-	}
+	males[age_group] += this->age_histogram.get_count(age, 'M');
+	females[age_group] += this->age_histogram.get_count(age, 'F');
       }
-      std::sort(ages.begin(), ages.end());
-      double median = ages[this->get_population_size()/2];
 
       char filename[FRED_STRING_SIZE];
       sprintf(filename, "%s/pop-%d.txt",
@@ -494,51 +510,74 @@ void Population::quality_control() {
   }
 
   if(Global::Verbose > 0) {
-    int n0, n5, n18, n50, n65;
-    int count[20];
-    int total = 0;
-    n0 = n5 = n18 = n50 = n65 = 0;
-    // age distribution
-    for(int c = 0; c < 20; ++c) {
-      count[c] = 0;
-    }
-    for(int p = 0; p < this->get_population_size(); ++p) {
-      Person* person = get_person(p);
-      int a = person->get_age();
-
-      if(a < 5) {
-        n0++;
-      } else if(a < 18) {
-        n5++;
-      } else if(a < 50) {
-        n18++;
-      } else if(a < 65) {
-        n50++;
-      }else {
-        n65++;
-      }
-      int n = a / 5;
-      if(n < 20) {
-        count[n]++;
-      } else {
-        count[19]++;
-      }
-      total++;
+    report_age_distribution();
+  }
+  FRED_STATUS(0, "population quality control finished\n");
+}
+
+void Population::report_age_distribution() {
+  int n0, n5, n18, n50, n65;
+  int count[20];
+  int total = this->age_histogram.get_total();
+  n0 = n5 = n18 = n50 = n65 = 0;
+  // age distribution
+  for(int c = 0; c < 20; ++c) {
+    count[c] = 0;
+  }
+  for(int a = 0; a <= Demographics::MAX_AGE; ++a) {
+    int people = this->age_histogram.get_count(a);
+    if(a < 5) {
+      n0 += people;
+    } else if(a < 18) {
+      n5 += people;
+    } else if(a < 50) {
+      n18 += people;
+    } else if(a < 65) {
+      n50 += people;
+    }else {
+      n65 += people;
     }
-    fprintf(Global::Statusfp, "\nAge distribution: %d people\n", total);
-    for(int c = 0; c < 20; ++c) {
-      fprintf(Global::Statusfp, "age %2d to %d: %6d (%.2f%%)\n", 5 * c, 5 * (c + 1) - 1, count[c],
-	      (100.0 * count[c]) / total);
+    int n = a / 5;
+    if(n < 20) {
+      count[n] += people;
+    } else {
+      count[19] += people;
     }
-    fprintf(Global::Statusfp, "AGE 0-4: %d %.2f%%\n", n0, (100.0 * n0) / total);
-    fprintf(Global::Statusfp, "AGE 5-17: %d %.2f%%\n", n5, (100.0 * n5) / total);
-    fprintf(Global::Statusfp, "AGE 18-49: %d %.2f%%\n", n18, (100.0 * n18) / total);
-    fprintf(Global::Statusfp, "AGE 50-64: %d %.2f%%\n", n50, (100.0 * n50) / total);
-    fprintf(Global::Statusfp, "AGE 65-100: %d %.2f%%\n", n65, (100.0 * n65) / total);
-    fprintf(Global::Statusfp, "\n");
+  }
+  fprintf(Global::Statusfp, "\nAge distribution: %d people\n", total);
+  for(int c = 0; c < 20; ++c) {
+    fprintf(Global::Statusfp, "age %2d to %d: %6d (%.2f%%)\n", 5 * c, 5 * (c + 1) - 1, count[c],
+	    (100.0 * count[c]) / total);
+  }
+  fprintf(Global::Statusfp, "AGE 0-4: %d %.2f%%\n", n0, (100.0 * n0) / total);
+  fprintf(Global::Statusfp, "AGE 5-17: %d %.2f%%\n", n5, (100.0 * n5) / total);
+  fprintf(Global::Statusfp, "AGE 18-49: %d %.2f%%\n", n18, (100.0 * n18) / total);
+  fprintf(Global::Statusfp, "AGE 50-64: %d %.2f%%\n", n50, (100.0 * n50) / total);
+  fprintf(Global::Statusfp, "AGE 65-100: %d %.2f%%\n", n65, (100.0 * n65) / total);
+  fprintf(Global::Statusfp, "\n");
+}
 
+void Population::unset_native(Person* person) {
+  if(person->is_native()) {
+    person->unset_native();
+    this->natives--;
   }
-  FRED_STATUS(0, "population quality control finished\n");
+}
+
+// Comparison used to put the enrollees of a place in population order
+static bool compare_pop_index(Person* p1, Person* p2) {
+  return p1->get_pop_index() < p2->get_pop_index();
+}
+
+// the enrollees of the place in population order, so that they are
+// handled in the order of a loop over the population
+static void get_enrollees_in_population_order(Place* place, std::vector<Person*> & enrollees) {
+  int size = place->get_size();
+  enrollees.resize(size);
+  for(int i = 0; i < size; ++i) {
+    enrollees[i] = place->get_enrollee(i);
+  }
+  std::sort(enrollees.begin(), enrollees.end(), compare_pop_index);
 }
 
 void Population::assign_classrooms() {
@@ -546,10 +585,21 @@ void Population::assign_classrooms() {
     fprintf(Global::Statusfp, "assign classrooms entered\n");
     fflush(Global::Statusfp);
   }
-  for(int p = 0; p < this->get_population_size(); ++p) {
-    Person* person = get_person(p);
-    if(person->get_school() != NULL) {
-      person->assign_classroom();
+  // classrooms are assigned round-robin within each school, so the
+  // schools can be handled in parallel
+  int number_of_schools = Global::Places.get_number_of_schools();
+#pragma omp parallel
+  {
+    std::vector<Person*> students;
+#pragma omp for schedule(dynamic)
+    for(int p = 0; p < number_of_schools; ++p) {
+      School* school = Global::Places.get_school(p);
+      get_enrollees_in_population_order(school, students);
+      for(int i = 0; i < (int) students.size(); ++i) {
+	if(students[i]->get_school() == school) {
+	  students[i]->assign_classroom();
+	}
+      }
     }
   }
   FRED_VERBOSE(0,"assign classrooms finished\n");
@@ -560,10 +610,21 @@ void Population::assign_offices() {
     fprintf(Global::Statusfp, "assign offices entered\n");
     fflush(Global::Statusfp);
   }
-  for(int p = 0; p < this->get_population_size(); ++p) {
-    Person* person = get_person(p);
-    if(person->get_workplace() != NULL) {
-      person->assign_office();
+  // offices are assigned round-robin within each workplace, so the
+  // workplaces can be handled in parallel
+  int number_of_workplaces = Global::Places.get_number_of_workplaces();
+#pragma omp parallel
+  {
+    std::vector<Person*> workers;
+#pragma omp for schedule(dynamic)
+    for(int p = 0; p < number_of_workplaces; ++p) {
+      Place* workplace = Global::Places.get_workplace(p);
+      get_enrollees_in_population_order(workplace, workers);
+      for(int i = 0; i < (int) workers.size(); ++i) {
+	if(workers[i]->get_workplace() == workplace) {
+	  workers[i]->assign_office();
+	}
+      }
     }
   }
   FRED_VERBOSE(0,"assign offices finished\n");
@@ -1378,19 +1439,95 @@ void Population::write_population_output_file(int day) {
 
   //Loop over the whole population and write the output of each Person's to_string to the file
   char population_output_file[FRED_STRING_SIZE];
-  sprintf(population_output_file, "%s/%s_%s.txt", Global::Output_directory, this->pop_outfile,
-	  Date::get_date_string().c_str());
-  FILE* fp = fopen(population_output_file, "w");
+  Utils::fred_snprintf(population_output_file, sizeof(population_output_file), "%s/%s_%s.%s", Global::Output_directory, this->pop_outfile,
+	  Date::get_date_string().c_str(), this->binary_population_output ? "bin" : "txt");
+  FILE* fp = Async_Output::open(population_output_file, "w");
   if(fp == NULL) {
     Utils::fred_abort("Help! population_output_file %s not found\n", population_output_file);
   }
 
-  for(int p = 0; p < this->get_population_size(); ++p) {
-    Person* person = get_person(p);
-    fprintf(fp, "%s\n", person->to_string().c_str());
+  if(this->binary_population_output) {
+    const char header[8] = { 'F', 'R', 'E', 'D', 'P', 'O', 'P', 1 };
+    Async_Output::write(fp, header, 8);
+  }
+
+  // each thread formats its own block of people into its own buffer,
+  // and the buffers are written in order. The buffers keep their memory
+  // from one snapshot to the next.
+  int threads = fred::omp_get_max_threads();
+  this->snapshot_buffers.resize(threads);
+  int size = this->get_population_size();
+  for(int first = 0; first < size; first += threads * SNAPSHOT_BLOCK) {
+#pragma omp parallel for schedule(static,1)
+    for(int t = 0; t < threads; ++t) {
+      int begin = first + t * SNAPSHOT_BLOCK;
+      int end = (begin + SNAPSHOT_BLOCK < size ? begin + SNAPSHOT_BLOCK : size);
+      this->snapshot_buffers[t].clear();
+      if(begin >= end) {
+	continue;
+      }
+      if(this->binary_population_output) {
+	format_population_columns(this->snapshot_buffers[t], begin, end);
+      } else {
+	format_population_text(this->snapshot_buffers[t], begin, end);
+      }
+    }
+    for(int t = 0; t < threads; ++t) {
+      if(this->snapshot_buffers[t].empty() == false) {
+	Async_Output::write(fp, this->snapshot_buffers[t]);
+      }
+    }
+  }
+  Async_Output::close(fp);
+}
+
+void Population::format_population_text(std::string &buffer, int begin, int end) {
+  char line[FRED_STRING_SIZE];
+  for(int p = begin; p < end; ++p) {
+    int length = get_person(p)->to_string(line, FRED_STRING_SIZE - 1);
+    if(length > FRED_STRING_SIZE - 2) {
+      length = FRED_STRING_SIZE - 2;
+    }
+    line[length] = '\n';
+    buffer.append(line, length + 1);
+  }
+}
+
+static void append_int32(std::string &buffer, int value) {
+  unsigned int u = (unsigned int) value;
+  char bytes[4] = { (char) (u & 0xff), (char) ((u >> 8) & 0xff), (char) ((u >> 16) & 0xff), (char) (u >> 24) };
+  buffer.append(bytes, 4);
+}
+
+static int get_place_id(Place* place) {
+  return (place == NULL ? -1 : place->get_id());
+}
+
+void Population::format_population_columns(std::string &buffer, int begin, int end) {
+  int n = end - begin;
+  append_int32(buffer, n);
+  for(int column = 0; column < 13; ++column) {
+    for(int p = begin; p < end; ++p) {
+      Person* person = get_person(p);
+      int value = 0;
+      switch(column) {
+      case 0: value = person->get_id(); break;
+      case 1: value = person->get_age(); break;
+      case 2: value = person->get_sex(); break;
+      case 3: value = person->get_race(); break;
+      case 4: value = get_place_id(person->get_household()); break;
+      case 5: value = get_place_id(person->get_school()); break;
+      case 6: value = get_place_id(person->get_classroom()); break;
+      case 7: value = get_place_id(person->get_workplace()); break;
+      case 8: value = get_place_id(person->get_office()); break;
+      case 9: value = get_place_id(person->get_neighborhood()); break;
+      case 10: value = get_place_id(person->get_hospital()); break;
+      case 11: value = get_place_id(person->get_ad_hoc()); break;
+      case 12: value = person->get_relationship(); break;
+      }
+      append_int32(buffer, value);
+    }
   }
-  fflush(fp);
-  fclose(fp);
 }
 
 void Population::get_age_distribution(int* count_males_by_age, int* count_females_by_age) {
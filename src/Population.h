@@ -29,6 +29,7 @@ using namespace std;
 class Person;
 class Place;
 
+#include "Age_Histogram.h"
 #include "Global.h"
 #include "Utils.h"
 
@@ -156,6 +157,11 @@ public:
    */
   void quality_control();
 
+  /**
+   * Print the age distribution of the population to the status file.
+   */
+  void report_age_distribution();
+
   /**
    * Perform end of run operations (clean up)
    */
@@ -171,6 +177,27 @@ public:
 
   void get_age_distribution(int* count_males_by_age, int* count_females_by_age);
 
+  const Age_Histogram* get_age_histogram() const {
+    return &this->age_histogram;
+  }
+
+  /**
+   * Move the given person out of the age histogram before a change of
+   * age (see Demographics::birthday) ...
+   */
+  void decrement_age_count(Person* person) {
+    this->age_histogram.remove(person);
+  }
+
+  /**
+   * ... and back in afterwards.
+   */
+  void increment_age_count(Person* person) {
+    this->age_histogram.add(person);
+  }
+
+  void unset_native(Person* person);
+
   // initialization methods
 
   void initialize_activities();
@@ -198,6 +225,12 @@ private:
   int pop_size;
   int next_id;
 
+  // demographic aggregates, kept up to date as people are added,
+  // removed and have birthdays, so that the reports need no scan
+  Age_Histogram age_histogram;
+  int natives;
+  int originals;
+
   // used during input
   bool is_initialized;
   bool load_completed;
@@ -210,7 +243,14 @@ private:
   int output_population;
   char pop_outfile[FRED_STRING_SIZE];
   char output_population_date_match[FRED_STRING_SIZE];
+  int binary_population_output;
+  std::vector<std::string> snapshot_buffers;
   void write_population_output_file(int day);
+  void format_population_text(std::string &buffer, int begin, int end);
+  void format_population_columns(std::string &buffer, int begin, int end);
+
+  // the number of people formatted at a time by each thread
+  static const int SNAPSHOT_BLOCK = 16384;
 
 };
 
@@ -0,0 +1,278 @@
+/*
+  This file is part of the FRED system.
+
+  Copyright (c) 2013-2016, University of Pittsburgh, John Grefenstette,
+  David Galloway, Mary Krauland, Michael Lann, and Donald Burke.
+
+  Based in part on FRED Version 2.9, created in 2010-2013 by
+  John Grefenstette, Shawn Brown, Roni Rosenfield, Alona Fyshe, David
+  Galloway, Nathan Stone, Jay DePasse, Anuroop Sriram, and Donald Burke.
+
+  Licensed under the BSD 3-Clause license.  See the file "LICENSE" for
+  more information.
+*/
+
+//
+//
+// File: Profiler.cc
+//
+
+#include <map>
+#include <string>
+
+#include "Profiler.h"
+#include "Params.h"
+#include "Utils.h"
+
+bool Profiler::enabled = false;
+Profiler::thread_zones_t Profiler::thread_zones[Global::MAX_NUM_THREADS];
+
+void Profiler::get_parameters() {
+  int temp_int = 0;
+  Params::get_param("enable_profiling", &temp_int);
+  Profiler::enabled = (temp_int == 0 ? false : true);
+  Profiler::reset();
+}
+
+int Profiler::enter(const char* name) {
+  thread_zones_t* tz = &(Profiler::thread_zones[fred::omp_get_thread_num()]);
+  if(tz->zones.empty()) {
+    Profiler::reset_thread(tz);
+  }
+  zone_t* parent = tz->zones[tz->current];
+  int size = parent->children.size();
+  for(int i = 0; i < size; ++i) {
+    int child = parent->children[i];
+    if(strcmp(tz->zones[child]->name, name) == 0) {
+      tz->current = child;
+      return child;
+    }
+  }
+
+  // first visit to this zone under this parent
+  zone_t* z = new zone_t;
+  strncpy(z->name, name, FRED_STRING_SIZE - 1);
+  z->name[FRED_STRING_SIZE - 1] = '\0';
+  z->parent = tz->current;
+  z->count = 0;
+  z->total = 0;
+  z->min = 0;
+  z->max = 0;
+  memset(z->histogram, 0, sizeof(z->histogram));
+  int child = tz->zones.size();
+  tz->zones.push_back(z);
+  parent->children.push_back(child);
+  tz->current = child;
+  return child;
+}
+
+void Profiler::leave(int zone, long long nanoseconds) {
+  thread_zones_t* tz = &(Profiler::thread_zones[fred::omp_get_thread_num()]);
+  zone_t* z = tz->zones[zone];
+  if(z->count == 0 || nanoseconds < z->min) {
+    z->min = nanoseconds;
+  }
+  if(nanoseconds > z->max) {
+    z->max = nanoseconds;
+  }
+  z->count++;
+  z->total += nanoseconds;
+  z->histogram[Profiler::get_bin(nanoseconds)]++;
+  tz->current = z->parent;
+}
+
+void Profiler::reset() {
+  for(int t = 0; t < Global::MAX_NUM_THREADS; ++t) {
+    Profiler::reset_thread(&(Profiler::thread_zones[t]));
+  }
+}
+
+void Profiler::reset_thread(thread_zones_t* tz) {
+  for(int i = 0; i < (int) tz->zones.size(); ++i) {
+    delete tz->zones[i];
+  }
+  tz->zones.clear();
+
+  // zone 0 is the unnamed root of the thread's tree
+  zone_t* root = new zone_t;
+  root->name[0] = '\0';
+  root->parent = 0;
+  root->count = 0;
+  root->total = 0;
+  root->min = 0;
+  root->max = 0;
+  memset(root->histogram, 0, sizeof(root->histogram));
+  tz->zones.push_back(root);
+  tz->current = 0;
+}
+
+int Profiler::get_bin(long long nanoseconds) {
+  if(nanoseconds < 4) {
+    return (nanoseconds < 0 ? 0 : (int) nanoseconds);
+  }
+  // the exponent selects a group of four bins and the next two bits
+  // below the leading bit select the bin within the group
+  int exponent = 63 - __builtin_clzll((unsigned long long) nanoseconds);
+  int fraction = (int) ((nanoseconds >> (exponent - 2)) & 3);
+  return 4 * (exponent - 1) + fraction;
+}
+
+double Profiler::get_bin_midpoint(int bin) {
+  if(bin < 4) {
+    return bin;
+  }
+  int exponent = bin / 4 + 1;
+  double low = (double) (4 + bin % 4) * (double) (1ULL << (exponent - 2));
+  double width = (double) (1ULL << (exponent - 2));
+  return low + 0.5 * width;
+}
+
+double Profiler::get_percentile(const long long* histogram, long long count, double p) {
+  long long rank = (long long) (p * count);
+  if(rank >= count) {
+    rank = count - 1;
+  }
+  long long seen = 0;
+  for(int bin = 0; bin < NUMBER_OF_BINS; ++bin) {
+    seen += histogram[bin];
+    if(seen > rank) {
+      return Profiler::get_bin_midpoint(bin);
+    }
+  }
+  return 0.0;
+}
+
+void Profiler::end_of_run() {
+  if(Profiler::enabled == false) {
+    return;
+  }
+
+  // merge the per-thread trees by zone path, in order of first appearance
+  typedef struct merged_zone {
+    std::string path;
+    int depth;
+    int parent;
+    int threads;
+    long long count;
+    long long total;
+    long long min;
+    long long max;
+    long long histogram[NUMBER_OF_BINS];
+  } merged_zone_t;
+
+  std::vector<merged_zone_t*> merged;
+  std::map<std::string, int> merged_index;
+  std::vector<int> merged_of_zone;
+  std::vector<int> stack;
+  for(int t = 0; t < Global::MAX_NUM_THREADS; ++t) {
+    thread_zones_t* tz = &(Profiler::thread_zones[t]);
+    if(tz->zones.size() < 2) {
+      continue;
+    }
+    merged_of_zone.assign(tz->zones.size(), -1);
+    stack.clear();
+    for(int i = tz->zones[0]->children.size() - 1; i >= 0; --i) {
+      stack.push_back(tz->zones[0]->children[i]);
+    }
+    while(stack.empty() == false) {
+      int zone = stack.back();
+      stack.pop_back();
+      zone_t* z = tz->zones[zone];
+      int parent = (z->parent == 0 ? -1 : merged_of_zone[z->parent]);
+      std::string path = (parent < 0 ? std::string(z->name) : merged[parent]->path + "/" + z->name);
+      std::map<std::string, int>::iterator found = merged_index.find(path);
+      merged_zone_t* m;
+      if(found == merged_index.end()) {
+	m = new merged_zone_t;
+	m->path = path;
+	m->depth = (parent < 0 ? 0 : merged[parent]->depth + 1);
+	m->parent = parent;
+	m->threads = 0;
+	m->count = 0;
+	m->total = 0;
+	m->min = z->min;
+	m->max = z->max;
+	memset(m->histogram, 0, sizeof(m->histogram));
+	merged_of_zone[zone] = merged.size();
+	merged_index[path] = merged.size();
+	merged.push_back(m);
+      } else {
+	merged_of_zone[zone] = found->second;
+	m = merged[found->second];
+      }
+      if(z->count > 0) {
+	if(m->count == 0 || z->min < m->min) {
+	  m->min = z->min;
+	}
+	if(z->max > m->max) {
+	  m->max = z->max;
+	}
+	m->threads++;
+	m->count += z->count;
+	m->total += z->total;
+	for(int bin = 0; bin < NUMBER_OF_BINS; ++bin) {
+	  m->histogram[bin] += z->histogram[bin];
+	}
+      }
+      for(int i = z->children.size() - 1; i >= 0; --i) {
+	stack.push_back(z->children[i]);
+      }
+    }
+  }
+
+  // top-level zones are reported as a share of their sum
+  long long top_level_total = 0;
+  for(int i = 0; i < (int) merged.size(); ++i) {
+    if(merged[i]->parent < 0) {
+      top_level_total += merged[i]->total;
+    }
+  }
+
+  char filename[FRED_STRING_SIZE];
+  Utils::fred_snprintf(filename, sizeof(filename), "%s/RUN%d/profile.csv", Global::Simulation_directory, Global::Simulation_run_number);
+  FILE* csvfp = fopen(filename, "w");
+  Utils::fred_snprintf(filename, sizeof(filename), "%s/RUN%d/profile.json", Global::Simulation_directory, Global::Simulation_run_number);
+  FILE* jsonfp = fopen(filename, "w");
+  if(csvfp == NULL || jsonfp == NULL) {
+    Utils::fred_abort("Profiler: can't open profile files in %s/RUN%d\n",
+		      Global::Simulation_directory, Global::Simulation_run_number);
+  }
+
+  fprintf(csvfp, "zone,depth,threads,count,total_seconds,mean_seconds,min_seconds,max_seconds,p50_seconds,p90_seconds,p99_seconds,percent_of_parent\n");
+  fprintf(jsonfp, "{\n  \"run\": %d,\n  \"zones\": [", Global::Simulation_run_number);
+  for(int i = 0; i < (int) merged.size(); ++i) {
+    merged_zone_t* m = merged[i];
+    long long parent_total = (m->parent < 0 ? top_level_total : merged[m->parent]->total);
+    double percent = (parent_total > 0 ? 100.0 * m->total / parent_total : 0.0);
+    double mean = (m->count > 0 ? 1e-9 * m->total / m->count : 0.0);
+    double p50 = 1e-9 * Profiler::get_percentile(m->histogram, m->count, 0.50);
+    double p90 = 1e-9 * Profiler::get_percentile(m->histogram, m->count, 0.90);
+    double p99 = 1e-9 * Profiler::get_percentile(m->histogram, m->count, 0.99);
+
+    // zone names come from condition names and fixed strings, so only
+    // quotes and backslashes need escaping
+    std::string quoted;
+    for(int c = 0; c < (int) m->path.size(); ++c) {
+      if(m->path[c] == '"' || m->path[c] == '\\') {
+	quoted += '\\';
+      }
+      quoted += m->path[c];
+    }
+
+    fprintf(csvfp, "\"%s\",%d,%d,%lld,%.9f,%.9f,%.9f,%.9f,%.9f,%.9f,%.9f,%.2f\n",
+	    m->path.c_str(), m->depth, m->threads, m->count, 1e-9 * m->total, mean,
+	    1e-9 * m->min, 1e-9 * m->max, p50, p90, p99, percent);
+    fprintf(jsonfp, "%s\n    {\"zone\": \"%s\", \"depth\": %d, \"threads\": %d, \"count\": %lld, "
+	    "\"total_seconds\": %.9f, \"mean_seconds\": %.9f, \"min_seconds\": %.9f, \"max_seconds\": %.9f, "
+	    "\"p50_seconds\": %.9f, \"p90_seconds\": %.9f, \"p99_seconds\": %.9f, \"percent_of_parent\": %.2f}",
+	    (i == 0 ? "" : ","), quoted.c_str(), m->depth, m->threads, m->count, 1e-9 * m->total, mean,
+	    1e-9 * m->min, 1e-9 * m->max, p50, p90, p99, percent);
+  }
+  fprintf(jsonfp, "\n  ]\n}\n");
+  fclose(csvfp);
+  fclose(jsonfp);
+
+  for(int i = 0; i < (int) merged.size(); ++i) {
+    delete merged[i];
+  }
+}
@@ -0,0 +1,155 @@
+/*
+  This file is part of the FRED system.
+
+  Copyright (c) 2013-2016, University of Pittsburgh, John Grefenstette,
+  David Galloway, Mary Krauland, Michael Lann, and Donald Burke.
+
+  Based in part on FRED Version 2.9, created in 2010-2013 by
+  John Grefenstette, Shawn Brown, Roni Rosenfield, Alona Fyshe, David
+  Galloway, Nathan Stone, Jay DePasse, Anuroop Sriram, and Donald Burke.
+
+  Licensed under the BSD 3-Clause license.  See the file "LICENSE" for
+  more information.
+*/
+
+//
+//
+// File: Profiler.h
+//
+
+#ifndef _FRED_PROFILER_H
+#define _FRED_PROFILER_H
+
+#include <chrono>
+#include <vector>
+
+#include "Global.h"
+
+/**
+ * Hierarchical phase profiler.
+ *
+ * A zone is a named phase of the simulation. Zones nest: a zone opened
+ * while another zone is open on the same thread becomes its child, so
+ * the same name may appear under several parents (e.g. the "household"
+ * transmission zone under each condition). Each thread accumulates into
+ * its own tree of zones; the trees are merged by path when the run
+ * ends and written to RUN<n>/profile.csv and RUN<n>/profile.json.
+ *
+ * Profiling is off unless the parameter enable_profiling is set, in
+ * which case opening a zone costs a clock read and a short scan of the
+ * parent's children.
+ */
+class Profiler {
+public:
+
+  /**
+   * Read the enable_profiling parameter.
+   */
+  static void get_parameters();
+
+  static bool is_enabled() {
+    return Profiler::enabled;
+  }
+
+  /**
+   * Open the zone with the given name under the current zone of the
+   * calling thread and make it current.
+   *
+   * @param name the zone name; copied on the first visit
+   * @return the index of the zone in the calling thread's tree
+   */
+  static int enter(const char* name);
+
+  /**
+   * Close the given zone and make its parent current.
+   *
+   * @param zone the index returned by enter()
+   * @param nanoseconds the time spent in the zone
+   */
+  static void leave(int zone, long long nanoseconds);
+
+  /**
+   * Discard everything accumulated so far.
+   */
+  static void reset();
+
+  /**
+   * Write the per-zone counts, totals and percentiles for the current
+   * run to RUN<n>/profile.csv and RUN<n>/profile.json.
+   */
+  static void end_of_run();
+
+private:
+  // durations are binned on a log scale with four bins per power of
+  // two, which bounds the error of a reported percentile to 12.5%
+  static const int NUMBER_OF_BINS = 256;
+
+  typedef struct zone {
+    char name[FRED_STRING_SIZE];
+    int parent;
+    std::vector<int> children;
+    long long count;
+    long long total;
+    long long min;
+    long long max;
+    long long histogram[NUMBER_OF_BINS];
+  } zone_t;
+
+  typedef struct thread_zones {
+    std::vector<zone_t*> zones;
+    int current;
+  } thread_zones_t;
+
+  static int get_bin(long long nanoseconds);
+  static double get_bin_midpoint(int bin);
+  static double get_percentile(const long long* histogram, long long count, double p);
+  static void reset_thread(thread_zones_t* tz);
+
+  static bool enabled;
+  static thread_zones_t thread_zones[Global::MAX_NUM_THREADS];
+};
+
+
+/**
+ * A profiler zone that is open for the lifetime of the object.
+ *
+ *   {
+ *     Profiler_Zone zone("update places");
+ *     Global::Places.update(day);
+ *   }
+ *
+ * A zone may also be closed early with stop(), as long as zones on the
+ * same thread are still closed in the reverse order they were opened.
+ */
+class Profiler_Zone {
+public:
+  Profiler_Zone(const char* name) {
+    if(Profiler::is_enabled()) {
+      this->zone = Profiler::enter(name);
+      this->start = std::chrono::steady_clock::now();
+    } else {
+      this->zone = -1;
+    }
+  }
+
+  ~Profiler_Zone() {
+    stop();
+  }
+
+  void stop() {
+    if(this->zone >= 0) {
+      std::chrono::steady_clock::time_point stop_time = std::chrono::steady_clock::now();
+      Profiler::leave(this->zone, std::chrono::duration_cast<std::chrono::nanoseconds>(stop_time - this->start).count());
+      this->zone = -1;
+    }
+  }
+
+private:
+  Profiler_Zone(const Profiler_Zone&);
+  Profiler_Zone& operator=(const Profiler_Zone&);
+
+  int zone;
+  std::chrono::steady_clock::time_point start;
+};
+
+#endif // _FRED_PROFILER_H
@@ -17,15 +17,18 @@
 // File: Random.cc
 //
 #include "Random.h"
+#include <sstream>
 #include <stdio.h>
 
 Thread_RNG Random::Random_Number_Generator;
 
 Thread_RNG::Thread_RNG() {
+  this->metaseed = 0;
   thread_rng = new RNG [fred::omp_get_max_threads()];
 }
 
 void Thread_RNG::set_seed(unsigned long metaseed) {
+  this->metaseed = metaseed;
   std::mt19937_64 seed_generator;
   seed_generator.seed(metaseed);
   for(int t = 0; t < fred::omp_get_max_threads(); ++t) {
@@ -34,11 +37,36 @@ void Thread_RNG::set_seed(unsigned long metaseed) {
   }
 }
 
+// mixes one more value into a seed (the splitmix64 finalizer), so that
+// nearby phases and entities get unrelated seeds
+static unsigned long long mix_seed(unsigned long long seed, unsigned long long value) {
+  unsigned long long z = seed + 0x9e3779b97f4a7c15ULL * (value + 1);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+void Thread_RNG::begin_entity_stream(int phase, long long entity) {
+  static thread_local RNG stream;
+  stream.restart(mix_seed(mix_seed(this->metaseed, phase), entity));
+  entity_rng() = &stream;
+}
+
+void Thread_RNG::end_entity_stream() {
+  entity_rng() = NULL;
+}
+
 
 void RNG::set_seed(unsigned long seed) {
   mt_engine.seed(seed);
 }
 
+void RNG::restart(unsigned long seed) {
+  mt_engine.seed(seed);
+  unif_dist.reset();
+  normal_dist.reset();
+}
+
 int RNG::draw_from_distribution(int n, double* dist) {
   double r = random();
   int i = 0;
@@ -200,22 +228,59 @@ void RNG::build_lognormal_cdf(double mu, double sigma, std::vector<double> &cdf)
 }
 
 void RNG::sample_range_without_replacement(int N, int s, int* result) {
-  std::vector<bool> selected(N, false);
-  for(int n = 0; n < s; ++n) {
-    int i = random_int(0, N - 1);
-    if(selected[i]) {
-      if(i < N - 1 && !(selected[i + 1])) {
-        ++i;
-      } else if(i > 0 && !(selected[i - 1])) {
-        --i;
-      } else {
-        --n;
-        continue;
-      }
+  assert(0 <= s && s <= N);
+
+  // partial Fisher-Yates shuffle of the first s positions of an identity
+  // permutation; the scratch buffer only grows, and the swaps are undone
+  // afterwards so that it is the identity again for the next call
+  int size = this->sample_scratch.size();
+  if(size < N) {
+    this->sample_scratch.resize(N);
+    for(int i = size; i < N; ++i) {
+      this->sample_scratch[i] = i;
     }
-    selected[i] = true;
-    result[n] = i;
+  }
+  if((int) this->sample_swaps.size() < s) {
+    this->sample_swaps.resize(s);
+  }
+  for(int n = 0; n < s; ++n) {
+    int i = random_int(n, N - 1);
+    this->sample_swaps[n] = i;
+    int tmp = this->sample_scratch[n];
+    this->sample_scratch[n] = this->sample_scratch[i];
+    this->sample_scratch[i] = tmp;
+    result[n] = this->sample_scratch[n];
+  }
+  for(int n = s - 1; n >= 0; --n) {
+    int i = this->sample_swaps[n];
+    int tmp = this->sample_scratch[n];
+    this->sample_scratch[n] = this->sample_scratch[i];
+    this->sample_scratch[i] = tmp;
+  }
+}
+
+void RNG::shuffle_range(int N, int* result) {
+  assert(0 <= N);
+
+  // Fisher-Yates shuffle of an identity permutation, built in place
+  for(int i = 0; i < N; ++i) {
+    result[i] = i;
+  }
+  for(int n = 0; n < N; ++n) {
+    int i = random_int(n, N - 1);
+    int tmp = result[n];
+    result[n] = result[i];
+    result[i] = tmp;
   }
 }
 
+std::string RNG::get_state() {
+  std::ostringstream state;
+  state << mt_engine << " " << unif_dist << " " << normal_dist;
+  return state.str();
+}
 
+void RNG::set_state(const std::string &state) {
+  std::istringstream input(state);
+  input >> mt_engine >> unif_dist >> normal_dist;
+}
@@ -22,6 +22,7 @@
 
 #include <vector>
 #include <random>
+#include <string>
 #include "Global.h"
 using namespace std;
 
@@ -29,6 +30,13 @@ class RNG {
 
 public:
   void set_seed(unsigned long seed);
+
+  /**
+   * Seed the engine and drop any values the distributions have cached,
+   * so that the draws depend only on the seed.
+   */
+  void restart(unsigned long seed);
+
   double random() {
     return unif_dist(mt_engine);
   }
@@ -44,11 +52,23 @@ public:
   void build_binomial_cdf(double p, int n, std::vector<double> &cdf);
   void build_lognormal_cdf(double mu, double sigma, std::vector<double> &cdf);
   void sample_range_without_replacement(int N, int s, int* result);
+  void shuffle_range(int N, int* result);
+
+  /**
+   * The state of the engine and distributions, as text.
+   */
+  std::string get_state();
+  void set_state(const std::string &state);
 
 private:
   std::mt19937_64 mt_engine;
   std::uniform_real_distribution<double> unif_dist;
   std::normal_distribution<double> normal_dist;
+
+  // identity permutation of 0..size-1 used (and restored) by
+  // sample_range_without_replacement, and the swaps made on it
+  std::vector<int> sample_scratch;
+  std::vector<int> sample_swaps;
 };
 
 
@@ -58,41 +78,68 @@ public:
 
   void set_seed(unsigned long seed);
   double get_random() {
-    return thread_rng[fred::omp_get_thread_num()].random();
+    return get_rng()->random();
   }
   double get_random(double low, double high) {
-    return low + (high-low)*thread_rng[fred::omp_get_thread_num()].random();
+    return low + (high-low)*get_rng()->random();
   }
   int get_random_int(int low, int high) {
-    return thread_rng[fred::omp_get_thread_num()].random_int(low,high);
+    return get_rng()->random_int(low,high);
   }
   int draw_from_cdf(double *v, int size) {
-    return thread_rng[fred::omp_get_thread_num()].draw_from_cdf(v, size);
+    return get_rng()->draw_from_cdf(v, size);
   }
   int draw_from_cdf_vector(const std::vector <double>& v) {
-    return thread_rng[fred::omp_get_thread_num()].draw_from_cdf_vector(v);
+    return get_rng()->draw_from_cdf_vector(v);
   }
   int draw_from_distribution(int n, double *dist) {
-    return thread_rng[fred::omp_get_thread_num()].draw_from_distribution(n, dist);
+    return get_rng()->draw_from_distribution(n, dist);
   }
   double exponential(double lambda) {
-    return thread_rng[fred::omp_get_thread_num()].exponential(lambda);
+    return get_rng()->exponential(lambda);
   }
   double normal(double mu, double sigma) {
-    return thread_rng[fred::omp_get_thread_num()].normal(mu, sigma);
+    return get_rng()->normal(mu, sigma);
   }
   double lognormal(double mu, double sigma) {
-    return thread_rng[fred::omp_get_thread_num()].lognormal(mu, sigma);
+    return get_rng()->lognormal(mu, sigma);
   }
   void build_binomial_cdf(double p, int n, std::vector<double> &cdf) {
-    thread_rng[fred::omp_get_thread_num()].build_binomial_cdf(p, n, cdf);
+    get_rng()->build_binomial_cdf(p, n, cdf);
   }
   void sample_range_without_replacement(int N, int s, int* result) {
-    thread_rng[fred::omp_get_thread_num()].sample_range_without_replacement(N, s, result);
+    get_rng()->sample_range_without_replacement(N, s, result);
+  }
+  void shuffle_range(int N, int* result) {
+    get_rng()->shuffle_range(N, result);
+  }
+  std::string get_state(int thread) {
+    return thread_rng[thread].get_state();
+  }
+  void set_state(int thread, const std::string &state) {
+    thread_rng[thread].set_state(state);
   }
 
+  void begin_entity_stream(int phase, long long entity);
+  void end_entity_stream();
+
 private:
+  unsigned long metaseed;
   RNG * thread_rng;
+
+  // the calling thread's entity stream while one is in use. It is kept
+  // per thread rather than per thread number, since phases that run at
+  // the same time (see Setup_Scheduler) have teams with the same thread
+  // numbers.
+  static RNG* & entity_rng() {
+    static thread_local RNG* rng = NULL;
+    return rng;
+  }
+
+  RNG* get_rng() {
+    RNG* rng = entity_rng();
+    return (rng != NULL ? rng : &thread_rng[fred::omp_get_thread_num()]);
+  }
 };
 
 class Random {
@@ -130,14 +177,90 @@ public:
   static void build_binomial_cdf(double p, int n, std::vector<double> &cdf) { 
     Random_Number_Generator.build_binomial_cdf(p,n,cdf);
   }
+  /**
+   * Draw s distinct integers from 0..N-1 in uniformly random order, in
+   * O(s) time after the first call for a given N.
+   *
+   * Every ordered sample is equally likely. (Earlier versions moved a
+   * repeated draw to a free neighbouring value, which favoured values
+   * next to those already drawn, and so drew different samples from the
+   * same seed.) The generator keeps an identity permutation of the
+   * largest range seen as scratch space. Use shuffle_range() to put a
+   * whole range in random order.
+   *
+   * @param N the size of the range
+   * @param s the size of the sample (at most N)
+   * @param result array of at least s ints to receive the sample
+   */
   static void sample_range_without_replacement(int N, int s, int *result) { 
     Random_Number_Generator.sample_range_without_replacement(N,s,result);
   }
 
+  /**
+   * Put the integers 0..N-1 in uniformly random order.
+   *
+   * @param N the size of the range
+   * @param result array of at least N ints to receive the permutation
+   */
+  static void shuffle_range(int N, int *result) { 
+    Random_Number_Generator.shuffle_range(N,result);
+  }
+
+  /**
+   * The state of a thread's generator, as saved by Checkpoint.
+   */
+  static std::string get_state(int thread) {
+    return Random_Number_Generator.get_state(thread);
+  }
+  static void set_state(int thread, const std::string &state) {
+    Random_Number_Generator.set_state(thread, state);
+  }
+
+  /**
+   * Until end_entity_stream(), the calling thread's draws come from a
+   * stream seeded by the run's seed, the phase and the entity (see
+   * Entity_Stream). The run's own streams are left untouched.
+   */
+  static void begin_entity_stream(int phase, long long entity) {
+    Random_Number_Generator.begin_entity_stream(phase, entity);
+  }
+  static void end_entity_stream() {
+    Random_Number_Generator.end_entity_stream();
+  }
+
+  // the phases that draw from entity streams; since the streams depend
+  // only on the seed, all partitions of a partitioned run (see Partition)
+  // make the same draws for the condition order and the imported cases
+  enum {
+    HOSPITAL_ASSIGNMENT_STREAM = 1,
+    CONDITION_ORDER_STREAM = 2,
+    IMPORTED_CASES_STREAM = 3
+  };
+
 private:
   static Thread_RNG Random_Number_Generator;
 };
 
+/**
+ * The random draws made for one entity (a person or place) while an
+ * Entity_Stream is in scope. They depend only on the run's seed, the
+ * phase and the entity, not on the thread that handles the entity or on
+ * the order in which the entities are handled, so a phase that draws
+ * this way gives the same result for any number of threads.
+ */
+class Entity_Stream {
+public:
+  Entity_Stream(int phase, long long entity) {
+    Random::begin_entity_stream(phase, entity);
+  }
+  ~Entity_Stream() {
+    Random::end_entity_stream();
+  }
+private:
+  Entity_Stream(const Entity_Stream &);
+  void operator=(const Entity_Stream &);
+};
+
 
 template <typename T> 
 void FYShuffle( std::vector <T> &array){
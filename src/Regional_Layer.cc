@@ -291,12 +291,8 @@ std::vector<Place*> Regional_Layer::get_nearby_hospitals(int row, int col, doubl
       for(int j = col - search_dist; j <= col + search_dist; ++j) {
         Regional_Patch* patch = get_patch(i, j);
         if(patch != NULL) {
-          vector<Place*> hospitals = patch->get_hospitals();
-          if(static_cast<int>(hospitals.size()) > 0) {
-            for(std::vector<Place*>::iterator itr = hospitals.begin(); itr != hospitals.end(); ++itr) {
-              ret_val.push_back(*itr);
-            }
-          }
+          vector<Place*> & hospitals = patch->get_hospitals();
+          ret_val.insert(ret_val.end(), hospitals.begin(), hospitals.end());
         }
       }
     }
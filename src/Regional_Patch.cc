@@ -142,8 +142,8 @@ void Regional_Patch::unenroll(Person* per) {
 
 Place* Regional_Patch::get_nearby_workplace(Place* place, int staff) {
   // printf("get_workplace_near_place entered\n"); print(); fflush(stdout);
-  double x = Geo::get_x(place->get_longitude());
-  double y = Geo::get_y(place->get_latitude());
+  double x = place->get_x();
+  double y = place->get_y();
 
   // allow staff size variation by 25%
   int min_staff = (int)(0.75 * staff);
@@ -162,10 +162,8 @@ Place* Regional_Patch::get_nearby_workplace(Place* place, int staff) {
     return NULL;
   }
   assert(nearby_workplace != NULL);
-  double x2 = Geo::get_x(nearby_workplace->get_longitude());
-  double y2 = Geo::get_y(nearby_workplace->get_latitude());
   FRED_VERBOSE(1, "nearby workplace %s %f %f size %d target %d dist %f\n", nearby_workplace->get_label(),
-	       x2, y2, nearby_workplace->get_size(), staff, min_dist);
+	       nearby_workplace->get_x(), nearby_workplace->get_y(), nearby_workplace->get_size(), staff, min_dist);
 
   return nearby_workplace;
 }
@@ -174,6 +172,8 @@ Place* Regional_Patch::get_closest_workplace(double x, double y, int min_size, i
   // printf("get_closest_workplace entered for patch %d %d min_size = %d max_size = %d min_dist = %f  workplaces in patch = %d\n",
   // row, col, min_size, max_size, *min_dist, (int)(this->workplaces.size())); fflush(stdout);
   Place* closest_workplace = NULL;
+  // compare squared distances; the root is taken only for the result
+  double min_dist2 = (*min_dist < 20.0 ? (*min_dist) * (*min_dist) : 400.0);
   int number_workplaces = this->workplaces.size();
   for(int j = 0; j < number_workplaces; j++) {
     Place* workplace = this->workplaces[j];
@@ -182,16 +182,17 @@ Place* Regional_Patch::get_closest_workplace(double x, double y, int min_size, i
     }
     int size = workplace->get_size();
     if(min_size <= size && size <= max_size) {
-      double x2 = Geo::get_x(workplace->get_longitude());
-      double y2 = Geo::get_y(workplace->get_latitude());
-      double dist = sqrt((x - x2) * (x - x2) + (y - y2) * (y - y2));
-      if(dist < 20.0 && dist < *min_dist) {
-        *min_dist = dist;
+      double dist2 = Geo::xy_distance_squared(x, y, workplace->get_x(), workplace->get_y());
+      if(dist2 < min_dist2) {
+        min_dist2 = dist2;
         closest_workplace = workplace;
-        // printf("closer = %s size = %d min_dist = %f\n", closest_workplace->get_label(), size, *min_dist); fflush(stdout);
+        // printf("closer = %s size = %d min_dist = %f\n", closest_workplace->get_label(), size, sqrt(min_dist2)); fflush(stdout);
       }
     }
   }
+  if(closest_workplace != NULL) {
+    *min_dist = sqrt(min_dist2);
+  }
   return closest_workplace;
 }
 
@@ -94,7 +94,7 @@ public:
   void unenroll(Person* pers);
   void add_workplace(Place* place);
   void add_hospital(Place* place);
-  place_vec get_hospitals() {
+  place_vec & get_hospitals() {
     return this->hospitals;
   }
   Place* get_nearby_workplace(Place* place, int staff);
@@ -17,6 +17,7 @@
 // File: Respiratory_Transmission.cc
 //
 #include <algorithm>
+#include <math.h>
 
 #include "Respiratory_Transmission.h"
 #include "Date.h"
@@ -24,12 +25,18 @@
 #include "Condition_List.h"
 #include "Epidemic.h"
 #include "Global.h"
+#include "Classroom.h"
+#include "Hospital.h"
 #include "Household.h"
+#include "Neighborhood.h"
+#include "Office.h"
 #include "Params.h"
 #include "Person.h"
 #include "Place.h"
 #include "Random.h"
+#include "School.h"
 #include "Utils.h"
+#include "Workplace.h"
 
 
 Respiratory_Transmission::Respiratory_Transmission() {
@@ -83,11 +90,12 @@ void Respiratory_Transmission::setup(Condition* condition) {
 /////////////////////////////////////////
 
 void Respiratory_Transmission::spread_infection(int day, int condition_id, Mixing_Group* mixing_group) {
-  if(dynamic_cast<Place*>(mixing_group) == NULL) {
+  Place* place = dynamic_cast<Place*>(mixing_group);
+  if(place == NULL) {
     //Respiratory_Transmission must occur on a Place type
     return;
   } else {
-    this->spread_infection(day, condition_id, dynamic_cast<Place*>(mixing_group));
+    this->spread_infection(day, condition_id, place);
   }
 }
 
@@ -113,15 +121,29 @@ void Respiratory_Transmission::spread_infection(int day, int condition_id, Place
     return;
   }
 
-  if(place->is_household()) {
-    pairwise_transmission_model(day, condition_id, place);
+  // dispatch once per place to the model instantiated for its type
+  char type = place->get_type();
+  if(type == Place::TYPE_HOUSEHOLD) {
+    pairwise_transmission_model(day, condition_id, static_cast<Household*>(place));
     FRED_VERBOSE(1, "spread_infection finished day %d condition %d place %d %c %s\n",
 		 day, condition_id, place->get_id(), place->get_type(), place->get_label());
     return;
   }
 
-  if(place->is_neighborhood() && this->enable_neighborhood_density_transmission == true) {
-    density_transmission_model(day, condition_id, place);
+  if(type == Place::TYPE_NEIGHBORHOOD && this->enable_neighborhood_density_transmission == true) {
+    density_transmission_model(day, condition_id, static_cast<Neighborhood*>(place));
+  } else if(type == Place::TYPE_NEIGHBORHOOD) {
+    default_transmission_model(day, condition_id, static_cast<Neighborhood*>(place));
+  } else if(type == Place::TYPE_SCHOOL) {
+    default_transmission_model(day, condition_id, static_cast<School*>(place));
+  } else if(type == Place::TYPE_CLASSROOM) {
+    default_transmission_model(day, condition_id, static_cast<Classroom*>(place));
+  } else if(type == Place::TYPE_WORKPLACE) {
+    default_transmission_model(day, condition_id, static_cast<Workplace*>(place));
+  } else if(type == Place::TYPE_OFFICE) {
+    default_transmission_model(day, condition_id, static_cast<Office*>(place));
+  } else if(type == Place::TYPE_HOSPITAL) {
+    default_transmission_model(day, condition_id, static_cast<Hospital*>(place));
   } else {
     default_transmission_model(day, condition_id, place);
   }
@@ -144,6 +166,74 @@ void Respiratory_Transmission::spread_infection(int day, int condition_id, Place
 //
 /////////////////////////////////////////
 
+// the transmission probabilities for the infector/infectee pairs of one
+// place. The bias flag is read once per place and the infector's row of
+// the contact matrix once per infector; the qualified calls bind at
+// compile time to the place type's own lookups
+template <class PLACE_TYPE>
+class Pair_Transmission_Prob {
+public:
+  Pair_Transmission_Prob(PLACE_TYPE* place, int condition_id) {
+    this->place = place;
+    this->condition_id = condition_id;
+    this->bias = Global::Enable_Transmission_Bias;
+    this->infector = NULL;
+    this->row = 0;
+  }
+
+  void set_infector(Person* infector) {
+    this->infector = infector;
+    if(!this->bias) {
+      this->row = this->place->PLACE_TYPE::get_group(this->condition_id, infector);
+    }
+  }
+
+  double get(Person* infectee) {
+    if(this->bias) {
+      return this->place->PLACE_TYPE::get_transmission_probability(this->condition_id, this->infector, infectee);
+    } else {
+      return this->place->PLACE_TYPE::get_transmission_prob_for_group(this->condition_id, this->row, infectee);
+    }
+  }
+
+private:
+  PLACE_TYPE* place;
+  int condition_id;
+  bool bias;
+  Person* infector;
+  int row;
+};
+
+// a place of any other type takes the virtual path
+template <>
+class Pair_Transmission_Prob<Place> {
+public:
+  Pair_Transmission_Prob(Place* place, int condition_id) {
+    this->place = place;
+    this->condition_id = condition_id;
+    this->bias = Global::Enable_Transmission_Bias;
+    this->infector = NULL;
+  }
+
+  void set_infector(Person* infector) {
+    this->infector = infector;
+  }
+
+  double get(Person* infectee) {
+    if(this->bias) {
+      return this->place->get_transmission_probability(this->condition_id, this->infector, infectee);
+    } else {
+      return this->place->get_transmission_prob(this->condition_id, this->infector, infectee);
+    }
+  }
+
+private:
+  Place* place;
+  int condition_id;
+  bool bias;
+  Person* infector;
+};
+
 
 bool Respiratory_Transmission::attempt_transmission(double transmission_prob, Person* infector, Person* infectee,
 					int condition_id, int day, Place* place) {
@@ -192,11 +282,18 @@ bool Respiratory_Transmission::attempt_transmission(double transmission_prob, Pe
   }
 }
 
-void Respiratory_Transmission::default_transmission_model(int day, int condition_id, Place * place) {
+template <class PLACE_TYPE>
+void Respiratory_Transmission::default_transmission_model(int day, int condition_id, PLACE_TYPE* place) {
   Condition* condition = Global::Conditions.get_condition(condition_id);
   int N = place->get_size();
   int new_infections = 0;
 
+  // work counters for report_transmission_counters
+  int infectors = 0;
+  int contacts = 0;
+  int draws = 0;
+  int attempts = 0;
+
   person_vec_t* infectious = place->get_infectious_people(condition_id);
   person_vec_t* susceptibles = place->get_enrollees();
 
@@ -209,17 +306,23 @@ void Respiratory_Transmission::default_transmission_model(int day, int condition
   // since N is estimated only at startup.
   int number_targets = (N - 1 > susceptibles->size() ? N - 1 : susceptibles->size());
 
+  // optional roster of the enrollee positions of current susceptibles
+  std::vector<int>* roster = NULL;
+  if(place->has_susceptible_rosters()) {
+    roster = place->get_susceptible_roster(condition_id);
+  }
+
   // contact_rate is contacts_per_day with weeked and seasonality modulation (if applicable)
   double contact_rate = place->get_contact_rate(day, condition_id);
+  Pair_Transmission_Prob<PLACE_TYPE> pair_prob(place, condition_id);
 
   // randomize the order of processing the infectious list
-  std::vector<int> shuffle_index;
   int number_of_infectious = infectious->size();
-  shuffle_index.reserve(number_of_infectious);
-  for(int i = 0; i < number_of_infectious; ++i) {
-    shuffle_index[i] = i;
+  std::vector<int> shuffle_index(number_of_infectious);
+  if(number_of_infectious > 0) {
+    Random::shuffle_range(number_of_infectious, &shuffle_index[0]);
   }
-  FYShuffle<int>(shuffle_index);
+  draws += number_of_infectious;
 
   for(int n = 0; n < number_of_infectious; ++n) {
     int infector_pos = shuffle_index[n];
@@ -232,23 +335,61 @@ void Respiratory_Transmission::default_transmission_model(int day, int condition
     }
 
     // get the actual number of contacts to attempt to infect
-    int contact_count = place->get_contact_count(infector, condition_id, day, contact_rate);
+    infectors++;
+    pair_prob.set_infector(infector);
+    int contact_count = place->Place::get_contact_count(infector, condition_id, day, contact_rate);
+    draws++;
 
     std::map<int, int> sampling_map;
-    // get a susceptible target for each contact resulting in infection
-    for(int c = 0; c < contact_count; ++c) {
-      // select a target infectee from among susceptibles with replacement
-      int pos = Random::draw_random_int(0, number_targets - 1);
-      if(pos < susceptibles->size()) {
+    if(roster != NULL) {
+      // each contact reaches a current susceptible with probability
+      // thinning = roster size / number of targets other than the
+      // infector, so skip over the other contacts by geometrically
+      // distributed gaps and draw only the targets, uniformly from the
+      // roster
+      int roster_size = roster->size();
+      int other_targets = number_targets - (infector->is_enrolled_in_place(place) ? 1 : 0);
+      double thinning = (other_targets > 0 ? static_cast<double>(roster_size) / other_targets : 1.0);
+      double c = 0.0;
+      while(roster_size > 0) {
+        if(thinning < 1.0) {
+          c += floor(log(1.0 - Random::draw_random()) / log(1.0 - thinning));
+          draws++;
+        }
+        if(c >= contact_count) {
+          break;
+        }
+        int pos = (*roster)[Random::draw_random_int(0, roster_size - 1)];
+        contacts++;
+        draws++;
         if(infector == (*susceptibles)[pos]) {
-          if(susceptibles->size() > 1) {
-            --(c); // redo
-            continue;
+          if(roster_size > 1) {
+            continue; // redo
           } else {
             break; // give up
           }
         }
         sampling_map[pos]++;
+        c += 1.0;
+      }
+    } else {
+      // get a susceptible target for each contact resulting in infection
+      for(int c = 0; c < contact_count; ++c) {
+        // select a target infectee from among susceptibles with replacement
+        int pos = Random::draw_random_int(0, number_targets - 1);
+        contacts++;
+        draws++;
+        if(pos < (int) susceptibles->size()) {
+          if(infector == (*susceptibles)[pos]) {
+            if(susceptibles->size() > 1) {
+              --(c); // redo
+              continue;
+            } else {
+              break; // give up
+            }
+          }
+          sampling_map[pos]++;
+        }
       }
     }
 
@@ -263,15 +404,11 @@ void Respiratory_Transmission::default_transmission_model(int day, int condition
 	      continue;
       }
       // get the transmission probs for given infector/infectee pair
-      double transmission_prob = 1.0;
-      if(Global::Enable_Transmission_Bias) {
-	      transmission_prob = place->get_transmission_probability(condition_id, infector, infectee);
-      } else {
-	      transmission_prob = place->get_transmission_prob(condition_id, infector, infectee);
-      }
+      double transmission_prob = pair_prob.get(infectee);
       for(int draw = 0; draw < times_drawn; ++draw) {
         // only proceed if person is susceptible
         if(infectee->is_susceptible(condition_id)) {
+          attempts++;
           if (attempt_transmission(transmission_prob, infector, infectee, condition_id, day, place)) {
 	    new_infections++;
 	  }
@@ -279,6 +416,9 @@ void Respiratory_Transmission::default_transmission_model(int day, int condition
       }
     } // end contact loop
   } // end infectious list loop
+  if(Global::Report_Transmission_Counters) {
+    condition->get_epidemic()->count_transmission_work(place, infectors, contacts, draws + attempts, attempts, new_infections);
+  }
   place->reset_place_state(condition_id);
   if (0 && new_infections > 0) {
     FRED_VERBOSE(1, "default_transmission DAY %d PLACE %s gives %d new_infections\n",
@@ -287,13 +427,22 @@ void Respiratory_Transmission::default_transmission_model(int day, int condition
 }
 
 
-void Respiratory_Transmission::pairwise_transmission_model(int day, int condition_id, Place* place) {
+template <class PLACE_TYPE>
+void Respiratory_Transmission::pairwise_transmission_model(int day, int condition_id, PLACE_TYPE* place) {
 
   person_vec_t* infectious = place->get_infectious_people(condition_id);
   person_vec_t* susceptibles = place->get_enrollees();
 
   double contact_prob = place->get_contact_rate(day, condition_id);
+  Pair_Transmission_Prob<PLACE_TYPE> pair_prob(place, condition_id);
+  bool has_rosters = place->has_susceptible_rosters();
+  char* label = place->get_label();
   int new_infections = 0;
+
+  // work counters for report_transmission_counters
+  int infectors = 0;
+  int contacts = 0;
+  int attempts = 0;
   
   FRED_VERBOSE(1, "pairwise_transmission DAY %d PLACE %s N %d\n",
 	       day, place->get_label(), place->get_size());
@@ -308,14 +457,27 @@ void Respiratory_Transmission::pairwise_transmission_model(int day, int conditio
       continue;
     }
     
-    int sus_size = susceptibles->size();
-    for(int pos = 0; pos < sus_size; ++pos) {
+    infectors++;
+    pair_prob.set_infector(infector);
+    double infectivity = infector->get_infectivity(condition_id);
+    // with a roster, visit only the current susceptibles; the roster is
+    // copied because successful transmissions remove people from it, into
+    // a per-thread buffer that keeps its capacity between infectors
+    static thread_local std::vector<int> targets;
+    targets.clear();
+    if(has_rosters) {
+      std::vector<int>* roster = place->get_susceptible_roster(condition_id);
+      targets.assign(roster->begin(), roster->end());
+    }
+    int sus_size = (has_rosters ? targets.size() : susceptibles->size());
+    for(int n = 0; n < sus_size; ++n) {
+      int pos = (has_rosters ? targets[n] : n);
       Person* infectee = (*susceptibles)[pos];
       if(infector == infectee) {
 	      continue;
       }
+      contacts++;
       int infectee_id = infectee->get_id();
-      char* label = place->get_label();
 
       FRED_VERBOSE(1, "pairwise_transmission DAY %d PLACE %s infectee is %d\n",
 		   day, label, infectee_id);
@@ -338,15 +500,10 @@ void Respiratory_Transmission::pairwise_transmission_model(int day, int conditio
 	      FRED_VERBOSE(1, "pairwise_transmission DAY %d PLACE %s infectee %d is present and susceptible\n",
 		                 day, label, infectee_id);
 	      // get the transmission probs for infector/infectee pair
-	      double transmission_prob = 1.0;
-	      if(Global::Enable_Transmission_Bias) {
-	        transmission_prob = place->get_transmission_probability(condition_id, infector, infectee);
-	      } else {
-	        transmission_prob = place->get_transmission_prob(condition_id, infector, infectee);
-	      }
-	      double infectivity = infector->get_infectivity(condition_id);
+	      double transmission_prob = pair_prob.get(infectee);
 	      // scale transmission prob by infectivity and contact prob
 	      transmission_prob *= infectivity * contact_prob;
+	      attempts++;
 	      if (attempt_transmission(transmission_prob, infector, infectee, condition_id, day, place)) {
 		new_infections++;
 	      };
@@ -356,6 +513,9 @@ void Respiratory_Transmission::pairwise_transmission_model(int day, int conditio
       }
     } // end susceptibles loop
   }
+  if(Global::Report_Transmission_Counters) {
+    Global::Conditions.get_condition(condition_id)->get_epidemic()->count_transmission_work(place, infectors, contacts, attempts, attempts, new_infections);
+  }
   place->reset_place_state(condition_id);
   if (0 && new_infections > 0) {
     FRED_VERBOSE(0, "default_transmission DAY %d PLACE %s gives %d new_infections\n",
@@ -363,7 +523,8 @@ void Respiratory_Transmission::pairwise_transmission_model(int day, int conditio
   }
 }
 
-void Respiratory_Transmission::density_transmission_model(int day, int condition_id, Place* place) {
+template <class PLACE_TYPE>
+void Respiratory_Transmission::density_transmission_model(int day, int condition_id, PLACE_TYPE* place) {
 
   person_vec_t* infectious = place->get_infectious_people(condition_id);
   person_vec_t* susceptibles = place->get_enrollees();
@@ -379,6 +540,18 @@ void Respiratory_Transmission::density_transmission_model(int day, int condition
   int sus_hosts = susceptibles->size();
   int inf_hosts = infectious->size();
   int exposed = 0;
+
+  // with a roster, the hosts at risk are the current susceptibles only
+  std::vector<int>* roster = NULL;
+  if(place->has_susceptible_rosters()) {
+    roster = place->get_susceptible_roster(condition_id);
+    sus_hosts = roster->size();
+  }
+
+  // work counters for report_transmission_counters
+  int contacts = 0;
+  int draws = 1;
+  int attempts = 0;
       
   // each host's probability of infection
   double prob_infection = 1.0 - pow((1.0 - contact_prob), inf_hosts);
@@ -399,17 +572,22 @@ void Respiratory_Transmission::density_transmission_model(int day, int condition
   int reached_max_infectees_count = 0;
   int number_infectious_hosts = inf_hosts;
 
-  // randomize the order of processing the susceptible list
-  std::vector<int> shuffle_index;
-  int number_of_susceptibles = susceptibles->size();
-  shuffle_index.reserve(number_of_susceptibles);
-  for(int i = 0; i < number_of_susceptibles; ++i) {
-    shuffle_index[i] = i;
+  // select the exposed hosts (enrollee positions) in random order,
+  // without replacement
+  std::vector<int> targets(exposed < sus_hosts ? exposed : sus_hosts);
+  if(targets.size() > 0) {
+    Random::sample_range_without_replacement(sus_hosts, targets.size(), &targets[0]);
+    if(roster != NULL) {
+      for(int k = 0; k < (int) targets.size(); ++k) {
+	targets[k] = (*roster)[targets[k]];
+      }
+    }
   }
-  FYShuffle<int>(shuffle_index);
+  draws += targets.size();
 
   for(int j = 0; j < exposed && j < sus_hosts && 0 < inf_hosts; ++j) {
-    Person* infectee = (*susceptibles)[shuffle_index[j]];
+    Person* infectee = (*susceptibles)[targets[j]];
+    contacts++;
     infectee->update_schedule(day);
     if(!infectee->is_present(day, place)) {
       continue;
@@ -425,6 +603,8 @@ void Respiratory_Transmission::density_transmission_model(int day, int condition
 
       // get the transmission probs for  infectee/infector  pair
       double transmission_prob = infector->get_infectivity(condition_id);
+      draws += 2;
+      attempts++;
       if(attempt_transmission(transmission_prob, infector, infectee, condition_id, day, place)) {
         // successful transmission
 	new_infections++;
@@ -450,6 +630,9 @@ void Respiratory_Transmission::density_transmission_model(int day, int condition
                 day, place->get_label(), reached_max_infectees_count,
                 this->density_transmission_maximum_infectees, number_infectious_hosts);
   }
+  if(Global::Report_Transmission_Counters) {
+    condition->get_epidemic()->count_transmission_work(place, number_infectious_hosts, contacts, draws, attempts, new_infections);
+  }
   place->reset_place_state(condition_id);
   if (0 && new_infections > 0) {
     FRED_VERBOSE(0, "density_transmission DAY %d PLACE %s gives %d new_infections\n",
@@ -44,10 +44,20 @@ private:
   int density_transmission_maximum_infectees;
   double** prob_contact;
 
-  void default_transmission_model(int day, int condition_id, Place* place);
+  /**
+   * The default, pairwise and density models are instantiated once per
+   * place type, so the per-pair transmission probabilities are
+   * non-virtual, inlined lookups into that type's contact matrix, with
+   * the infector's row found once per infector. Instantiations for Place
+   * itself use the virtual methods and cover any other type.
+   */
+  template <class PLACE_TYPE>
+  void default_transmission_model(int day, int condition_id, PLACE_TYPE* place);
   void age_based_transmission_model(int day, int condition_id, Place* place);
-  void pairwise_transmission_model(int day, int condition_id, Place* place);
-  void density_transmission_model(int day, int condition_id, Place* place);
+  template <class PLACE_TYPE>
+  void pairwise_transmission_model(int day, int condition_id, PLACE_TYPE* place);
+  template <class PLACE_TYPE>
+  void density_transmission_model(int day, int condition_id, PLACE_TYPE* place);
 
   bool attempt_transmission(double transmission_prob, Person* infector, Person* infectee, int condition_id, int day, Place* place);
 };
@@ -17,6 +17,7 @@
 // File: School.cc
 //
 
+#include "Checkpoint.h"
 #include "Classroom.h"
 #include "Date.h"
 #include "Condition.h"
@@ -190,28 +191,6 @@ void School::get_parameters() {
   }
 }
 
-int School::get_group(int condition_id, Person* per) {
-  int age = per->get_age();
-  if(age < 12) {
-    return 0;
-  } else if(age < 16) {
-    return 1;
-  } else if(per->is_student()) {
-    return 2;
-  } else {
-    return 3;
-  }
-}
-
-double School::get_transmission_prob(int condition_id, Person* i, Person* s) {
-  // i = infected agent
-  // s = susceptible agent
-  int row = get_group(condition_id, i);
-  int col = get_group(condition_id, s);
-  double tr_pr = School::prob_transmission_per_contact[row][col];
-  return tr_pr;
-}
-
 void School::close(int day, int day_to_close, int duration) {
   this->close_date = day_to_close;
   this->open_date = close_date + duration;
@@ -275,6 +254,18 @@ bool School::should_be_open(int day, int condition_id) {
   return true;
 }
 
+void School::write_closure_checkpoint() {
+  Checkpoint::put(School::global_closure_is_active);
+  Checkpoint::put(School::global_close_date);
+  Checkpoint::put(School::global_open_date);
+}
+
+void School::read_closure_checkpoint() {
+  Checkpoint::get(School::global_closure_is_active);
+  Checkpoint::get(School::global_close_date);
+  Checkpoint::get(School::global_open_date);
+}
+
 void School::apply_global_school_closure_policy(int day, int condition_id) {
 
   // Only test triggers for school closure if not global closure is not already activated
@@ -352,9 +343,6 @@ void School::apply_individual_school_closure_policy(int day, int condition_id) {
   }
 }
 
-double School::get_contacts_per_day(int condition_id) {
-  return School::contacts_per_day;
-}
 
 int School::enroll(Person* person) {
 
@@ -43,14 +43,49 @@ public:
 
   void prepare();
   static void get_parameters();
-  int get_group(int condition_id, Person* per);
-  double get_transmission_prob(int condition_id, Person* i, Person* s);
+
+  /**
+   * Save or restore the state of a global school closure (see Checkpoint).
+   */
+  static void write_closure_checkpoint();
+  static void read_closure_checkpoint();
+  int get_group(int condition_id, Person* per) {
+    int age = per->get_age();
+    if(age < 12) {
+      return 0;
+    } else if(age < 16) {
+      return 1;
+    } else if(per->is_student()) {
+      return 2;
+    } else {
+      return 3;
+    }
+  }
+  double get_transmission_prob(int condition_id, Person* i, Person* s) {
+    // i = infected agent
+    // s = susceptible agent
+    int row = School::get_group(condition_id, i);
+    int col = School::get_group(condition_id, s);
+    double tr_pr = School::prob_transmission_per_contact[row][col];
+    return tr_pr;
+  }
+  /**
+   * The transmission probability for an infector in the given group (row
+   * of the contact matrix), for callers that look up many susceptibles
+   * with the same infector.
+   */
+  double get_transmission_prob_for_group(int condition_id, int row, Person* s) {
+    int col = School::get_group(condition_id, s);
+    return School::prob_transmission_per_contact[row][col];
+  }
   void close(int day, int day_to_close, int duration);
   bool is_open(int day);
   bool should_be_open(int day, int condition_id);
   void apply_global_school_closure_policy(int day, int condition_id);
   void apply_individual_school_closure_policy(int day, int condition_id);
-  double get_contacts_per_day(int condition_id);
+  double get_contacts_per_day(int condition_id) {
+    return School::contacts_per_day;
+  }
   int enroll(Person* per);
   void unenroll(int pos);
   int get_max_grade() {
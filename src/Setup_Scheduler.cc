@@ -0,0 +1,108 @@
+/*
+  This file is part of the FRED system.
+
+  Copyright (c) 2013-2016, University of Pittsburgh, John Grefenstette,
+  David Galloway, Mary Krauland, Michael Lann, and Donald Burke.
+
+  Based in part on FRED Version 2.9, created in 2010-2013 by
+  John Grefenstette, Shawn Brown, Roni Rosenfield, Alona Fyshe, David
+  Galloway, Nathan Stone, Jay DePasse, Anuroop Sriram, and Donald Burke.
+
+  Licensed under the BSD 3-Clause license.  See the file "LICENSE" for
+  more information.
+*/
+
+//
+//
+// File: Setup_Scheduler.cc
+//
+
+#include <chrono>
+
+#include "Setup_Scheduler.h"
+#include "Global.h"
+#include "Utils.h"
+
+using namespace std::chrono;
+
+int Setup_Scheduler::add_phase(const char* name, setup_phase_t phase, const std::vector<int> &after) {
+  int index = this->phases.size();
+  for(int i = 0; i < (int) after.size(); ++i) {
+    if(after[i] < 0 || after[i] >= index) {
+      Utils::fred_abort("setup phase %s must follow phases added before it\n", name);
+    }
+  }
+  phase_t new_phase;
+  new_phase.name = name;
+  new_phase.run = phase;
+  new_phase.after = after;
+  new_phase.finished = false;
+  new_phase.seconds = 0.0;
+  this->phases.push_back(new_phase);
+  return index;
+}
+
+void Setup_Scheduler::run_phase(int index) {
+  high_resolution_clock::time_point start = high_resolution_clock::now();
+  this->phases[index].run();
+  high_resolution_clock::time_point stop = high_resolution_clock::now();
+  this->phases[index].seconds = 0.000001 * duration_cast<microseconds>(stop - start).count();
+}
+
+void Setup_Scheduler::run() {
+  int number_of_phases = this->phases.size();
+  int finished = 0;
+  std::vector<int> wave;
+  while(finished < number_of_phases) {
+
+    // the unfinished phases whose dependencies have all finished
+    wave.clear();
+    for(int i = 0; i < number_of_phases; ++i) {
+      if(this->phases[i].finished) {
+	continue;
+      }
+      bool ready = true;
+      for(int j = 0; j < (int) this->phases[i].after.size(); ++j) {
+	if(this->phases[this->phases[i].after[j]].finished == false) {
+	  ready = false;
+	  break;
+	}
+      }
+      if(ready) {
+	wave.push_back(i);
+      }
+    }
+    int size = wave.size();
+
+    if(size == 1) {
+      run_phase(wave[0]);
+    } else {
+#ifdef _OPENMP
+      // each phase gets a share of the threads for its own loops
+      int threads = fred::omp_get_max_threads();
+      int teams = (size < threads ? size : threads);
+      int team_size = threads / teams;
+      int max_levels = fred::omp_get_max_active_levels();
+      fred::omp_set_max_active_levels(2);
+#pragma omp parallel for num_threads(teams) schedule(dynamic,1)
+      for(int k = 0; k < size; ++k) {
+	fred::omp_set_num_threads(team_size);
+	run_phase(wave[k]);
+      }
+      fred::omp_set_max_active_levels(max_levels);
+#else
+      for(int k = 0; k < size; ++k) {
+	run_phase(wave[k]);
+      }
+#endif
+    }
+
+    for(int k = 0; k < size; ++k) {
+      phase_t* phase = &(this->phases[wave[k]]);
+      phase->finished = true;
+      fprintf(Global::Statusfp, "%s took %f seconds\n", phase->name.c_str(), phase->seconds);
+    }
+    fflush(Global::Statusfp);
+    finished += size;
+  }
+}
@@ -0,0 +1,77 @@
+/*
+  This file is part of the FRED system.
+
+  Copyright (c) 2013-2016, University of Pittsburgh, John Grefenstette,
+  David Galloway, Mary Krauland, Michael Lann, and Donald Burke.
+
+  Based in part on FRED Version 2.9, created in 2010-2013 by
+  John Grefenstette, Shawn Brown, Roni Rosenfield, Alona Fyshe, David
+  Galloway, Nathan Stone, Jay DePasse, Anuroop Sriram, and Donald Burke.
+
+  Licensed under the BSD 3-Clause license.  See the file "LICENSE" for
+  more information.
+*/
+
+//
+//
+// File: Setup_Scheduler.h
+//
+
+#ifndef _FRED_SETUP_SCHEDULER_H
+#define _FRED_SETUP_SCHEDULER_H
+
+#include <string>
+#include <vector>
+
+/**
+ * Runs the phases of fred_setup in an order that respects their
+ * dependencies, running phases that don't depend on each other at the
+ * same time.
+ *
+ * Each phase names the earlier phases it must follow. The phases run
+ * in waves: a wave holds every phase whose dependencies have finished,
+ * in the order the phases were added. A wave of one phase runs on the
+ * calling thread, so the phase's own parallel loops get every thread.
+ * The phases of a larger wave run concurrently and share the threads
+ * among their loops. Phases that run concurrently must not touch the
+ * same state, and any random draws they make must come from entity
+ * streams (see Entity_Stream), so that the result does not depend on
+ * the number of threads.
+ *
+ * After each wave, the time taken by each of its phases is written to
+ * the status file in the format of Utils::fred_print_lap_time().
+ */
+class Setup_Scheduler {
+public:
+  typedef void (*setup_phase_t)();
+
+  /**
+   * Add a phase that runs after the given phases.
+   *
+   * @param name the name used in the timing report
+   * @param phase the function that runs the phase
+   * @param after the indexes of the phases that must finish first
+   * @return the index of the new phase
+   */
+  int add_phase(const char* name, setup_phase_t phase, const std::vector<int> &after = std::vector<int>());
+
+  /**
+   * Run all the phases.
+   */
+  void run();
+
+private:
+  typedef struct phase {
+    std::string name;
+    setup_phase_t run;
+    std::vector<int> after;
+    bool finished;
+    double seconds;
+  } phase_t;
+
+  std::vector<phase_t> phases;
+
+  void run_phase(int index);
+};
+
+#endif // _FRED_SETUP_SCHEDULER_H
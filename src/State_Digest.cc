@@ -0,0 +1,149 @@
+/*
+  This file is part of the FRED system.
+
+  Copyright (c) 2013-2016, University of Pittsburgh, John Grefenstette,
+  David Galloway, Mary Krauland, Michael Lann, and Donald Burke.
+
+  Based in part on FRED Version 2.9, created in 2010-2013 by
+  John Grefenstette, Shawn Brown, Roni Rosenfield, Alona Fyshe, David
+  Galloway, Nathan Stone, Jay DePasse, Anuroop Sriram, and Donald Burke.
+
+  Licensed under the BSD 3-Clause license.  See the file "LICENSE" for
+  more information.
+*/
+
+//
+//
+// File: State_Digest.cc
+//
+
+#include "Checkpoint.h"
+#include "Condition.h"
+#include "Condition_List.h"
+#include "Epidemic.h"
+#include "Household.h"
+#include "Params.h"
+#include "Person.h"
+#include "Place.h"
+#include "Place_List.h"
+#include "Population.h"
+#include "State_Digest.h"
+#include "Utils.h"
+
+bool State_Digest::enabled = false;
+FILE* State_Digest::fp = NULL;
+std::vector<unsigned long long> State_Digest::running;
+
+void State_Digest::get_parameters() {
+  int temp_int = 0;
+  Params::get_param("enable_state_digest", &temp_int);
+  State_Digest::enabled = (temp_int == 0 ? false : true);
+}
+
+void State_Digest::write_checkpoint() {
+  Checkpoint::put_vector(State_Digest::running);
+}
+
+void State_Digest::read_checkpoint() {
+  Checkpoint::get_vector(State_Digest::running);
+}
+
+void State_Digest::record(int day) {
+  if(State_Digest::enabled == false) {
+    return;
+  }
+  if(State_Digest::fp == NULL) {
+    char filename[FRED_STRING_SIZE];
+    Utils::fred_snprintf(filename, sizeof(filename), "%s/RUN%d/digest.csv", Global::Simulation_directory, Global::Simulation_run_number);
+    State_Digest::fp = fopen(filename, "w");
+    if(State_Digest::fp == NULL) {
+      Utils::fred_abort("State_Digest: can't open %s\n", filename);
+    }
+    fprintf(State_Digest::fp, "day,subsystem,digest,running_digest\n");
+  }
+
+  // the subsystems are the population, the places and each epidemic
+  int conditions = Global::Conditions.get_number_of_conditions();
+  std::vector<unsigned long long> digest;
+  std::vector<const char*> name;
+  digest.push_back(State_Digest::get_population_digest());
+  name.push_back("population");
+  digest.push_back(State_Digest::get_place_digest());
+  name.push_back("places");
+  for(int c = 0; c < conditions; ++c) {
+    Condition* condition = Global::Conditions.get_condition(c);
+    digest.push_back(condition->get_epidemic()->get_state_digest(day));
+    name.push_back(condition->get_condition_name());
+  }
+
+  State_Digest::running.resize(digest.size(), 0);
+  unsigned long long combined = 0;
+  for(int i = 0; i < (int) digest.size(); ++i) {
+    State_Digest::running[i] = State_Digest::mix(State_Digest::running[i], digest[i]);
+    combined = State_Digest::mix(combined, State_Digest::running[i]);
+    fprintf(State_Digest::fp, "%d,%s,%016llx,%016llx\n", day, name[i], digest[i], State_Digest::running[i]);
+  }
+  fprintf(Global::Statusfp, "day %d state digest %016llx\n", day, combined);
+  fflush(State_Digest::fp);
+}
+
+void State_Digest::end_of_run() {
+  if(State_Digest::fp != NULL) {
+    fclose(State_Digest::fp);
+    State_Digest::fp = NULL;
+  }
+}
+
+unsigned long long State_Digest::get_population_digest() {
+  int conditions = Global::Conditions.get_number_of_conditions();
+  int popsize = Global::Pop.get_population_size();
+  unsigned long long digest = State_Digest::mix(0, popsize);
+  for(int p = 0; p < popsize; ++p) {
+    Person* person = Global::Pop.get_person(p);
+    digest = State_Digest::mix(digest, person->get_id());
+    digest = State_Digest::mix(digest, person->get_age());
+    Household* household = person->get_household();
+    digest = State_Digest::mix(digest, household == NULL ? -1 : household->get_id());
+    for(int c = 0; c < conditions; ++c) {
+      Person* infector = person->get_infector(c);
+      digest = State_Digest::mix(digest, person->get_health_state(c));
+      digest = State_Digest::mix(digest, person->get_exposure_date(c));
+      digest = State_Digest::mix(digest, person->get_health()->get_next_transition_day(c));
+      digest = State_Digest::mix(digest, infector == NULL ? -1 : infector->get_id());
+      digest = State_Digest::mix(digest, person->get_infectees(c));
+    }
+  }
+  return digest;
+}
+
+unsigned long long State_Digest::get_place_digest() {
+  int conditions = Global::Conditions.get_number_of_conditions();
+  std::vector<Place*> places;
+  for(int i = 0; i < Global::Places.get_number_of_households(); ++i) {
+    places.push_back(Global::Places.get_household(i));
+  }
+  for(int i = 0; i < Global::Places.get_number_of_neighborhoods(); ++i) {
+    places.push_back(Global::Places.get_neighborhood(i));
+  }
+  for(int i = 0; i < Global::Places.get_number_of_schools(); ++i) {
+    places.push_back(Global::Places.get_school(i));
+  }
+  for(int i = 0; i < Global::Places.get_number_of_workplaces(); ++i) {
+    places.push_back(Global::Places.get_workplace(i));
+  }
+  for(int i = 0; i < Global::Places.get_number_of_hospitals(); ++i) {
+    places.push_back(Global::Places.get_hospital(i));
+  }
+
+  unsigned long long digest = State_Digest::mix(0, places.size());
+  for(int i = 0; i < (int) places.size(); ++i) {
+    Place* place = places[i];
+    digest = State_Digest::mix(digest, place->get_id());
+    digest = State_Digest::mix(digest, place->get_size());
+    for(int c = 0; c < conditions; ++c) {
+      digest = State_Digest::mix(digest, place->get_total_infections(c));
+      digest = State_Digest::mix(digest, place->get_total_symptomatic_infections(c));
+    }
+  }
+  return digest;
+}
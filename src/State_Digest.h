@@ -0,0 +1,96 @@
+/*
+  This file is part of the FRED system.
+
+  Copyright (c) 2013-2016, University of Pittsburgh, John Grefenstette,
+  David Galloway, Mary Krauland, Michael Lann, and Donald Burke.
+
+  Based in part on FRED Version 2.9, created in 2010-2013 by
+  John Grefenstette, Shawn Brown, Roni Rosenfield, Alona Fyshe, David
+  Galloway, Nathan Stone, Jay DePasse, Anuroop Sriram, and Donald Burke.
+
+  Licensed under the BSD 3-Clause license.  See the file "LICENSE" for
+  more information.
+*/
+
+//
+//
+// File: State_Digest.h
+//
+
+#ifndef _FRED_STATE_DIGEST_H
+#define _FRED_STATE_DIGEST_H
+
+#include <stdio.h>
+#include <vector>
+
+#include "Global.h"
+
+/**
+ * Daily digests of the simulation state, for checking that runs with
+ * different numbers of threads produce the same epidemic.
+ *
+ * With enable_state_digest set, at the end of each day the health state
+ * of every person, the place counters and the lists, counters and event
+ * queue of every epidemic are hashed. Each subsystem keeps a running
+ * digest, chained over the days, so once two runs diverge they differ
+ * on every later day. The digests are written to RUN<n>/digest.csv and
+ * the combined running digest is printed each day.
+ *
+ * bin/fred_verify_threads runs a scenario at several thread counts and
+ * reports the first day and subsystem at which the digests differ.
+ */
+class State_Digest {
+public:
+
+  /**
+   * Read the enable_state_digest parameter.
+   */
+  static void get_parameters();
+
+  static bool is_enabled() {
+    return State_Digest::enabled;
+  }
+
+  /**
+   * Hash the state at the end of the given day and write the digests.
+   */
+  static void record(int day);
+
+  static void end_of_run();
+
+  /**
+   * Save or restore the running digests (see Checkpoint).
+   */
+  static void write_checkpoint();
+  static void read_checkpoint();
+
+  /**
+   * Combine a value into a digest. The result depends on the order in
+   * which values are combined.
+   */
+  static unsigned long long mix(unsigned long long digest, long long value) {
+    // splitmix64 finalizer applied to the value offset by the digest
+    unsigned long long x = (unsigned long long) value + 0x9e3779b97f4a7c15ULL + (digest << 6) + (digest >> 2);
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return digest ^ (x ^ (x >> 31));
+  }
+
+  /**
+   * Digest of a value as a member of an unordered collection: the sum of
+   * the member digests does not depend on the order of the members.
+   */
+  static unsigned long long member(long long value) {
+    return State_Digest::mix(0, value);
+  }
+
+private:
+  static bool enabled;
+  static FILE* fp;
+  static std::vector<unsigned long long> running;
+
+  static unsigned long long get_population_digest();
+  static unsigned long long get_place_digest();
+};
+
+#endif // _FRED_STATE_DIGEST_H
@@ -0,0 +1,400 @@
+/*
+  This file is part of the FRED system.
+
+  Copyright (c) 2013-2016, University of Pittsburgh, John Grefenstette,
+  David Galloway, Mary Krauland, Michael Lann, and Donald Burke.
+
+  Based in part on FRED Version 2.9, created in 2010-2013 by
+  John Grefenstette, Shawn Brown, Roni Rosenfield, Alona Fyshe, David
+  Galloway, Nathan Stone, Jay DePasse, Anuroop Sriram, and Donald Burke.
+
+  Licensed under the BSD 3-Clause license.  See the file "LICENSE" for
+  more information.
+*/
+
+//
+//
+// File: FRED_Bench.cc
+//
+// Microbenchmarks for the core modules that the daily update leans on:
+// Random, Events, Tracker, Logistic_Regression (the Logit kernel),
+// Age_Map, the Geo distance functions and the per-type transmission
+// probability lookups of Respiratory_Transmission. Each benchmark runs a fixed number of operations and the
+// results are written as JSON, one entry per benchmark with the total
+// time and the mean time per operation.
+//
+// usage: FRED_Bench output.json [scale]
+//
+// scale multiplies the number of operations (default 1). The
+// transmission benchmarks read the contact matrices from
+// $FRED_HOME/data/defaults, and are skipped if FRED_HOME is not set.
+//
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include "Age_Map.h"
+#include "Demographics.h"
+#include "Events.h"
+#include "Geo.h"
+#include "Household.h"
+#include "Logistic_Regression.h"
+#include "Neighborhood.h"
+#include "Office.h"
+#include "Params.h"
+#include "Person.h"
+#include "Random.h"
+#include "School.h"
+#include "Tracker.h"
+#include "Workplace.h"
+using namespace std;
+
+typedef std::chrono::high_resolution_clock bench_clock;
+
+// keeps the benchmarked work from being optimized away
+static volatile double sink = 0.0;
+
+static vector<string> results;
+
+static void report(const char* name, long long operations, bench_clock::time_point start) {
+  double seconds = 1e-9 * std::chrono::duration_cast<std::chrono::nanoseconds>(bench_clock::now() - start).count();
+  char line[512];
+  snprintf(line, sizeof(line), "    {\"name\": \"%s\", \"operations\": %lld, \"total_seconds\": %.6f, \"ns_per_op\": %.3f}",
+	  name, operations, seconds, 1e9 * seconds / operations);
+  results.push_back(line);
+  printf("%-50s %10.3f ns/op\n", name, 1e9 * seconds / operations);
+}
+
+static void bench_random(long long n) {
+  double sum = 0.0;
+  bench_clock::time_point start = bench_clock::now();
+  for(long long i = 0; i < n; ++i) {
+    sum += Random::draw_random();
+  }
+  report("Random::draw_random", n, start);
+
+  start = bench_clock::now();
+  for(long long i = 0; i < n; ++i) {
+    sum += Random::draw_random_int(0, 999);
+  }
+  report("Random::draw_random_int", n, start);
+
+  start = bench_clock::now();
+  for(long long i = 0; i < n / 4; ++i) {
+    sum += Random::draw_normal(0.0, 1.0);
+  }
+  report("Random::draw_normal", n / 4, start);
+
+  start = bench_clock::now();
+  for(long long i = 0; i < n / 4; ++i) {
+    sum += Random::draw_exponential(2.0);
+  }
+  report("Random::draw_exponential", n / 4, start);
+
+  int sample[20];
+  start = bench_clock::now();
+  for(long long i = 0; i < n / 20; ++i) {
+    Random::sample_range_without_replacement(1000, 20, sample);
+    sum += sample[0];
+  }
+  report("Random::sample_range_without_replacement(1000,20)", n / 20, start);
+  sink = sum;
+}
+
+static void bench_events(long long n) {
+  // the event queue is a large object, so it lives on the heap
+  Events* events = new Events;
+  int days = 365;
+  int per_day = n / days;
+  // the queue only stores the pointers, so any distinct addresses will do
+  static char storage[1024];
+  Person* item[1024];
+  for(int i = 0; i < 1024; ++i) {
+    item[i] = reinterpret_cast<Person*>(&storage[i]);
+  }
+
+  bench_clock::time_point start = bench_clock::now();
+  for(int day = 0; day < days; ++day) {
+    for(int i = 0; i < per_day; ++i) {
+      events->add_event(day, item[i & 1023]);
+    }
+  }
+  report("Events::add_event", (long long) days * per_day, start);
+
+  double sum = 0.0;
+  start = bench_clock::now();
+  for(int day = 0; day < days; ++day) {
+    int size = events->get_size(day);
+    for(int i = 0; i < size; ++i) {
+      sum += reinterpret_cast<char*>(events->get_event(day, i)) - storage;
+    }
+  }
+  report("Events::get_event", (long long) days * per_day, start);
+
+  int deletes = 0;
+  start = bench_clock::now();
+  for(int day = 0; day < days; ++day) {
+    for(int i = 0; i < 16 && i < per_day; ++i) {
+      events->delete_event(day, item[i]);
+      deletes++;
+    }
+  }
+  report("Events::delete_event", deletes, start);
+
+  start = bench_clock::now();
+  for(int day = 0; day < days; ++day) {
+    events->clear_events(day);
+  }
+  report("Events::clear_events", days, start);
+  delete events;
+  sink = sum;
+}
+
+static void bench_tracker(long long n) {
+  Tracker<int> tracker("Bench Tracker", "index");
+  int indexes = 1000;
+  for(int i = 0; i < indexes; ++i) {
+    tracker.set_index_key_pair(i, "count", (int) 0);
+    tracker.set_index_key_pair(i, "total", 0.0);
+  }
+
+  bench_clock::time_point start = bench_clock::now();
+  for(long long i = 0; i < n; ++i) {
+    tracker.increment_index_key_pair(i % indexes, "count");
+  }
+  report("Tracker::increment_index_key_pair(int)", n, start);
+
+  start = bench_clock::now();
+  for(long long i = 0; i < n; ++i) {
+    tracker.set_index_key_pair(i % indexes, "total", 0.5 * i);
+  }
+  report("Tracker::set_index_key_pair(double)", n, start);
+
+  start = bench_clock::now();
+  int rounds = 100;
+  for(int r = 0; r < rounds; ++r) {
+    sink = tracker.print_csv_report_format_header().size();
+  }
+  report("Tracker::print_csv_report_format_header", rounds, start);
+}
+
+static void bench_logit(long long n) {
+  // a regression on 40 factors, about the size Logit fills in
+  int factors = 40;
+  vector<double> beta(factors);
+  for(int i = 0; i < factors; ++i) {
+    beta[i] = (i % 3 == 0 ? 0.0 : 0.01 * (i + 1));
+  }
+  char name[] = "bench";
+  Logistic_Regression lr(name, 2, -1.0, beta);
+  vector<double> x(factors);
+  for(int i = 0; i < factors; ++i) {
+    x[i] = Random::draw_random();
+  }
+
+  double sum = 0.0;
+  bench_clock::time_point start = bench_clock::now();
+  for(long long i = 0; i < n; ++i) {
+    x[i % factors] += 1e-9;
+    sum += lr.get_prob(&x[0]);
+  }
+  report("Logistic_Regression::get_prob(40 factors)", n, start);
+
+  start = bench_clock::now();
+  for(long long i = 0; i < n; ++i) {
+    sum += lr.get_outcome(&x[0]);
+  }
+  report("Logistic_Regression::get_outcome(40 factors)", n, start);
+  sink = sum;
+}
+
+static void bench_age_map(long long n) {
+  Age_Map map("Bench");
+  map.read_from_string("7 2 5 19 25 50 65 120", "7 0.1 0.2 0.3 0.4 0.5 0.6 0.7");
+
+  vector<double> ages(4096);
+  for(int i = 0; i < ages.size(); ++i) {
+    ages[i] = Random::draw_random(0.0, 99.0);
+  }
+
+  double sum = 0.0;
+  bench_clock::time_point start = bench_clock::now();
+  for(long long i = 0; i < n; ++i) {
+    sum += map.find_value(ages[i & 4095]);
+  }
+  report("Age_Map::find_value", n, start);
+
+  start = bench_clock::now();
+  for(long long i = 0; i < n; ++i) {
+    sum += map.find_group(ages[i & 4095]);
+  }
+  report("Age_Map::find_group", n, start);
+  sink = sum;
+}
+
+static void bench_geo(long long n) {
+  // points scattered over a county-sized square, given both in km and
+  // as the latitudes and longitudes FRED stores for places
+  int points = 4096;
+  vector<double> xs(points), ys(points), dist(points);
+  vector<fred::geo> lats(points), lons(points);
+  vector<int> index(points);
+  for(int i = 0; i < points; ++i) {
+    xs[i] = Random::draw_random(0.0, 50.0);
+    ys[i] = Random::draw_random(0.0, 50.0);
+    lats[i] = Geo::get_latitude(Geo::get_y(40.0) + ys[i]);
+    lons[i] = Geo::get_longitude(Geo::get_x(-80.0) + xs[i]);
+  }
+  long long rounds = n / points;
+  if(rounds < 1) {
+    rounds = 1;
+  }
+
+  double sum = 0.0;
+  bench_clock::time_point start = bench_clock::now();
+  for(long long r = 0; r < rounds; ++r) {
+    fred::geo lat = lats[r % points];
+    fred::geo lon = lons[r % points];
+    for(int i = 0; i < points; ++i) {
+      sum += Geo::xy_distance(lat, lon, lats[i], lons[i]);
+    }
+  }
+  report("Geo::xy_distance", rounds * points, start);
+
+  start = bench_clock::now();
+  for(long long r = 0; r < rounds; ++r) {
+    Geo::xy_distances(xs[r % points], ys[r % points], &xs[0], &ys[0], points, &dist[0]);
+    sum += dist[r % points];
+  }
+  report("Geo::xy_distances", rounds * points, start);
+
+  start = bench_clock::now();
+  for(long long r = 0; r < rounds; ++r) {
+    sum += Geo::xy_within_radius(xs[r % points], ys[r % points], &xs[0], &ys[0], points, 5.0, &index[0]);
+  }
+  report("Geo::xy_within_radius(5km)", rounds * points, start);
+  sink = sum;
+}
+
+// the transmission probability of every infector/infectee pair among the
+// given people, looked up through the virtual methods of Place, through
+// the place type's own methods, and with the infector's row of the
+// contact matrix found once per infector, as the templated
+// Respiratory_Transmission models do
+template <class PLACE_TYPE>
+static void bench_place_type(const char* type_name, PLACE_TYPE* place, vector<Person*> &people, long long n) {
+  int size = people.size();
+  long long rounds = n / size;
+  if(rounds < 1) {
+    rounds = 1;
+  }
+  // read back through a volatile, so that the compiler can't see the
+  // place type and bind the virtual calls itself
+  static Place* volatile virtual_place;
+  virtual_place = place;
+  Place* any_place = virtual_place;
+  char name[128];
+
+  double sum = 0.0;
+  bench_clock::time_point start = bench_clock::now();
+  for(long long r = 0; r < rounds; ++r) {
+    Person* infector = people[r % size];
+    for(int i = 0; i < size; ++i) {
+      sum += any_place->get_transmission_prob(0, infector, people[i]);
+    }
+  }
+  snprintf(name, sizeof(name), "%s::get_transmission_prob(virtual)", type_name);
+  report(name, rounds * size, start);
+
+  start = bench_clock::now();
+  for(long long r = 0; r < rounds; ++r) {
+    Person* infector = people[r % size];
+    for(int i = 0; i < size; ++i) {
+      sum += place->PLACE_TYPE::get_transmission_prob(0, infector, people[i]);
+    }
+  }
+  snprintf(name, sizeof(name), "%s::get_transmission_prob", type_name);
+  report(name, rounds * size, start);
+
+  start = bench_clock::now();
+  for(long long r = 0; r < rounds; ++r) {
+    int row = place->PLACE_TYPE::get_group(0, people[r % size]);
+    for(int i = 0; i < size; ++i) {
+      sum += place->PLACE_TYPE::get_transmission_prob_for_group(0, row, people[i]);
+    }
+  }
+  snprintf(name, sizeof(name), "%s::get_transmission_prob_for_group", type_name);
+  report(name, rounds * size, start);
+  sink = sum;
+}
+
+static void bench_transmission(long long n) {
+  // the defaults only
+  char paramfile[] = "/dev/null";
+  Params::read_parameters(paramfile);
+  Household::get_parameters();
+  Neighborhood::get_parameters();
+  School::get_parameters();
+  Workplace::get_parameters();
+  Office::get_parameters();
+
+  // people of all ages, so that every row of the matrices is used
+  int size = 1000;
+  vector<Person*> people(size);
+  for(int i = 0; i < size; ++i) {
+    people[i] = new Person;
+    people[i]->get_demographics()->setup(people[i], i % 90, (i & 1) ? 'M' : 'F', 1, 0, 0);
+  }
+
+  // like the places of a simulation, these are never deleted
+  bench_place_type("Household", new Household, people, n);
+  bench_place_type("Neighborhood", new Neighborhood, people, n);
+  bench_place_type("School", new School, people, n);
+  bench_place_type("Workplace", new Workplace, people, n);
+  bench_place_type("Office", new Office, people, n);
+
+  for(int i = 0; i < size; ++i) {
+    delete people[i];
+  }
+}
+
+int main(int argc, char* argv[]) {
+  if(argc < 2) {
+    fprintf(stderr, "usage: %s output.json [scale]\n", argv[0]);
+    return 1;
+  }
+  long long scale = 1;
+  if(argc > 2) {
+    scale = atoll(argv[2]);
+    if(scale < 1) {
+      scale = 1;
+    }
+  }
+  Random::set_seed(123456);
+
+  bench_random(scale * 20000000LL);
+  bench_events(scale * 5000000LL);
+  bench_tracker(scale * 2000000LL);
+  bench_logit(scale * 5000000LL);
+  bench_age_map(scale * 20000000LL);
+  bench_geo(scale * 20000000LL);
+  if(getenv("FRED_HOME") != NULL) {
+    bench_transmission(scale * 20000000LL);
+  }
+
+  FILE* fp = fopen(argv[1], "w");
+  if(fp == NULL) {
+    fprintf(stderr, "%s: can't open %s\n", argv[0], argv[1]);
+    return 1;
+  }
+  fprintf(fp, "{\n  \"benchmarks\": [\n");
+  for(int i = 0; i < results.size(); ++i) {
+    fprintf(fp, "%s%s\n", results[i].c_str(), i + 1 < results.size() ? "," : "");
+  }
+  fprintf(fp, "  ]\n}\n");
+  fclose(fp);
+  return 0;
+}
@@ -0,0 +1,153 @@
+/*
+  This file is part of the FRED system.
+
+  Copyright (c) 2013-2016, University of Pittsburgh, John Grefenstette,
+  David Galloway, Mary Krauland, Michael Lann, and Donald Burke.
+
+  Based in part on FRED Version 2.9, created in 2010-2013 by
+  John Grefenstette, Shawn Brown, Roni Rosenfield, Alona Fyshe, David
+  Galloway, Nathan Stone, Jay DePasse, Anuroop Sriram, and Donald Burke.
+
+  Licensed under the BSD 3-Clause license.  See the file "LICENSE" for
+  more information.
+*/
+
+//
+//
+// File: Random_Unit_Test.cc
+//
+// Checks that Random::sample_range_without_replacement draws distinct
+// values and that every ordered sample is equally likely, as it is for
+// the first s entries of a full Fisher-Yates shuffle, and that every
+// order of Random::shuffle_range is equally likely.
+//
+
+#include <math.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <vector>
+
+#include "Random.h"
+using namespace std;
+
+// chi-square critical values at p = 0.001
+static double chi_square_limit(int degrees_of_freedom) {
+  switch(degrees_of_freedom) {
+  case 19:
+    return 43.82;
+  default:
+    // Wilson-Hilferty approximation
+    double k = degrees_of_freedom;
+    double z = 3.09;
+    double t = 1.0 - 2.0 / (9.0 * k) + z * sqrt(2.0 / (9.0 * k));
+    return k * t * t * t;
+  }
+}
+
+// draw samples of size s from 0..N-1 (or shuffle the whole range) and
+// test that all N!/(N-s)! ordered samples occur equally often
+static bool test_ordered_samples(int N, int s, int trials, bool shuffle = false) {
+  int cells = 1;
+  for(int i = 0; i < s; ++i) {
+    cells *= (N - i);
+  }
+  int code_size = 1;
+  for(int i = 0; i < s; ++i) {
+    code_size *= N;
+  }
+  vector<int> count(code_size, 0);
+
+  int result[16];
+  for(int t = 0; t < trials; ++t) {
+    if(shuffle) {
+      Random::shuffle_range(N, result);
+    } else {
+      Random::sample_range_without_replacement(N, s, result);
+    }
+    int code = 0;
+    for(int i = 0; i < s; ++i) {
+      if(result[i] < 0 || result[i] >= N) {
+	printf("FAIL: N %d s %d value %d out of range\n", N, s, result[i]);
+	return false;
+      }
+      for(int j = 0; j < i; ++j) {
+	if(result[i] == result[j]) {
+	  printf("FAIL: N %d s %d value %d drawn twice\n", N, s, result[i]);
+	  return false;
+	}
+      }
+      code = code * N + result[i];
+    }
+    count[code]++;
+  }
+
+  double expected = static_cast<double>(trials) / cells;
+  double chi_square = 0.0;
+  for(int code = 0; code < code_size; ++code) {
+    // skip codes of tuples with repeated values
+    vector<bool> seen(N, false);
+    bool valid = true;
+    int c = code;
+    for(int i = 0; i < s; ++i) {
+      int v = c % N;
+      c /= N;
+      if(seen[v]) {
+	valid = false;
+      }
+      seen[v] = true;
+    }
+    if(valid) {
+      double diff = count[code] - expected;
+      chi_square += diff * diff / expected;
+    }
+  }
+  double limit = chi_square_limit(cells - 1);
+  printf("%s: N %d s %d%s trials %d chi-square %f (limit %f)\n",
+	 chi_square < limit ? "PASS" : "FAIL", N, s, shuffle ? " (shuffle)" : "",
+	 trials, chi_square, limit);
+  return chi_square < limit;
+}
+
+// the marginal distribution of each position should be uniform for
+// large N, including after calls with other range sizes
+static bool test_positions(int N, int s, int trials) {
+  vector<int> count(N * s, 0);
+  vector<int> result(s);
+  for(int t = 0; t < trials; ++t) {
+    Random::sample_range_without_replacement(N, s, &result[0]);
+    for(int i = 0; i < s; ++i) {
+      count[i * N + result[i]]++;
+    }
+  }
+  bool ok = true;
+  double expected = static_cast<double>(trials) / N;
+  double limit = chi_square_limit(N - 1);
+  for(int i = 0; i < s; ++i) {
+    double chi_square = 0.0;
+    for(int v = 0; v < N; ++v) {
+      double diff = count[i * N + v] - expected;
+      chi_square += diff * diff / expected;
+    }
+    if(chi_square >= limit) {
+      printf("FAIL: N %d position %d chi-square %f (limit %f)\n", N, i, chi_square, limit);
+      ok = false;
+    }
+  }
+  if(ok) {
+    printf("PASS: N %d s %d trials %d positions uniform\n", N, s, trials);
+  }
+  return ok;
+}
+
+int main(void) {
+  Random::set_seed(12345);
+  bool ok = true;
+  ok = test_ordered_samples(5, 2, 200000) && ok;
+  ok = test_ordered_samples(5, 5, 600000) && ok;
+  ok = test_positions(1000, 5, 200000) && ok;
+  ok = test_ordered_samples(4, 3, 240000) && ok;
+  ok = test_positions(60, 60, 60000) && ok;
+  ok = test_ordered_samples(4, 4, 240000, true) && ok;
+  printf("%s\n", ok ? "ALL TESTS PASSED" : "SOME TESTS FAILED");
+  return ok ? 0 : 1;
+}
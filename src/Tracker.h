@@ -39,6 +39,7 @@
 #endif
 
 using namespace std;
+class Checkpoint;
 const string allowed_typenames[] = { "double", "int", "string" };
 //#############################
 
@@ -551,6 +552,9 @@ public:
   }
   
 private:
+  // checkpoints save and restore the values
+  friend class Checkpoint;
+
   //Private Variables
   string title;
   string index_name;
@@ -604,15 +608,15 @@ private:
     }
     
     if(TypeName == "int") {
-      for(int i =0; i < this->indices.size(); ++i) {
+      for(int i =0; i < (int) this->indices.size(); ++i) {
 	      this->values_map_int[key_name].push_back(0);
       }
     } else if(TypeName == "double") {
-      for(int i =0; i < this->indices.size(); ++i) {
+      for(int i =0; i < (int) this->indices.size(); ++i) {
 	      this->values_map_double[key_name].push_back(0.0);
       }
     } else if(TypeName == "string") {
-      for(int i =0; i < this->indices.size(); ++i) {
+      for(int i =0; i < (int) this->indices.size(); ++i) {
 	      this->values_map_string[key_name].push_back("A String");
       }
     } else {
@@ -43,6 +43,9 @@ static double* Travel_Duration_Cdf;		// cdf for trip duration
 static int max_Travel_Duration = 0;		// number of days in cdf
 Age_Map* travel_age_prob;
 
+// days until a hub's alias table is rebuilt for its users' new ages
+static const int ALIAS_TABLE_LIFETIME = 365;
+
 // travel hub record:
 typedef struct hub_record {
   int id;
@@ -51,6 +54,17 @@ typedef struct hub_record {
   pvec users;
   int pop;
   int pct;
+
+  // users who have died are left as NULL entries until the next rebuild
+  int live_users;
+  int removed_users;
+
+  // Walker alias table over users, weighted by an upper bound on each
+  // user's travel_age_prob until alias_expiration_day
+  std::vector<double> alias_prob;
+  std::vector<int> alias;
+  std::vector<double> alias_weight;
+  int alias_expiration_day;
 } hub_t;
 
 // list of trave hubs
@@ -61,13 +75,36 @@ int num_hubs;
 // between hubs, read from an external file
 int** trips_per_day;
 
+// the hub pairs with at least one trip per day after adjusting for the
+// partial user base, in the order of the trips_per_day matrix
+typedef struct trip_record {
+  int src;
+  int dest;
+  int count;
+} trip_t;
+std::vector<trip_t> trips;
+
+// hub and position in the hub's user list, indexed by person id
+std::vector<int> hub_of_user;
+std::vector<int> slot_of_user;
+
 void Travel::setup(char* directory) {
   assert(Global::Enable_Travel);
   read_hub_file();
   read_trips_per_day_file();
-  setup_travelers_per_hub();
   travel_age_prob = new Age_Map("Travel Age Probability");
   travel_age_prob->read_from_input("travel_age_prob");
+  vector<double> duration_cdf;
+  int n = Params::get_param_vector((char*)"travel_duration", duration_cdf);
+  if(n < 1) {
+    Utils::fred_abort("Help! travel_duration must list a cdf of trip durations\n");
+  }
+  max_Travel_Duration = n - 1;
+  Travel_Duration_Cdf = new double [n];
+  for(int i = 0; i < n; ++i) {
+    Travel_Duration_Cdf[i] = duration_cdf[i];
+  }
+  setup_travelers_per_hub();
 }
 
 void Travel::read_hub_file() {
@@ -161,6 +198,13 @@ void Travel::setup_travelers_per_hub() {
       int housemates = h->get_size();
       for(int k = 0; k < housemates; ++k) {
 	Person* person = h->get_enrollee(k);
+	int id = person->get_id();
+	if(id >= static_cast<int>(hub_of_user.size())) {
+	  hub_of_user.resize(id + 1, -1);
+	  slot_of_user.resize(id + 1, -1);
+	}
+	hub_of_user[id] = closest;
+	slot_of_user[id] = hubs[closest].users.size();
 	hubs[closest].users.push_back(person);
       }
     }
@@ -169,7 +213,32 @@ void Travel::setup_travelers_per_hub() {
   // adjustment for partial user base
   for(int i = 0; i < num_hubs; ++i) {
     hubs[i].pct = 0.5 + (100.0 * hubs[i].users.size()) / hubs[i].pop;
+    hubs[i].live_users = hubs[i].users.size();
+    hubs[i].removed_users = 0;
+    Travel::build_alias_table(i, Global::Simulation_Day);
   }
+
+  // keep only the hub pairs that generate trips
+  trips.clear();
+  for(int i = 0; i < num_hubs; ++i) {
+    if(hubs[i].users.size() == 0) {
+      continue;
+    }
+    for(int j = 0; j < num_hubs; ++j) {
+      if(hubs[j].users.size() == 0) {
+	continue;
+      }
+      int count = (trips_per_day[i][j] * hubs[i].pct + 0.5) / 100;
+      if(count > 0) {
+	trip_t trip;
+	trip.src = i;
+	trip.dest = j;
+	trip.count = count;
+	trips.push_back(trip);
+      }
+    }
+  }
+  FRED_VERBOSE(0, "travel hub pairs with trips: %d of %d\n", static_cast<int>(trips.size()), num_hubs * num_hubs);
   // print hubs
   for(int i = 0; i < num_hubs; ++i) {
     printf("Hub %d: lat = %f lon = %f users = %d pop = %d pct = %d\n",
@@ -191,67 +260,45 @@ void Travel::update_travel(int day) {
   }
 
   // initiate new trips
-  for(int i = 0; i < num_hubs; ++i) {
-    if(hubs[i].users.size() == 0) {
+  int size = trips.size();
+  for(int k = 0; k < size; ++k) {
+    int i = trips[k].src;
+    int j = trips[k].dest;
+    if(hubs[i].live_users == 0 || hubs[j].live_users == 0) {
       continue;
     }
-    for(int j = 0; j < num_hubs; ++j) {
-      if(hubs[j].users.size() == 0) {
-	continue;
+    if(hubs[i].alias_expiration_day <= day) {
+      Travel::build_alias_table(i, day);
+    }
+    int successful_trips = 0;
+    int count = trips[k].count;
+    FRED_VERBOSE(1,"TRIPCOUNT day %d i %d j %d count %d\n", day, i, j, count);
+    for(int t = 0; t < count; ++t) {
+      // select a traveler determined by travel_age_prob param
+      Person* traveler = Travel::select_traveler(i);
+      Person* host = NULL;
+      if(traveler != NULL) {
+	// select a random member of the destination hub's user group
+	host = Travel::select_host(j);
       }
-      int successful_trips = 0;
-      int count = (trips_per_day[i][j] * hubs[i].pct + 0.5) / 100;
-      FRED_VERBOSE(1,"TRIPCOUNT day %d i %d j %d count %d\n", day, i, j, count);
-      for(int t = 0; t < count; ++t) {
-	// select a potential traveler determined by travel_age_prob param
-	Person* traveler = NULL;
-	Person* host = NULL;
-	int attempts = 0;
-	while(traveler == NULL && attempts < 100) {
-	  // select a random member of the source hub's user group
-	  int v = Random::draw_random_int(0, static_cast<int>(hubs[i].users.size()) - 1);
-	  traveler = hubs[i].users[v];
-	  double prob_travel_by_age = travel_age_prob->find_value(traveler->get_real_age());
-	  if(prob_travel_by_age < Random::draw_random()) {
-	    traveler = NULL;
-	  }
-	  attempts++;
-	}
-	if(traveler != NULL) {
-	  // select a potential travel host determined by travel_age_prob param
-	  attempts = 0;
-	  while(host == NULL && attempts < 100) {
-	    // select a random member of the destination hub's user group
-	    int v = Random::draw_random_int(0, static_cast<int>(hubs[j].users.size()) - 1);
-	    host = hubs[j].users[v];
-
-	    //	          double prob_travel_by_age = travel_age_prob->find_value(host->get_real_age());
-	    //	          if(prob_travel_by_age < Random::draw_random()) {
-	    //	            host = NULL;
-	    //	          }
-
-	    attempts++;
-	  }
-	}
-	// travel occurs only if both traveler and host are not already traveling
-	if(traveler != NULL && (!traveler->get_travel_status()) &&
-	   host != NULL && (!host->get_travel_status())) {
-	  // put traveler in travel status
-	  traveler->start_traveling(host);
-	  if(traveler->get_travel_status()) {
-	    // put traveler on list for given number of days to travel
-	    int duration = Random::draw_from_distribution(max_Travel_Duration, Travel_Duration_Cdf);
-	    int return_sim_day = day + duration;
-	    Travel::add_return_event(return_sim_day, traveler);
-	    traveler->get_activities()->set_return_from_travel_sim_day(return_sim_day);
-	    FRED_STATUS(1, "RETURN_FROM_TRAVEL EVENT ADDED today %d duration %d returns %d id %d age %d\n",
-			day, duration, return_sim_day, traveler->get_id(),traveler->get_age());
-	    successful_trips++;
-	  }
+      // travel occurs only if both traveler and host are not already traveling
+      if(traveler != NULL && (!traveler->get_travel_status()) &&
+	 host != NULL && (!host->get_travel_status())) {
+	// put traveler in travel status
+	traveler->start_traveling(host);
+	if(traveler->get_travel_status()) {
+	  // put traveler on list for given number of days to travel
+	  int duration = Random::draw_from_distribution(max_Travel_Duration, Travel_Duration_Cdf);
+	  int return_sim_day = day + duration;
+	  Travel::add_return_event(return_sim_day, traveler);
+	  traveler->get_activities()->set_return_from_travel_sim_day(return_sim_day);
+	  FRED_STATUS(1, "RETURN_FROM_TRAVEL EVENT ADDED today %d duration %d returns %d id %d age %d\n",
+		      day, duration, return_sim_day, traveler->get_id(),traveler->get_age());
+	  successful_trips++;
 	}
       }
-      FRED_VERBOSE(1,"DAY %d SRC = %d DEST = %d TRIPS = %d\n", day, hubs[i].id, hubs[j].id, successful_trips);
     }
+    FRED_VERBOSE(1,"DAY %d SRC = %d DEST = %d TRIPS = %d\n", day, hubs[i].id, hubs[j].id, successful_trips);
   }
 
   // process travelers who are returning home
@@ -265,6 +312,132 @@ void Travel::update_travel(int day) {
   return;
 }
 
+void Travel::build_alias_table(int hub, int day) {
+  hub_t* h = &(hubs[hub]);
+
+  // drop the users removed since the last build
+  if(h->removed_users > 0) {
+    int live = 0;
+    int size = h->users.size();
+    for(int k = 0; k < size; ++k) {
+      Person* person = h->users[k];
+      if(person != NULL) {
+	slot_of_user[person->get_id()] = live;
+	h->users[live++] = person;
+      }
+    }
+    h->users.resize(live);
+    h->removed_users = 0;
+  }
+
+  // Each user is weighted by the largest travel probability of any age
+  // the user reaches before the table expires. select_traveler() then
+  // accepts a user with probability (current value / weight), which keeps
+  // the selection exact for age groups of any width.
+  int n = h->users.size();
+  h->alias_weight.resize(n);
+  h->alias_prob.resize(n);
+  h->alias.resize(n);
+  h->alias_expiration_day = day + ALIAS_TABLE_LIFETIME;
+  double total = 0.0;
+  for(int k = 0; k < n; ++k) {
+    double age = h->users[k]->get_real_age();
+    h->alias_weight[k] = travel_age_prob->find_max_value(age, age + ALIAS_TABLE_LIFETIME / 365.0);
+    total += h->alias_weight[k];
+  }
+  if(total <= 0.0) {
+    // nobody in this hub travels: every draw is rejected
+    for(int k = 0; k < n; ++k) {
+      h->alias_prob[k] = 0.0;
+      h->alias[k] = k;
+    }
+    return;
+  }
+
+  // Vose's method: pair each under-full column with an over-full one
+  std::vector<int> small;
+  std::vector<int> large;
+  for(int k = 0; k < n; ++k) {
+    h->alias_prob[k] = h->alias_weight[k] * n / total;
+    h->alias[k] = k;
+    if(h->alias_prob[k] < 1.0) {
+      small.push_back(k);
+    } else {
+      large.push_back(k);
+    }
+  }
+  while(small.empty() == false && large.empty() == false) {
+    int s = small.back();
+    small.pop_back();
+    int l = large.back();
+    h->alias[s] = l;
+    h->alias_prob[l] -= 1.0 - h->alias_prob[s];
+    if(h->alias_prob[l] < 1.0) {
+      large.pop_back();
+      small.push_back(l);
+    }
+  }
+  // what remains is full up to rounding error
+  for(int k = 0; k < (int) large.size(); ++k) {
+    h->alias_prob[large[k]] = 1.0;
+  }
+  for(int k = 0; k < (int) small.size(); ++k) {
+    h->alias_prob[small[k]] = 1.0;
+  }
+}
+
+Person* Travel::select_traveler(int hub) {
+  hub_t* h = &(hubs[hub]);
+  int n = h->users.size();
+  for(int attempts = 0; attempts < 100; ++attempts) {
+    int k = Random::draw_random_int(0, n - 1);
+    if(h->alias_prob[k] < Random::draw_random()) {
+      k = h->alias[k];
+    }
+    Person* traveler = h->users[k];
+    if(traveler == NULL || h->alias_weight[k] <= 0.0) {
+      continue;
+    }
+    double prob_travel_by_age = travel_age_prob->find_value(traveler->get_real_age());
+    if(prob_travel_by_age >= h->alias_weight[k] ||
+       Random::draw_random() * h->alias_weight[k] < prob_travel_by_age) {
+      return traveler;
+    }
+  }
+  return NULL;
+}
+
+Person* Travel::select_host(int hub) {
+  hub_t* h = &(hubs[hub]);
+  int n = h->users.size();
+  for(int attempts = 0; attempts < 100; ++attempts) {
+    Person* host = h->users[Random::draw_random_int(0, n - 1)];
+    if(host != NULL) {
+      return host;
+    }
+  }
+  return NULL;
+}
+
+void Travel::remove_user(Person* person) {
+  int id = person->get_id();
+  if(id >= static_cast<int>(hub_of_user.size()) || hub_of_user[id] < 0) {
+    return;
+  }
+  hub_t* h = &(hubs[hub_of_user[id]]);
+  h->users[slot_of_user[id]] = NULL;
+  h->live_users--;
+  h->removed_users++;
+  hub_of_user[id] = -1;
+  slot_of_user[id] = -1;
+
+  // the alias table stays exact with holes in it, but rebuild once the
+  // holes cost more draws than the rebuild
+  if(8 * h->removed_users > static_cast<int>(h->users.size())) {
+    h->alias_expiration_day = Global::Simulation_Day;
+  }
+}
+
 void Travel::find_returning_travelers(int day) {
   int size = return_queue->get_size(day);
   for (int i = 0; i < size; i++) {
@@ -277,6 +450,7 @@ void Travel::find_returning_travelers(int day) {
 }
 
 void Travel::terminate_person(Person* person) {
+  Travel::remove_user(person);
   if(!person->get_travel_status()) {
     return;
   }
@@ -39,6 +39,11 @@ public:
   static void delete_return_event(int day, Person* person);
 
 private:
+  static void build_alias_table(int hub, int day);
+  static Person* select_traveler(int hub);
+  static Person* select_host(int hub);
+  static void remove_user(Person* person);
+
   static Events * return_queue;
 };
 
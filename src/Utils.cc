@@ -18,7 +18,9 @@
 //
 
 #include "Utils.h"
+#include "Async_Output.h"
 #include "Global.h"
+#include "Infection_Log.h"
 #include <chrono>
 #include <sstream>
 #include <stdlib.h>
@@ -77,6 +79,17 @@ void Utils::fred_abort(const char* format, ...){
   abort();
 }
 
+void Utils::fred_snprintf(char* buffer, size_t size, const char* format, ...) {
+  va_list ap;
+  va_start(ap, format);
+  int length = vsnprintf(buffer, size, format, ap);
+  va_end(ap);
+  if(length < 0 || (size_t) length >= size) {
+    Utils::fred_abort("formatted string of %d characters does not fit in %d: %s\n",
+		      length, (int) size, buffer);
+  }
+}
+
 void Utils::fred_warning(const char* format, ...){
 
   // open ErrorLog file if it doesn't exist
@@ -125,7 +138,7 @@ void Utils::fred_open_output_files(){
   sprintf(ErrorFilename, "%s/err.txt", directory);
 
   sprintf(filename, "%s/out.csv", directory);
-  Global::Outfp = fopen(filename, "w");
+  Global::Outfp = Async_Output::open(filename, "w");
   if(Global::Outfp == NULL) {
     Utils::fred_abort("Can't open %s\n", filename);
   }
@@ -141,8 +154,8 @@ void Utils::fred_open_output_files(){
   */
   Global::Infectionfp = NULL;
   if(Global::Track_infection_events > 0) {
-    sprintf(filename, "%s/infections.txt", directory);
-    Global::Infectionfp = fopen(filename, "w");
+    Utils::fred_snprintf(filename, sizeof(filename), "%s/%s", directory, (Infection_Log::is_binary() ? "infections.bin" : "infections.txt"));
+    Global::Infectionfp = Async_Output::open(filename, "w");
     if(Global::Infectionfp == NULL) {
       Utils::fred_abort("Can't open %s\n", filename);
     }
@@ -151,7 +164,7 @@ void Utils::fred_open_output_files(){
   Global::HealthRecordfp = NULL;
   if(Global::Enable_Health_Records > 0) {
     sprintf(filename, "%s/health_records.txt", directory);
-    Global::HealthRecordfp = fopen(filename, "w");
+    Global::HealthRecordfp = Async_Output::open(filename, "w");
     if(Global::HealthRecordfp == NULL) {
       Utils::fred_abort("Can't open %s\n", filename);
     }
@@ -203,6 +216,70 @@ void Utils::fred_open_output_files(){
   return;
 }
 
+// per-run output files that batch mode hands over from the setup run to each replicate
+static FILE** Run_output_fp[] = { &Global::Outfp, &Global::Infectionfp, &Global::HealthRecordfp,
+				  &Global::Householdfp, &Global::Tractfp, &Global::IncomeCatfp };
+static const char* Run_output_file[] = { "out.csv", "infections.txt", "health_records.txt",
+					 "households.txt", "tracts.txt", "income_category.txt" };
+static const int Run_output_files = 6;
+static long Run_output_mark[Run_output_files];
+
+void Utils::fred_mark_output_files() {
+  Infection_Log::flush();
+  Async_Output::flush();
+  for(int i = 0; i < Run_output_files; ++i) {
+    Run_output_mark[i] = 0;
+    if(*Run_output_fp[i] != NULL) {
+      fflush(*Run_output_fp[i]);
+      Run_output_mark[i] = ftell(*Run_output_fp[i]);
+    }
+  }
+}
+
+void Utils::fred_reopen_output_files(int setup_run) {
+  // replace the setup run's output files with those of
+  // Global::Simulation_run_number
+  for(int i = 0; i < Run_output_files; ++i) {
+    if(*Run_output_fp[i] != NULL) {
+      Async_Output::close(*Run_output_fp[i]);
+      *Run_output_fp[i] = NULL;
+    }
+  }
+  if(Global::ErrorLogfp != NULL) {
+    fclose(Global::ErrorLogfp);
+    Global::ErrorLogfp = NULL;
+  }
+  fred_open_output_files();
+
+  // copy everything written to the setup run's files before the mark
+  char buffer[FRED_STRING_SIZE];
+  for(int i = 0; i < Run_output_files; ++i) {
+    if(*Run_output_fp[i] == NULL || Run_output_mark[i] <= 0) {
+      continue;
+    }
+    char filename[FRED_STRING_SIZE];
+    const char* file = Run_output_file[i];
+    if(Run_output_fp[i] == &Global::Infectionfp && Infection_Log::is_binary()) {
+      file = "infections.bin";
+    }
+    Utils::fred_snprintf(filename, sizeof(filename), "%s/RUN%d/%s", Global::Simulation_directory, setup_run, file);
+    FILE* fp = fopen(filename, "r");
+    if(fp == NULL) {
+      Utils::fred_abort("Can't open %s\n", filename);
+    }
+    long remaining = Run_output_mark[i];
+    while(remaining > 0) {
+      size_t n = fread(buffer, 1, (remaining < FRED_STRING_SIZE ? remaining : FRED_STRING_SIZE), fp);
+      if(n == 0) {
+	break;
+      }
+      Async_Output::write(*Run_output_fp[i], buffer, n);
+      remaining -= n;
+    }
+    fclose(fp);
+  }
+}
+
 void Utils::fred_make_directory(char* directory) {
   struct stat info;
   if( stat( directory, &info ) == 0 ) {
@@ -231,13 +308,17 @@ void Utils::fred_make_directory(char* directory) {
 void Utils::fred_end(void){
   // This is a function that cleans up FRED and exits
   if(Global::Outfp != NULL) {
-    fclose(Global::Outfp);
+    Async_Output::close(Global::Outfp);
+  }
+  if(Global::HealthRecordfp != NULL) {
+    Async_Output::close(Global::HealthRecordfp);
   }
   if(Global::Tracefp != NULL) {
     fclose(Global::Tracefp);
   }
   if(Global::Infectionfp != NULL) {
-    fclose(Global::Infectionfp);
+    Infection_Log::flush();
+    Async_Output::close(Global::Infectionfp);
   }
   if(Global::Prevfp != NULL) {
     fclose(Global::Prevfp);
@@ -254,6 +335,9 @@ void Utils::fred_end(void){
   if(Global::IncomeCatfp != NULL) {
     fclose(Global::IncomeCatfp);
   }
+
+  // wait for the closes queued above
+  Async_Output::stop();
 }
 
 
@@ -384,8 +468,10 @@ void Utils::fred_log(const char* format, ...) {
 void Utils::fred_report(const char* format, ...) {
   va_list ap;
   va_start(ap, format);
-  vfprintf(Global::Outfp, format, ap);
-  fflush(Global::Outfp);
+  char record[FRED_STRING_SIZE];
+  vsnprintf(record, FRED_STRING_SIZE, format, ap);
+  va_end(ap);
+  Async_Output::write(Global::Outfp, record, strlen(record));
   va_start(ap, format);
   vfprintf(Global::Statusfp, format, ap);
   fflush(Global::Statusfp);
@@ -135,7 +135,14 @@ using namespace std::chrono;
 namespace Utils {
   void fred_abort(const char* format, ...);
   void fred_warning(const char* format, ...);
+  /**
+   * Format into a buffer like snprintf, but abort instead of truncating
+   * (for file names and report keys, which must not be cut short).
+   */
+  void fred_snprintf(char* buffer, size_t size, const char* format, ...) __attribute__((format(printf, 3, 4)));
   void fred_open_output_files();
+  void fred_mark_output_files();
+  void fred_reopen_output_files(int setup_run);
   void fred_make_directory(char* directory);
   void fred_end();
   void fred_print_wall_time(const char* format, ...);
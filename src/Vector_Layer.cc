@@ -16,6 +16,7 @@
 //
 // File: Vector_Layer.cc
 //
+#include <algorithm>
 #include <utility>
 #include <list>
 #include <vector>
@@ -62,7 +63,12 @@ typedef struct census_tract_record {
   int popsize;
   int total_neighborhoods;
   int first_day_infectious;
+  // infectious neighborhoods are treated in the order they are found;
+  // the ones before next_infectious have already been treated
   patch_vec infectious_neighborhoods;
+  int next_infectious;
+  // pool of neighborhoods sampled for treatment when there are not
+  // enough infectious ones
   patch_vec non_infectious_neighborhoods;
   patch_vec vector_control_neighborhoods;
   patch_vec neighborhoods;
@@ -80,6 +86,12 @@ bool Vector_Layer::Limit_Vector_Control = false;
 vector <census_t> census_tract_set;
 vector<county_record_t> county_set;
 
+// indices into census_tract_set of the tracts eligible for vector
+// control, of the tracts in each county, and of each tract by fips
+vector<int> vector_control_tract_set;
+map<int, vector<int> > county_tract_map;
+map<int, int> tract_index_map;
+
 
 Vector_Layer::Vector_Layer() {
   Regional_Layer* base_grid = Global::Simulation_Region;
@@ -225,12 +237,8 @@ void Vector_Layer::add_infectious_patch(Place * p, int day){
     return;
   }
   int tract = n_->get_census_tract_fips();
-  int tract_index_ = -1;
-  for (int i = 0; i < census_tract_set.size(); i++) {
-    if (tract == census_tract_set[i].ind) {
-      tract_index_ = i;
-    }
-  }
+  map<int, int>::iterator itr = tract_index_map.find(tract);
+  int tract_index_ = (itr == tract_index_map.end() ? -1 : itr->second);
   if(tract_index_ < 0){
     FRED_VERBOSE(1,"add_infectious_patch tract_index is < 0\n");
     return;
@@ -256,89 +264,78 @@ void Vector_Layer::update_vector_control_by_census_tract(int day){
   if(vector_control_places_enrolled >= vector_control_max_places && Limit_Vector_Control == true){
     return;
   }
-  int total_census_tracts = Global::Places.get_number_of_census_tracts();
-  for(int i = 0;i < total_census_tracts;i++){
-    if(census_tract_set[i].eligible_for_vector_control && (census_tract_set[i].first_day_infectious >=0)){
+  int conditions = Global::Conditions.get_number_of_conditions();
+  for(int v = 0; v < (int) vector_control_tract_set.size(); v++){
+    int i = vector_control_tract_set[v];
+    census_t & tract = census_tract_set[i];
+    if(tract.first_day_infectious < 0){
+      continue;
+    }
+    if(tract.exceeded_threshold == false){
       int symp_incidence_by_tract = 0;
-      for(int d = 0; d < Global::Conditions.get_number_of_conditions(); d++) {
-        Condition * condition = Global::Conditions.get_condition(d);
-        Epidemic * epidemic = condition->get_epidemic();
+      for(int d = 0; d < conditions; d++) {
+        Epidemic * epidemic = Global::Conditions.get_condition(d)->get_epidemic();
         symp_incidence_by_tract += epidemic->get_symptomatic_incidence_by_tract_index(i);
       }
-      //calculate the weekly incidence rate by 100.000 inhabitants                                                            
-      double symp_incidence_ = (double) symp_incidence_by_tract / (double) census_tract_set[i].popsize * 100000.0 * 7.0; 
-      FRED_VERBOSE(1,"Census_tract: %d, symp_incidence %lg population %d symp_incidence_tract %d\n",census_tract_set[i].ind,symp_incidence_,census_tract_set[i].popsize,symp_incidence_by_tract);
-      if(symp_incidence_  >= census_tract_set[i].threshold && census_tract_set[i].exceeded_threshold == false){
-        census_tract_set[i].exceeded_threshold = true;
-        // if it is the capital of the county, then all the census tracts of the county are choosen for vector control                                                                                               
-        int census_end = census_tract_set[i].ind % 1000;
-        FRED_VERBOSE(1,"Census_tract: %d threshold exceeded\n",census_tract_set[i].ind);
-        if(census_end == 1){
-          FRED_VERBOSE(1,"Capital : Census_tract: %d\n",census_tract_set[i].ind);
-          int county_capital = floor(census_tract_set[i].ind / 1000);
-          for(int k = 0;k<total_census_tracts;k++){
-            int county_temp =  floor(census_tract_set[k].ind / 1000);
-            if(county_temp == county_capital){
-              FRED_VERBOSE(1,"Census_tract: %d and %d same county, threshold exceeded\n",census_tract_set[i].ind, census_tract_set[k].ind);
-	      census_tract_set[k].exceeded_threshold = true;                                                                                                                                                         
-            }
+      //calculate the weekly incidence rate by 100.000 inhabitants
+      double symp_incidence_ = (double) symp_incidence_by_tract / (double) tract.popsize * 100000.0 * 7.0;
+      FRED_VERBOSE(1,"Census_tract: %d, symp_incidence %lg population %d symp_incidence_tract %d\n",tract.ind,symp_incidence_,tract.popsize,symp_incidence_by_tract);
+      if(symp_incidence_ >= tract.threshold){
+        tract.exceeded_threshold = true;
+        // if it is the capital of the county, then all the census tracts of the county are choosen for vector control
+        FRED_VERBOSE(1,"Census_tract: %d threshold exceeded\n",tract.ind);
+        if(tract.ind % 1000 == 1){
+          FRED_VERBOSE(1,"Capital : Census_tract: %d\n",tract.ind);
+          vector<int> & county_tracts = county_tract_map[tract.ind / 1000];
+          for(int k = 0; k < (int) county_tracts.size(); k++){
+            FRED_VERBOSE(1,"Census_tract: %d and %d same county, threshold exceeded\n",tract.ind, census_tract_set[county_tracts[k]].ind);
+            census_tract_set[county_tracts[k]].exceeded_threshold = true;
           }
         }
       }
-      if(census_tract_set[i].exceeded_threshold == true){
-        int total_neighborhoods_enrolled = 0;
-        int max_n = 0;
-        int neighborhoods_enrolled_today = floor(vector_control_neighborhoods_rate * census_tract_set[i].total_neighborhoods);
-        FRED_VERBOSE(1,"update_vector_control_by_census_tract::Census_tract: %d, %d infectious neighborhoods, neighborhoods to enroll %d\n",census_tract_set[i].ind,census_tract_set[i].infectious_neighborhoods.size(),neighborhoods_enrolled_today);
-        if(census_tract_set[i].infectious_neighborhoods.size() > 0){
-          max_n = (neighborhoods_enrolled_today <= census_tract_set[i].infectious_neighborhoods.size() ? neighborhoods_enrolled_today : census_tract_set[i].infectious_neighborhoods.size());
-          for(int j = 0;j < max_n;j++){
-            Neighborhood_Patch * p_n = census_tract_set[i].infectious_neighborhoods.front();
-            vector_control_places_enrolled += this->select_places_for_vector_control(p_n,day);
-            census_tract_set[i].infectious_neighborhoods.erase(census_tract_set[i].infectious_neighborhoods.begin());
-	    census_tract_set[i].vector_control_neighborhoods.push_back(p_n);
-            total_neighborhoods_enrolled++;
-            if(vector_control_places_enrolled >= vector_control_max_places && Limit_Vector_Control == true){
-              break;
-            }
-          }
+    }
+    if(tract.exceeded_threshold == true){
+      int total_neighborhoods_enrolled = 0;
+      int neighborhoods_enrolled_today = floor(vector_control_neighborhoods_rate * tract.total_neighborhoods);
+      int infectious_waiting = tract.infectious_neighborhoods.size() - tract.next_infectious;
+      FRED_VERBOSE(1,"update_vector_control_by_census_tract::Census_tract: %d, %d infectious neighborhoods, neighborhoods to enroll %d\n",tract.ind,infectious_waiting,neighborhoods_enrolled_today);
+      int max_n = (neighborhoods_enrolled_today <= infectious_waiting ? neighborhoods_enrolled_today : infectious_waiting);
+      for(int j = 0; j < max_n; j++){
+        Neighborhood_Patch * p_n = tract.infectious_neighborhoods[tract.next_infectious++];
+        vector_control_places_enrolled += this->select_places_for_vector_control(p_n,day);
+        tract.vector_control_neighborhoods.push_back(p_n);
+        total_neighborhoods_enrolled++;
+        if(vector_control_places_enrolled >= vector_control_max_places && Limit_Vector_Control == true){
+          break;
         }
-        if(census_tract_set[i].non_infectious_neighborhoods.size() > 0){
-          patch_vec non_inf_neighborhoods;
-          non_inf_neighborhoods.clear();
-          FYShuffle<Neighborhood_Patch*>(census_tract_set[i].non_infectious_neighborhoods);
-	  for(int k = 0;k<census_tract_set[i].non_infectious_neighborhoods.size();k++){
-            if(census_tract_set[i].non_infectious_neighborhoods[k]->get_vector_control_status() == 0){
-	      non_inf_neighborhoods.push_back(census_tract_set[i].non_infectious_neighborhoods[k]);
-	    }
-	  }
-	  census_tract_set[i].non_infectious_neighborhoods.clear();
-	  census_tract_set[i].non_infectious_neighborhoods = non_inf_neighborhoods;
-          non_inf_neighborhoods.clear();
-          int neighborhoods_to_enroll = neighborhoods_enrolled_today - max_n;
-          if(neighborhoods_to_enroll > census_tract_set[i].non_infectious_neighborhoods.size()){
-            neighborhoods_to_enroll = census_tract_set[i].non_infectious_neighborhoods.size();
-          }
-	  if(neighborhoods_to_enroll > 0){
-	    for(int j = 0;j<neighborhoods_to_enroll;j++){
-	      Neighborhood_Patch * p_n = census_tract_set[i].non_infectious_neighborhoods.front();
-	      vector_control_places_enrolled += this->select_places_for_vector_control(p_n,day);
-	      census_tract_set[i].vector_control_neighborhoods.push_back(p_n);
-	      census_tract_set[i].non_infectious_neighborhoods.erase(census_tract_set[i].non_infectious_neighborhoods.begin());
-	      total_neighborhoods_enrolled++;
-	      if(vector_control_places_enrolled >= vector_control_max_places && Limit_Vector_Control == true){
-		break;
-	      }
-	    }
-	  }
-	}
-        FRED_VERBOSE(1,"update_vector_control_by_census_tract::Census_tract: %d,total neighborhoods enrolled %d, neighborhoods to enroll %d, neighborhoods enrolled %d places enrolled %d\n",census_tract_set[i].ind,census_tract_set[i].vector_control_neighborhoods.size(),neighborhoods_enrolled_today, total_neighborhoods_enrolled, vector_control_places_enrolled);
       }
+      // the rest are sampled from the untreated neighborhoods without
+      // replacement; neighborhoods that have become infectious since they
+      // were pooled are dropped as they are drawn
+      int neighborhoods_to_enroll = neighborhoods_enrolled_today - max_n;
+      patch_vec & pool = tract.non_infectious_neighborhoods;
+      int enrolled = 0;
+      while(enrolled < neighborhoods_to_enroll && pool.size() > 0){
+        int r = Random::draw_random_int(0, pool.size() - 1);
+        Neighborhood_Patch * p_n = pool[r];
+        pool[r] = pool.back();
+        pool.pop_back();
+        if(p_n->get_vector_control_status() != 0){
+          continue;
+        }
+        vector_control_places_enrolled += this->select_places_for_vector_control(p_n,day);
+        tract.vector_control_neighborhoods.push_back(p_n);
+        enrolled++;
+        total_neighborhoods_enrolled++;
+        if(vector_control_places_enrolled >= vector_control_max_places && Limit_Vector_Control == true){
+          break;
+        }
+      }
+      FRED_VERBOSE(1,"update_vector_control_by_census_tract::Census_tract: %d,total neighborhoods enrolled %d, neighborhoods to enroll %d, neighborhoods enrolled %d places enrolled %d\n",tract.ind,tract.vector_control_neighborhoods.size(),neighborhoods_enrolled_today, total_neighborhoods_enrolled, vector_control_places_enrolled);
     }
   }
 
   FRED_VERBOSE(1,"update_vector_control_by_census_tract_finished\n");
-  // this->make_eligible_for_vector_control(neighborhood_temp);
 }
 
 
@@ -411,10 +408,14 @@ void Vector_Layer::setup_vector_control_by_census_tract(){
   int rows_n = Global::Neighborhoods->get_rows();
   Params::get_param("vector_control_census_tracts_file", filename);
   census_tracts_with_vector_control.clear();
+  vector_control_tract_set.clear();
+  county_tract_map.clear();
+  tract_index_map.clear();
   vector_control_places_enrolled = 0;
 
   //read census tracts to implement vector control
   census_tracts_with_vector_control = this->read_vector_control_tracts(filename);
+  std::sort(census_tracts_with_vector_control.begin(), census_tracts_with_vector_control.end());
   int total_census_tracts = Global::Places.get_number_of_census_tracts();
 
   //Load census tracts in simulation and assign eligibility for vector control
@@ -428,17 +429,21 @@ void Vector_Layer::setup_vector_control_by_census_tract(){
     census_temp.ind = Global::Places.get_census_tract_with_index(i);
     census_temp.total_neighborhoods = 0;
     census_temp.first_day_infectious = -1;
+    census_temp.next_infectious = 0;
     census_temp.popsize = 0;
     census_temp.threshold = 1000.00;
     census_temp.eligible_for_vector_control = false;
     census_temp.exceeded_threshold = false;
-    for(int j = 0;j<census_tracts_with_vector_control.size();j++){
-      if(census_temp.ind == census_tracts_with_vector_control[j]){
-	census_temp.eligible_for_vector_control = true;
-	census_temp.threshold = this->vector_control_threshold;
-      }
+    if(std::binary_search(census_tracts_with_vector_control.begin(), census_tracts_with_vector_control.end(), census_temp.ind)){
+      census_temp.eligible_for_vector_control = true;
+      census_temp.threshold = this->vector_control_threshold;
     }
     census_tract_set.push_back(census_temp);
+    if(census_temp.eligible_for_vector_control){
+      vector_control_tract_set.push_back(i);
+    }
+    county_tract_map[census_temp.ind / 1000].push_back(i);
+    tract_index_map[census_temp.ind] = i;
   }
 
   // For each neighborhood that implements vector control, allocate the neighborhoods in the census tract set
@@ -451,12 +456,12 @@ void Vector_Layer::setup_vector_control_by_census_tract(){
 	Household * h = (Household *) neighborhood_temp->select_random_household();
 	int tract = h->get_census_tract_fips();
 	neighborhood_temp->get_neighborhood()->set_census_tract_fips(tract);
-	int t = -1;
-	for (int i = 0; i < census_tract_set.size(); i++) {
-	  if (tract == census_tract_set[i].ind) {
-	    t = i;
-	  }
+	map<int, int>::iterator itr = tract_index_map.find(tract);
+	if(itr == tract_index_map.end()) {
+	  FRED_WARNING("setup_vector_control_by_census_tract: census tract %d of neighborhood (%d,%d) is not in the vector control file\n", tract, i, j);
+	  continue;
 	}
+	int t = itr->second;
 	census_tract_set[t].popsize +=pop_size;
 	if(census_tract_set[t].eligible_for_vector_control == true){
 	  census_tract_set[t].total_neighborhoods++;
@@ -143,19 +143,6 @@ void Workplace::prepare() {
   Place::prepare();
 }
 
-double Workplace::get_transmission_prob(int condition, Person* i, Person* s) {
-  // i = infected agent
-  // s = susceptible agent
-  int row = get_group(condition, i);
-  int col = get_group(condition, s);
-  double tr_pr = Workplace::prob_transmission_per_contact[row][col];
-  return tr_pr;
-}
-
-double Workplace::get_contacts_per_day(int condition) {
-  return Workplace::contacts_per_day;
-}
-
 int Workplace::get_number_of_rooms() {
   if(Workplace::Office_size == 0) {
     return 0;
@@ -64,7 +64,24 @@ public:
    * The static array <code>Workplace_contact_prob</code> will be filled with values from the parameter
    * file for the key <code>workplace_prob[]</code>.
    */
-  double get_transmission_prob(int condition, Person* i, Person* s);
+  double get_transmission_prob(int condition, Person* i, Person* s) {
+    // i = infected agent
+    // s = susceptible agent
+    int row = Workplace::get_group(condition, i);
+    int col = Workplace::get_group(condition, s);
+    double tr_pr = Workplace::prob_transmission_per_contact[row][col];
+    return tr_pr;
+  }
+
+  /**
+   * The transmission probability for an infector in the given group (row
+   * of the contact matrix), for callers that look up many susceptibles
+   * with the same infector.
+   */
+  double get_transmission_prob_for_group(int condition, int row, Person* s) {
+    int col = Workplace::get_group(condition, s);
+    return Workplace::prob_transmission_per_contact[row][col];
+  }
 
   /**
    * @see Place::get_contacts_per_day(int condition)
@@ -74,7 +91,9 @@ public:
    * The static array <code>Workplace_contacts_per_day</code> will be filled with values from the parameter
    * file for the key <code>workplace_contacts[]</code>.
    */
-  double get_contacts_per_day(int condition);
+  double get_contacts_per_day(int condition) {
+    return Workplace::contacts_per_day;
+  }
 
   int get_number_of_rooms();
     